@@ -0,0 +1,163 @@
+#include "auto_sort.h"
+#include "parallel_sort.h"
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    std::ostream *decisionLog = nullptr;
+    std::mutex decisionLogLock;
+
+    int ceilLog2(std::size_t n)
+    {
+        int log = 0;
+        while ((std::size_t(1) << log) < n)
+            log++;
+        return log;
+    }
+}
+
+// ==================== DISPATCH ====================
+
+SortDecision AutoSort::sort(std::vector<int> &arr, int threads)
+{
+    if (threads <= 0)
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    if (arr.size() < SMALL_INPUT)
+    {
+        SortDecision decision = smallInput(arr.size());
+        logDecision(decision);
+        SortEngine::sort(arr.begin(), arr.end());
+        return decision;
+    }
+
+    SortDecision decision = decide(probe(arr.begin(), arr.end()), threads);
+    logDecision(decision);
+
+    if (decision.strategy == STRATEGY_PARALLEL)
+    {
+        ParallelSort::sampleSort(arr, threads);
+    }
+    else
+    {
+        SortLess comp;
+        SortIdentity proj;
+        apply(decision.strategy, arr.begin(), arr.end(), comp, proj);
+    }
+    return decision;
+}
+
+SortDecision AutoSort::decide(const SortProfile &profile, int threads)
+{
+    SortDecision decision;
+    decision.profile = profile;
+    std::ostringstream reason;
+
+    int mergePasses = ceilLog2(profile.runs);
+    int radixPasses = (profile.keyBits + RadixSort::DEFAULT_DIGIT_BITS - 1) / RadixSort::DEFAULT_DIGIT_BITS;
+    int distinct = static_cast<int>(profile.distinctRatio * std::min<std::size_t>(profile.size, SAMPLE_SIZE) + 0.5);
+    bool heavyDuplicates = profile.distinctRatio * DUPLICATE_RATIO <= 1;
+
+    if (profile.sorted)
+    {
+        decision.strategy = STRATEGY_NONE;
+        reason << "already sorted";
+    }
+    else if (profile.size < SMALL_INPUT)
+    {
+        decision.strategy = STRATEGY_INTROSORT;
+        reason << "small input";
+    }
+    else if (!profile.runsExceeded && (!profile.numericKeys || mergePasses <= radixPasses))
+    {
+        decision.strategy = STRATEGY_RUN_MERGE;
+        reason << profile.runs << " natural runs, " << mergePasses << " merge passes";
+    }
+    else if (profile.inversionRatio * 1000 <= NEARLY_SORTED_PERMILLE)
+    {
+        decision.strategy = STRATEGY_RUN_MERGE;
+        reason << "nearly sorted, " << profile.inversionRatio * 100 << "% of sampled pairs inverted";
+    }
+    else if (threads >= PARALLEL_MIN_THREADS && profile.size >= PARALLEL_THRESHOLD)
+    {
+        decision.strategy = STRATEGY_PARALLEL;
+        reason << "large input, " << threads << " threads";
+    }
+    else if (heavyDuplicates && (!profile.numericKeys || radixPasses > 1))
+    {
+        decision.strategy = STRATEGY_INTROSORT;
+        reason << "heavy duplicates, about " << distinct << " distinct keys in "
+               << std::min<std::size_t>(profile.size, SAMPLE_SIZE) << " samples";
+    }
+    else if (profile.numericKeys)
+    {
+        decision.strategy = STRATEGY_RADIX;
+        reason << "numeric keys spanning " << profile.keyBits << " bits, " << radixPasses << " radix passes";
+    }
+    else
+    {
+        decision.strategy = STRATEGY_INTROSORT;
+        reason << "no exploitable structure";
+    }
+
+    decision.reason = reason.str();
+    return decision;
+}
+
+// Probing costs about as much as sorting this few elements, so only the
+// size is recorded
+SortDecision AutoSort::smallInput(std::size_t size)
+{
+    SortDecision decision;
+    decision.profile.size = size;
+    decision.strategy = STRATEGY_INTROSORT;
+    decision.reason = "small input";
+    return decision;
+}
+
+// ==================== DECISION LOG ====================
+
+const char *AutoSort::strategyName(SortStrategy strategy)
+{
+    switch (strategy)
+    {
+    case STRATEGY_NONE:
+        return "none";
+    case STRATEGY_INTROSORT:
+        return "introsort";
+    case STRATEGY_RUN_MERGE:
+        return "run-merge";
+    case STRATEGY_RADIX:
+        return "radix";
+    case STRATEGY_PARALLEL:
+        return "parallel";
+    }
+    return "unknown";
+}
+
+std::string AutoSort::describe(const SortDecision &decision)
+{
+    const SortProfile &p = decision.profile;
+    std::ostringstream out;
+    out << "autoSort: " << strategyName(decision.strategy) << " (" << decision.reason << ")"
+        << " n=" << p.size << " runs=" << (p.runsExceeded ? ">" : "") << p.runs
+        << " inversions=" << p.inversionRatio << " distinct=" << p.distinctRatio;
+    if (p.numericKeys)
+        out << " keyBits=" << p.keyBits;
+    return out.str();
+}
+
+void AutoSort::setLog(std::ostream *log)
+{
+    std::lock_guard<std::mutex> guard(decisionLogLock);
+    decisionLog = log;
+}
+
+void AutoSort::logDecision(const SortDecision &decision)
+{
+    std::lock_guard<std::mutex> guard(decisionLogLock);
+    if (decisionLog)
+        *decisionLog << describe(decision) << std::endl;
+}
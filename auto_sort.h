@@ -0,0 +1,268 @@
+#ifndef AUTO_SORT_H
+#define AUTO_SORT_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <iterator>
+#include <algorithm>
+#include <cstddef>
+#include "sort_engine.h"
+#include "radix_sort.h"
+
+/**
+ * Automatic algorithm choice for sorting
+ * AutoSort::sort probes the input cheaply and hands it to the engine that
+ * suits it best:
+ *   - a bounded scan counts natural runs (stopping once there are too many
+ *     for merging to pay off);
+ *   - about SAMPLE_SIZE evenly spaced elements estimate the fraction of
+ *     inverted pairs, the share of distinct keys and the key range.
+ * The profile then picks one of the strategies below; the choice, with the
+ * profile and the reason for it, is returned and written to the decision
+ * log when one is set (AutoSort::setLog).
+ * Heavy duplicates go to introsort: its equal-key partition (partitionLeft)
+ * already finishes every key equal to a repeated pivot in one pass, and in
+ * measurements it beat separate three-way (Dijkstra, Bentley-McIlroy)
+ * partitioning on both ints and strings.
+ */
+
+enum SortStrategy
+{
+    STRATEGY_NONE,        // already sorted
+    STRATEGY_INTROSORT,   // SortEngine::quickSort
+    STRATEGY_RUN_MERGE,   // SortEngine::mergeSort over the natural runs
+    STRATEGY_RADIX,       // RadixSort::lsdSort
+    STRATEGY_PARALLEL     // ParallelSort::sampleSort (int vectors only)
+};
+
+struct SortProfile
+{
+    std::size_t size;
+    bool sorted;           // no element is smaller than the one before it
+    std::size_t runs;      // natural runs, ascending or strictly descending
+    bool runsExceeded;     // the scan stopped early: more runs than merging handles well
+    double inversionRatio; // sampled pairs out of order: 0 sorted, ~0.5 random, 1 reversed
+    double distinctRatio;  // distinct keys among the sampled elements
+    bool numericKeys;      // integer or floating-point keys under the default order
+    int keyBits;           // bits spanned by the sampled key range (numeric keys)
+
+    SortProfile()
+        : size(0), sorted(false), runs(0), runsExceeded(false), inversionRatio(0), distinctRatio(1),
+          numericKeys(false), keyBits(0) {}
+};
+
+struct SortDecision
+{
+    SortProfile profile;
+    SortStrategy strategy;
+    std::string reason;
+};
+
+class AutoSort
+{
+public:
+    enum
+    {
+        SAMPLE_SIZE = 1024,           // elements sampled for inversions, duplicates and key range
+        SMALL_INPUT = 1 << 11,        // smaller inputs go to introsort without a probe
+        RUN_SCAN_RATIO = 16,          // run counting stops after size / RUN_SCAN_RATIO runs
+        NEARLY_SORTED_PERMILLE = 10,  // at most this many inverted pairs per 1000 count as nearly sorted
+        DUPLICATE_RATIO = 16,         // heavy duplicates: distinct keys <= sample / DUPLICATE_RATIO
+        PARALLEL_THRESHOLD = 1 << 22, // int vectors at least this large go parallel...
+        PARALLEL_MIN_THREADS = 4      // ...on machines with at least this many hardware threads
+    };
+
+    // Sort [first, last) by comp(proj(a), proj(b)) with the strategy the
+    // probe suggests (never the parallel one)
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static SortDecision sort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Same for an int vector, which may also be sorted in parallel;
+    // threads = 0 uses every hardware thread
+    static SortDecision sort(std::vector<int> &arr, int threads = 0);
+
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static SortProfile probe(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    static SortDecision decide(const SortProfile &profile, int threads = 1);
+
+    static const char *strategyName(SortStrategy strategy);
+    static std::string describe(const SortDecision &decision);
+
+    // Every decision is written to log as one line (nullptr turns logging off)
+    static void setLog(std::ostream *log);
+
+private:
+    static void logDecision(const SortDecision &decision);
+
+    // Decision for inputs below SMALL_INPUT, which are sorted without a probe
+    static SortDecision smallInput(std::size_t size);
+
+    template <typename Iter, typename Compare, typename Projection>
+    static void apply(SortStrategy strategy, Iter first, Iter last, Compare &comp, Projection &proj);
+
+    // Numeric keys are measured only when RadixSort could sort them
+    template <typename Iter, typename Compare, typename Projection>
+    static int keyBits(Iter first, const std::vector<std::size_t> &sample, Projection &proj, std::true_type numeric);
+    template <typename Iter, typename Compare, typename Projection>
+    static int keyBits(Iter, const std::vector<std::size_t> &, Projection &, std::false_type)
+    {
+        return 0;
+    }
+
+    template <typename Iter, typename Compare, typename Projection>
+    struct HasNumericKeys
+        : std::integral_constant<bool, IsRadixKey<typename SortKey<Iter, Projection>::Type>::value &&
+                                           IsAscendingCompare<Compare, typename SortKey<Iter, Projection>::Type>::value>
+    {
+    };
+
+    template <typename Iter, typename Compare, typename Projection>
+    static void radixSort(Iter first, Iter last, Projection &proj, std::true_type)
+    {
+        RadixSort::lsdSort(first, last, proj);
+    }
+    template <typename Iter, typename Compare, typename Projection>
+    static void radixSort(Iter, Iter, Projection &, std::false_type) {}
+};
+
+// ==================== PROBE ====================
+
+template <typename Iter, typename Compare, typename Projection>
+SortProfile AutoSort::probe(Iter first, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    SortProfile profile;
+    std::size_t n = static_cast<std::size_t>(last - first);
+    profile.size = n;
+    profile.numericKeys = HasNumericKeys<Iter, Compare, Projection>::value;
+    if (n < 2)
+    {
+        profile.sorted = true;
+        profile.runs = n;
+        return profile;
+    }
+
+    // Count natural runs the way merge sort finds them, but give up once
+    // there are too many for merging to pay off (random input gets there
+    // after a small fraction of the array)
+    std::size_t runLimit = n / RUN_SCAN_RATIO + 1;
+    std::size_t i = 1;
+    while (i < n && profile.runs <= runLimit)
+    {
+        profile.runs++;
+        if (order(first[i], first[i - 1]))
+        {
+            while (++i < n && order(first[i], first[i - 1]))
+                ;
+        }
+        else
+        {
+            while (++i < n && !order(first[i], first[i - 1]))
+                ;
+        }
+        i++;
+    }
+    if (i == n)
+        profile.runs++; // a run made of just the last element
+    profile.runsExceeded = i < n;
+    profile.sorted = profile.runs == 1 && !order(first[1], first[0]);
+
+    // Evenly spaced sample positions
+    std::size_t m = std::min<std::size_t>(n, SAMPLE_SIZE);
+    std::vector<std::size_t> sample(m);
+    for (std::size_t j = 0; j < m; j++)
+        sample[j] = j * (n / m) + (n % m) * j / m;
+
+    // Inversions among pairs of sampled positions a quarter of the sample
+    // apart, and among neighbours, so both far and local disorder show up
+    std::size_t inverted = 0, pairs = 0;
+    for (std::size_t j = 0; j + 1 < m; j++)
+    {
+        std::size_t far = (j + m / 4) % m;
+        std::size_t lo = std::min(j, far), hi = std::max(j, far);
+        inverted += order(first[sample[hi]], first[sample[lo]]);
+        inverted += order(first[sample[j + 1]], first[sample[j]]);
+        pairs += 2;
+    }
+    profile.inversionRatio = pairs ? static_cast<double>(inverted) / pairs : 0;
+
+    // Distinct keys: sort a copy of the sampled elements and count changes
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+    std::vector<Value> values;
+    values.reserve(m);
+    for (std::size_t j = 0; j < m; j++)
+        values.push_back(first[sample[j]]);
+    SortEngine::quickSort(values.begin(), values.end(), comp, proj);
+    std::size_t distinct = 1;
+    for (std::size_t j = 1; j < m; j++)
+        distinct += order(values[j - 1], values[j]);
+    profile.distinctRatio = static_cast<double>(distinct) / m;
+
+    profile.keyBits = keyBits<Iter, Compare>(first, sample, proj, HasNumericKeys<Iter, Compare, Projection>());
+    return profile;
+}
+
+// Bits needed for the spread of the sampled keys, as RadixSort sees them
+template <typename Iter, typename Compare, typename Projection>
+int AutoSort::keyBits(Iter first, const std::vector<std::size_t> &sample, Projection &proj, std::true_type)
+{
+    typedef typename SortKey<Iter, Projection>::Type Key;
+    typedef typename RadixKey<Key>::Bits Bits;
+
+    Bits lo = RadixKey<Key>::encode(proj(first[sample[0]]));
+    Bits hi = lo;
+    for (std::size_t j = 1; j < sample.size(); j++)
+    {
+        Bits bits = RadixKey<Key>::encode(proj(first[sample[j]]));
+        lo = std::min(lo, bits);
+        hi = std::max(hi, bits);
+    }
+
+    int bits = 0;
+    for (Bits range = hi - lo; range != 0; range >>= 1)
+        bits++;
+    return bits;
+}
+
+// ==================== DISPATCH ====================
+
+template <typename Iter, typename Compare, typename Projection>
+SortDecision AutoSort::sort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    if (n < SMALL_INPUT)
+    {
+        SortDecision decision = smallInput(n);
+        logDecision(decision);
+        SortEngine::sort(first, last, comp, proj);
+        return decision;
+    }
+
+    SortDecision decision = decide(probe(first, last, comp, proj));
+    logDecision(decision);
+    apply(decision.strategy, first, last, comp, proj);
+    return decision;
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void AutoSort::apply(SortStrategy strategy, Iter first, Iter last, Compare &comp, Projection &proj)
+{
+    switch (strategy)
+    {
+    case STRATEGY_NONE:
+        break;
+    case STRATEGY_RUN_MERGE:
+        SortEngine::mergeSort(first, last, comp, proj);
+        break;
+    case STRATEGY_RADIX:
+        radixSort<Iter, Compare>(first, last, proj, HasNumericKeys<Iter, Compare, Projection>());
+        break;
+    default:
+        SortEngine::quickSort(first, last, comp, proj);
+        break;
+    }
+}
+
+#endif // AUTO_SORT_H
@@ -0,0 +1,13 @@
+#include "batch_runner.h"
+
+/**
+ * Command line of the headless batch runner (make batch)
+ * Builds without utils.cpp/main.cpp, so scripted runs work on any platform;
+ * see batch_runner.h for the job format and BatchRunner::printUsage for
+ * the options.
+ */
+
+int main(int argc, char **argv)
+{
+    return BatchRunner::main(argc, argv);
+}
@@ -0,0 +1,651 @@
+#include "batch_runner.h"
+#include "bulk_loader.h"
+#include "dataset.h"
+#include "graph.h"
+#include "csr_graph.h"
+#include "graph_bfs.h"
+#include "graph_paths.h"
+#include "graph_sssp.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+    const char *const graphAlgorithms[] = {"bfs",           "bfs_do",         "bfs_par",       "dfs",
+                                           "dijkstra",      "dijkstra_auto",  "dijkstra_dial", "dijkstra_radix",
+                                           "dijkstra_heap4", "delta_stepping", "path_dijkstra", "path_bidir",
+                                           "path_astar"};
+    const int graphAlgorithmCount = sizeof(graphAlgorithms) / sizeof(graphAlgorithms[0]);
+
+    // Queue of the dijkstra_* jobs; plain dijkstra uses CsrGraph's std::priority_queue
+    GraphSssp::QueueKind dijkstraQueue(const std::string &algorithm)
+    {
+        if (algorithm == "dijkstra_dial")
+        {
+            return GraphSssp::QUEUE_BUCKETS;
+        }
+        if (algorithm == "dijkstra_radix")
+        {
+            return GraphSssp::QUEUE_RADIX;
+        }
+        if (algorithm == "dijkstra_heap4")
+        {
+            return GraphSssp::QUEUE_HEAP;
+        }
+        return GraphSssp::QUEUE_AUTO;
+    }
+
+    int parseInt(const std::string &text)
+    {
+        std::size_t value = Benchmark::parseCount(text);
+        if (value > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+        {
+            throw std::invalid_argument("number too large: " + text);
+        }
+        return static_cast<int>(value);
+    }
+
+    // Words of a job file line; "double quotes" keep paths with spaces together
+    std::vector<std::string> splitWords(const std::string &line)
+    {
+        std::vector<std::string> words;
+        std::string word;
+        bool quoted = false, any = false;
+        for (char c : line)
+        {
+            if (c == '"')
+            {
+                quoted = !quoted;
+                any = true;
+            }
+            else if (!quoted && (c == ' ' || c == '\t' || c == '\r'))
+            {
+                if (any)
+                {
+                    words.push_back(word);
+                }
+                word.clear();
+                any = false;
+            }
+            else
+            {
+                word += c;
+                any = true;
+            }
+        }
+        if (quoted)
+        {
+            throw std::invalid_argument("unterminated quote");
+        }
+        if (any)
+        {
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // ==================== INPUT FILES ====================
+
+    std::vector<int> loadArray(const BatchJob &job)
+    {
+        if (job.input.empty())
+        {
+            return Benchmark::generate(job.distribution, job.size, job.seed);
+        }
+        if (BulkLoader::endsWith(job.input, ".avds"))
+        {
+            return BulkLoader::loadDataset(job.input, job.section);
+        }
+        return BulkLoader::load(job.input, job.threads);
+    }
+
+    std::string describeInput(const BatchJob &job)
+    {
+        if (!job.input.empty())
+        {
+            return job.section.empty() ? job.input : job.input + ":" + job.section;
+        }
+        return std::string(Benchmark::distributionName(job.distribution)) + ":" + std::to_string(job.size);
+    }
+
+    // ==================== OUTPUT ====================
+
+    std::string csvField(const std::string &s)
+    {
+        if (s.find_first_of(",\"\n") == std::string::npos)
+        {
+            return s;
+        }
+        std::string quoted = "\"";
+        for (char c : s)
+        {
+            if (c == '"')
+            {
+                quoted += '"';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    // Standard output for "-", otherwise the opened file
+    std::ostream &openOutput(const std::string &path, std::ofstream &file)
+    {
+        if (path == "-")
+        {
+            return std::cout;
+        }
+        file.open(path.c_str());
+        if (!file)
+        {
+            throw std::runtime_error("cannot open " + path);
+        }
+        return file;
+    }
+}
+
+// ==================== JOBS ====================
+
+std::vector<std::string> BatchRunner::algorithmNames()
+{
+    std::vector<std::string> names = Benchmark::algorithmNames();
+    names.insert(names.end(), graphAlgorithms, graphAlgorithms + graphAlgorithmCount);
+    return names;
+}
+
+bool BatchRunner::isGraphAlgorithm(const std::string &algorithm)
+{
+    const char *const *end = graphAlgorithms + graphAlgorithmCount;
+    return std::find(graphAlgorithms, end, algorithm) != end;
+}
+
+BatchJob BatchRunner::parseJob(const std::vector<std::string> &args, const BatchJob &defaults)
+{
+    BatchJob job = defaults;
+    for (std::size_t i = 0; i < args.size(); i++)
+    {
+        const std::string &arg = args[i];
+        if (i + 1 >= args.size())
+        {
+            throw std::invalid_argument("missing value for " + arg);
+        }
+        const std::string &value = args[++i];
+
+        if (arg == "--algo")
+        {
+            std::vector<std::string> names = algorithmNames();
+            if (std::find(names.begin(), names.end(), value) == names.end())
+            {
+                throw std::invalid_argument("unknown algorithm: " + value);
+            }
+            job.algorithm = value;
+        }
+        else if (arg == "--input")
+        {
+            job.input = value;
+        }
+        else if (arg == "--section")
+        {
+            job.section = value;
+        }
+        else if (arg == "--name")
+        {
+            job.name = value;
+        }
+        else if (arg == "--size")
+        {
+            job.size = Benchmark::parseCount(value);
+        }
+        else if (arg == "--dist")
+        {
+            job.distribution = Benchmark::parseDistribution(value);
+        }
+        else if (arg == "--seed")
+        {
+            job.seed = Benchmark::parseCount(value);
+        }
+        else if (arg == "--start")
+        {
+            job.start = parseInt(value);
+        }
+        else if (arg == "--target")
+        {
+            job.target = parseInt(value);
+        }
+        else if (arg == "--warmup")
+        {
+            job.warmups = parseInt(value);
+        }
+        else if (arg == "--repeats")
+        {
+            job.repeats = parseInt(value);
+        }
+        else if (arg == "--threads")
+        {
+            job.threads = parseInt(value);
+        }
+        else
+        {
+            throw std::invalid_argument("unknown option " + arg);
+        }
+    }
+    if (job.repeats < 1)
+    {
+        throw std::invalid_argument("--repeats must be at least 1");
+    }
+    return job;
+}
+
+std::vector<BatchJob> BatchRunner::readJobFile(const std::string &path, const BatchJob &defaults)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    for (int number = 1; std::getline(file, line); number++)
+    {
+        try
+        {
+            std::vector<std::string> words = splitWords(line);
+            if (words.empty() || words[0][0] == '#')
+            {
+                continue;
+            }
+            BatchJob job = parseJob(words, defaults);
+            if (job.algorithm.empty())
+            {
+                throw std::invalid_argument("no --algo");
+            }
+            jobs.push_back(job);
+        }
+        catch (const std::invalid_argument &e)
+        {
+            throw std::invalid_argument(path + ":" + std::to_string(number) + ": " + e.what());
+        }
+    }
+    return jobs;
+}
+
+// ==================== RUNNING ====================
+
+BatchResult BatchRunner::run(const BatchJob &job)
+{
+    BatchResult result;
+    result.job = job;
+    if (result.job.name.empty())
+    {
+        result.job.name = job.algorithm;
+    }
+
+    try
+    {
+        std::vector<double> times;
+        auto loadStart = std::chrono::steady_clock::now();
+
+        if (isGraphAlgorithm(job.algorithm))
+        {
+            if (job.input.empty())
+            {
+                throw std::runtime_error("graph jobs need an --input edge list");
+            }
+            // Dataset graphs are used in place, so the file stays mapped for the whole job
+            bool weighted = job.algorithm.compare(0, 3, "bfs") != 0 && job.algorithm != "dfs";
+            std::unique_ptr<Dataset> dataset;
+            CsrGraph graph;
+            if (BulkLoader::endsWith(job.input, ".avds"))
+            {
+                dataset.reset(new Dataset(job.input));
+                // A damaged offset or target would send the search outside the mapping
+                dataset->checkGraph(job.section);
+                graph = CsrGraph(dataset->graph(job.section));
+                result.edges = graph.directed() ? graph.edgeCount() : graph.edgeCount() / 2;
+            }
+            else
+            {
+                int vertices = 0;
+                std::vector<GraphEdge> edges = Graph::readEdgeList(job.input, vertices);
+                graph = CsrGraph(vertices, edges, weighted, false);
+                result.edges = edges.size();
+            }
+            int vertices = graph.size();
+            result.elements = vertices;
+            // Bottom-up steps of bfs_do walk incoming edges; built once, not in every run
+            CsrGraph incoming;
+            if (job.algorithm == "bfs_do" && graph.directed())
+            {
+                incoming = graph.transposed();
+            }
+            if (job.start < 0 || job.start >= vertices)
+            {
+                throw std::runtime_error("start vertex " + std::to_string(job.start) + " is not in the graph");
+            }
+            bool pathQuery = job.algorithm.compare(0, 5, "path_") == 0;
+            if (pathQuery && (job.target < 0 || job.target >= vertices))
+            {
+                throw std::runtime_error(job.target < 0 ? "path jobs need a --target vertex"
+                                                        : "target vertex " + std::to_string(job.target) +
+                                                              " is not in the graph");
+            }
+            // Landmark distances are preprocessing: computed once and counted in the load time
+            std::unique_ptr<PathFinder> finder;
+            std::unique_ptr<Landmarks> landmarks;
+            if (pathQuery)
+            {
+                finder.reset(new PathFinder(graph));
+                if (job.algorithm == "path_astar")
+                    landmarks.reset(new Landmarks(graph, std::min<int>(Landmarks::DEFAULT_COUNT, vertices)));
+            }
+            result.loadMs = millisecondsSince(loadStart);
+
+            bool parallel = job.algorithm == "bfs_par" || job.algorithm == "delta_stepping";
+            WorkStealingPool pool(parallel ? job.threads : 1);
+            std::uint64_t pathLength = 0;
+            for (int round = 0; round < job.warmups + job.repeats; round++)
+            {
+                auto start = std::chrono::steady_clock::now();
+                long long reached;
+                if (job.algorithm == "bfs")
+                {
+                    std::vector<int> level = graph.bfsLevels(job.start);
+                    reached = level.size() - std::count(level.begin(), level.end(), -1);
+                }
+                else if (job.algorithm == "bfs_do")
+                {
+                    reached = GraphBfs::directionOptimizing(graph, job.start, graph.directed() ? &incoming : nullptr)
+                                  .reached;
+                }
+                else if (job.algorithm == "bfs_par")
+                {
+                    reached = GraphBfs::parallel(graph, job.start, pool).reached;
+                }
+                else if (job.algorithm == "dfs")
+                {
+                    reached = graph.dfsOrder(job.start).size();
+                }
+                else if (job.algorithm == "delta_stepping")
+                {
+                    reached = GraphSssp::deltaStepping(graph, job.start, pool).reached;
+                }
+                else if (pathQuery)
+                {
+                    PathResult path;
+                    if (job.algorithm == "path_dijkstra")
+                        path = finder->dijkstra(job.start, job.target);
+                    else if (job.algorithm == "path_bidir")
+                        path = finder->bidirectional(job.start, job.target);
+                    else
+                        path = finder->astar(job.start, job.target, *landmarks);
+                    reached = path.settled;
+                    pathLength = path.dist;
+                }
+                else if (job.algorithm != "dijkstra")
+                {
+                    reached = GraphSssp::dijkstra(graph, job.start, dijkstraQueue(job.algorithm)).reached;
+                }
+                else
+                {
+                    std::vector<std::uint64_t> dist = graph.shortestDistances(job.start);
+                    reached = dist.size() -
+                              std::count(dist.begin(), dist.end(), std::numeric_limits<std::uint64_t>::max());
+                }
+                double ms = millisecondsSince(start);
+                if (round >= job.warmups)
+                {
+                    times.push_back(ms);
+                    result.reached = reached;
+                }
+            }
+            result.ok = true;
+            if (pathQuery && pathLength != GraphSssp::dijkstra(graph, job.start).dist[job.target])
+            {
+                result.ok = false;
+                result.error = "path length differs from a full Dijkstra run";
+            }
+        }
+        else
+        {
+            const std::vector<int> input = loadArray(job);
+            result.elements = input.size();
+            result.loadMs = millisecondsSince(loadStart);
+
+            // A sorted permutation of the input: ordered, same length, same sum and xor
+            long long sum = 0;
+            int bits = 0;
+            for (int value : input)
+            {
+                sum += value;
+                bits ^= value;
+            }
+
+            WorkStealingPool pool(job.threads);
+            std::vector<int> arr;
+            result.ok = true;
+            for (int round = 0; round < job.warmups + job.repeats; round++)
+            {
+                arr = input;
+                auto start = std::chrono::steady_clock::now();
+                Benchmark::sort(job.algorithm, arr, pool);
+                double ms = millisecondsSince(start);
+                if (round >= job.warmups)
+                {
+                    times.push_back(ms);
+                    long long sortedSum = 0;
+                    int sortedBits = 0;
+                    for (int value : arr)
+                    {
+                        sortedSum += value;
+                        sortedBits ^= value;
+                    }
+                    result.ok = result.ok && arr.size() == input.size() && sortedSum == sum && sortedBits == bits &&
+                                std::is_sorted(arr.begin(), arr.end());
+                }
+            }
+            if (!result.ok)
+            {
+                result.error = "output is not the sorted input";
+            }
+        }
+
+        result.medianMs = Benchmark::median(times);
+        result.minMs = *std::min_element(times.begin(), times.end());
+        result.maxMs = *std::max_element(times.begin(), times.end());
+    }
+    catch (const std::exception &e)
+    {
+        result.ok = false;
+        result.error = e.what();
+    }
+    return result;
+}
+
+// ==================== OUTPUT ====================
+
+void BatchRunner::writeCsvHeader(std::ostream &out)
+{
+    out << "name,algorithm,input,elements,edges,warmups,repeats,load_ms,median_ms,min_ms,max_ms,reached,ok,error\n";
+}
+
+void BatchRunner::writeCsv(std::ostream &out, const BatchResult &r)
+{
+    out << csvField(r.job.name) << ',' << r.job.algorithm << ',' << csvField(describeInput(r.job)) << ','
+        << r.elements << ',' << r.edges << ',' << r.job.warmups << ',' << r.job.repeats << ',' << r.loadMs << ','
+        << r.medianMs << ',' << r.minMs << ',' << r.maxMs << ',';
+    if (r.reached >= 0)
+    {
+        out << r.reached;
+    }
+    out << ',' << (r.ok ? "true" : "false") << ',' << csvField(r.error) << '\n';
+}
+
+void BatchRunner::writeJson(std::ostream &out, const BatchResult &r, bool first)
+{
+    out << (first ? "" : ",\n") << "  {\"name\": " << Benchmark::jsonString(r.job.name)
+        << ", \"algorithm\": " << Benchmark::jsonString(r.job.algorithm)
+        << ", \"input\": " << Benchmark::jsonString(describeInput(r.job)) << ", \"elements\": " << r.elements
+        << ", \"edges\": " << r.edges << ", \"warmups\": " << r.job.warmups << ", \"repeats\": " << r.job.repeats
+        << ", \"load_ms\": " << r.loadMs << ", \"median_ms\": " << r.medianMs << ", \"min_ms\": " << r.minMs
+        << ", \"max_ms\": " << r.maxMs << ", \"reached\": ";
+    if (r.reached >= 0)
+    {
+        out << r.reached;
+    }
+    else
+    {
+        out << "null";
+    }
+    out << ", \"ok\": " << (r.ok ? "true" : "false") << ", \"error\": ";
+    if (r.error.empty())
+    {
+        out << "null";
+    }
+    else
+    {
+        out << Benchmark::jsonString(r.error);
+    }
+    out << "}";
+}
+
+// ==================== COMMAND LINE ====================
+
+void BatchRunner::printUsage(std::ostream &out)
+{
+    out << "Usage: AlgoVaultBatch [job options] [--jobs FILE] [--csv FILE] [--json FILE]\n"
+           "  --algo NAME       algorithm to run:\n"
+           "                   ";
+    for (const std::string &name : algorithmNames())
+    {
+        out << " " << name;
+    }
+    out << "\n"
+           "  --input FILE      ints (text, or raw 32-bit in a .bin file), or an edge list\n"
+           "                    \"u v [weight]\" per line for the graph algorithms;\n"
+           "                    or either one from a .avds dataset file (make dataset)\n"
+           "  --section NAME    the array or graph of a .avds file (default: the first)\n"
+           "  --size N          without --input: generate N ints, e.g. 10M (default 1M)\n"
+           "  --dist NAME       ... from this distribution (default random)\n"
+           "  --seed N          ... with this seed (default 42)\n"
+           "  --start V         source vertex of graph jobs (default 0)\n"
+           "  --target V        destination vertex of the path_* jobs\n"
+           "  --warmup N        untimed runs first (default 0)\n"
+           "  --repeats N       timed runs (default 1)\n"
+           "  --threads N       threads for the parallel sorts, bfs_par and delta_stepping,\n"
+           "                    0 = all (default 0)\n"
+           "  --name LABEL      label of the job in the results (default: the algorithm)\n"
+           "  --jobs FILE       run the jobs in FILE, one line of job options each;\n"
+           "                    job options given here are their defaults\n"
+           "  --csv FILE        write the results as CSV (- for standard output, the default)\n"
+           "  --json FILE       write the results as JSON (- for standard output)\n";
+}
+
+int BatchRunner::main(int argc, char **argv)
+{
+    std::vector<std::string> jobArgs;
+    std::string jobsPath, csvPath, jsonPath;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                printUsage(std::cout);
+                return 0;
+            }
+            if (arg == "--jobs" || arg == "--csv" || arg == "--json")
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument("missing value for " + arg);
+                }
+                std::string &path = arg == "--jobs" ? jobsPath : arg == "--csv" ? csvPath : jsonPath;
+                path = argv[++i];
+                continue;
+            }
+            jobArgs.push_back(arg);
+        }
+
+        BatchJob defaults = parseJob(jobArgs);
+        std::vector<BatchJob> jobs;
+        if (!jobsPath.empty())
+        {
+            jobs = readJobFile(jobsPath, defaults);
+        }
+        else if (!defaults.algorithm.empty())
+        {
+            jobs.push_back(defaults);
+        }
+        else
+        {
+            throw std::invalid_argument("give --algo or --jobs");
+        }
+        if (csvPath.empty() && jsonPath.empty())
+        {
+            csvPath = "-";
+        }
+
+        std::ofstream csvFile, jsonFile;
+        std::ostream *csv = csvPath.empty() ? nullptr : &openOutput(csvPath, csvFile);
+        std::ostream *json = jsonPath.empty() ? nullptr : &openOutput(jsonPath, jsonFile);
+        if (csv)
+        {
+            writeCsvHeader(*csv);
+        }
+        if (json)
+        {
+            *json << "[\n";
+        }
+
+        int failed = 0;
+        for (std::size_t i = 0; i < jobs.size(); i++)
+        {
+            BatchResult result = run(jobs[i]);
+            if (!result.ok)
+            {
+                failed++;
+                std::cerr << "Job " << (i + 1) << " (" << result.job.name << ") failed: " << result.error << std::endl;
+            }
+            if (csv)
+            {
+                writeCsv(*csv, result);
+                csv->flush();
+            }
+            if (json)
+            {
+                writeJson(*json, result, i == 0);
+                json->flush();
+            }
+        }
+        if (json)
+        {
+            *json << "\n]\n";
+        }
+        return failed ? 2 : 0;
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include "benchmark.h"
+
+/**
+ * Headless batch runner for AlgoVault
+ * Runs sorting and graph algorithms back to back with no prompts, console
+ * clears or pauses, and writes one machine-readable result per run:
+ *   AlgoVaultBatch --algo quick --input numbers.txt --repeats 5
+ *   AlgoVaultBatch --jobs runs.txt --json results.json
+ * (AlgoVault itself runs the same way when given any arguments.)
+ * A job file holds one job per line, written as the same options, e.g.
+ *   --algo dijkstra --input roads.txt --start 0 --name roads
+ *   --algo path_astar --input roads.txt --start 0 --target 5000
+ * Blank lines and lines starting with # are skipped; options given on the
+ * command line apply to every job that does not set them itself.
+ * Inputs: sorting jobs read whitespace-separated ints from a text file or
+ * raw 32-bit ints from a .bin file (the External Sort format), or generate
+ * --size numbers like the benchmark does; graph jobs read an edge list,
+ * "u v" or "u v weight" per line (undirected, weight 1 if left out).
+ * Both can also come from a dataset file (.avds, see dataset.h), which is
+ * mapped instead of parsed; --section picks the array or graph in it.
+ * A job that fails (missing file, bad vertex) is reported with its error
+ * and the rest still run.
+ */
+
+struct BatchJob
+{
+    std::string name;      // label in the results, defaults to the algorithm
+    std::string algorithm; // a Benchmark algorithm name, or a graph algorithm (bfs, dijkstra, ...)
+    std::string input;     // file to read, empty to generate the input
+    std::string section;   // .avds input: array or graph to use, empty for the first
+    std::size_t size;      // generated sorting input: element count
+    InputDistribution distribution;
+    std::uint64_t seed;
+    int start;   // graph jobs: source vertex
+    int target;  // path_* jobs: destination vertex, -1 = not given
+    int warmups; // untimed runs before the repeats
+    int repeats; // timed runs
+    int threads; // threads of the parallel algorithms, 0 = all
+
+    BatchJob() : size(1000000), distribution(DIST_RANDOM), seed(42), start(0), target(-1), warmups(0), repeats(1),
+                 threads(0)
+    {
+    }
+};
+
+struct BatchResult
+{
+    BatchJob job;
+    std::size_t elements; // array length, or vertex count for graph jobs
+    std::size_t edges;    // graph jobs only
+    double loadMs;        // reading or generating the input
+    double medianMs;
+    double minMs;
+    double maxMs;
+    long long reached; // graph jobs: vertices reached from start (settled, for path_*); -1 for sorts
+    bool ok;           // ran, every sorting run produced the sorted input, every path had the shortest length
+    std::string error;
+
+    BatchResult() : elements(0), edges(0), loadMs(0), medianMs(0), minMs(0), maxMs(0), reached(-1), ok(false) {}
+};
+
+class BatchRunner
+{
+public:
+    // Job options ("--algo", "quick", ...) applied on top of defaults;
+    // throws std::invalid_argument for unknown or malformed options
+    static BatchJob parseJob(const std::vector<std::string> &args, const BatchJob &defaults = BatchJob());
+    static std::vector<BatchJob> readJobFile(const std::string &path, const BatchJob &defaults = BatchJob());
+
+    // Run one job; errors end up in the result instead of being thrown
+    static BatchResult run(const BatchJob &job);
+
+    static std::vector<std::string> algorithmNames();
+    static bool isGraphAlgorithm(const std::string &algorithm);
+
+    // Output, one result at a time so long batches can be followed as they run
+    static void writeCsvHeader(std::ostream &out);
+    static void writeCsv(std::ostream &out, const BatchResult &result);
+    static void writeJson(std::ostream &out, const BatchResult &result, bool first);
+
+    // The command line: options as in printUsage; returns the exit code
+    // (0 all jobs ok, 1 usage or I/O error, 2 some job failed)
+    static int main(int argc, char **argv);
+    static void printUsage(std::ostream &out);
+};
+
+#endif // BATCH_RUNNER_H
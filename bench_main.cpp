@@ -0,0 +1,201 @@
+#include "benchmark.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * Command line driver for the sorting benchmark (make bench)
+ *   AlgoVaultBench [--sizes 1K,1M] [--max-size 100M] [--dist random,sorted]
+ *                  [--algo quick,merge] [--repeats 5] [--warmup 1]
+ *                  [--threads 0] [--seed 42] [--no-counts]
+ *                  [--csv results.csv] [--json results.json]
+ * Results are printed as a table while the benchmark runs; --csv/--json
+ * also write them to a file ("-" for standard output).
+ */
+
+namespace
+{
+    void printUsage(std::ostream &out)
+    {
+        out << "Usage: AlgoVaultBench [options]\n"
+               "  --sizes LIST      element counts, e.g. 1K,10K,1M (default: 1K to 1M by decades)\n"
+               "  --max-size N      run decades from 1K up to N, e.g. 100M\n"
+               "  --dist LIST       random, sorted, reversed, organ_pipe, few_unique, sawtooth,\n"
+               "                    nearly_sorted (default: all)\n"
+               "  --algo LIST       algorithms to run (default: all):\n"
+               "                   ";
+        for (const std::string &name : Benchmark::algorithmNames())
+        {
+            out << " " << name;
+        }
+        out << "\n"
+               "  --repeats N       timed runs per case (default 5)\n"
+               "  --warmup N        untimed runs before them (default 1)\n"
+               "  --threads N       threads for the parallel sorts, 0 = all (default 0)\n"
+               "  --seed N          input generator seed (default 42)\n"
+               "  --no-counts       skip the comparison/swap counting run\n"
+               "  --csv FILE        write the results as CSV (- for standard output)\n"
+               "  --json FILE       write the results as JSON (- for standard output)\n";
+    }
+
+    std::vector<std::string> splitList(const std::string &list)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    std::vector<std::size_t> decades(std::size_t maxSize)
+    {
+        std::vector<std::size_t> sizes;
+        for (std::size_t n = 1000; n <= maxSize; n *= 10)
+        {
+            sizes.push_back(n);
+        }
+        return sizes;
+    }
+
+    void writeResults(const std::string &path, const std::vector<BenchmarkResult> &results,
+                      void (*write)(std::ostream &, const std::vector<BenchmarkResult> &))
+    {
+        if (path == "-")
+        {
+            write(std::cout, results);
+            return;
+        }
+        std::ofstream file(path.c_str());
+        if (!file)
+        {
+            throw std::runtime_error("cannot open " + path);
+        }
+        write(file, results);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkOptions options;
+    std::string csvPath, jsonPath;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                printUsage(std::cout);
+                return 0;
+            }
+            if (arg == "--no-counts")
+            {
+                options.counts = false;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            std::string value = argv[++i];
+
+            if (arg == "--sizes")
+            {
+                options.sizes.clear();
+                for (const std::string &size : splitList(value))
+                {
+                    options.sizes.push_back(Benchmark::parseCount(size));
+                }
+            }
+            else if (arg == "--max-size")
+            {
+                options.sizes = decades(Benchmark::parseCount(value));
+            }
+            else if (arg == "--dist")
+            {
+                for (const std::string &name : splitList(value))
+                {
+                    options.distributions.push_back(Benchmark::parseDistribution(name));
+                }
+            }
+            else if (arg == "--algo")
+            {
+                options.algorithms = splitList(value);
+            }
+            else if (arg == "--repeats")
+            {
+                options.repeats = static_cast<int>(Benchmark::parseCount(value));
+            }
+            else if (arg == "--warmup")
+            {
+                options.warmups = static_cast<int>(Benchmark::parseCount(value));
+            }
+            else if (arg == "--threads")
+            {
+                options.threads = static_cast<int>(Benchmark::parseCount(value));
+            }
+            else if (arg == "--seed")
+            {
+                options.seed = Benchmark::parseCount(value);
+            }
+            else if (arg == "--csv")
+            {
+                csvPath = value;
+            }
+            else if (arg == "--json")
+            {
+                jsonPath = value;
+            }
+            else
+            {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+        if (options.sizes.empty())
+        {
+            options.sizes = decades(1000000);
+        }
+
+        // The table goes to stderr when a format is written to standard output
+        std::ostream &progress = csvPath == "-" || jsonPath == "-" ? std::cerr : std::cout;
+        std::vector<BenchmarkResult> results = Benchmark::run(options, &progress);
+
+        if (!csvPath.empty())
+        {
+            writeResults(csvPath, results, Benchmark::writeCsv);
+        }
+        if (!jsonPath.empty())
+        {
+            writeResults(jsonPath, results, Benchmark::writeJson);
+        }
+
+        for (const BenchmarkResult &result : results)
+        {
+            if (!result.sorted)
+            {
+                return 2;
+            }
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,455 @@
+#include "benchmark.h"
+#include "sort_engine.h"
+#include "radix_sort.h"
+#include "parallel_sort.h"
+#include "auto_sort.h"
+#include "block_merge_sort.h"
+#include "key_value_sort.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+    // A benchmarked sort: the timed kernel, and the same algorithm run with a
+    // CountingTracer (null where the algorithm has no traced version)
+    struct BenchmarkAlgorithm
+    {
+        const char *name;
+        std::size_t maxSize;
+        void (*sort)(std::vector<int> &arr, WorkStealingPool &pool);
+        void (*count)(std::vector<int> &arr, CountingTracer &tracer);
+        bool countsSwaps; // count reports swaps and moves as well as comparisons
+    };
+
+    int last(const std::vector<int> &arr)
+    {
+        return static_cast<int>(arr.size()) - 1;
+    }
+
+    void bubbleSort(std::vector<int> &arr, WorkStealingPool &) { SortEngine::bubbleSort(arr); }
+    void quickSort(std::vector<int> &arr, WorkStealingPool &) { SortEngine::quickSort(arr); }
+    void mergeSort(std::vector<int> &arr, WorkStealingPool &) { SortEngine::mergeSort(arr); }
+    void heapSort(std::vector<int> &arr, WorkStealingPool &) { SortEngine::heapSort(arr); }
+    void lsdRadixSort(std::vector<int> &arr, WorkStealingPool &) { RadixSort::lsdSort(arr); }
+    void msdRadixSort(std::vector<int> &arr, WorkStealingPool &) { RadixSort::msdSort(arr); }
+    void engineSort(std::vector<int> &arr, WorkStealingPool &) { SortEngine::sort(arr.begin(), arr.end()); }
+    void parallelMergeSort(std::vector<int> &arr, WorkStealingPool &pool) { ParallelSort::mergeSort(arr, pool); }
+    void parallelSampleSort(std::vector<int> &arr, WorkStealingPool &pool) { ParallelSort::sampleSort(arr, pool); }
+    void blockMergeSort(std::vector<int> &arr, WorkStealingPool &) { BlockMergeSort::sort(arr.begin(), arr.end()); }
+
+    // Sort through the permutation: argsort, then one gather of the values
+    void argsort(std::vector<int> &arr, WorkStealingPool &)
+    {
+        KeyValueSort::applyPermutation(arr, KeyValueSort::argsort(arr.begin(), arr.end()));
+    }
+
+    void autoSort(std::vector<int> &arr, WorkStealingPool &pool) { AutoSort::sort(arr, pool.size()); }
+    void stdSort(std::vector<int> &arr, WorkStealingPool &) { std::sort(arr.begin(), arr.end()); }
+    void stdStableSort(std::vector<int> &arr, WorkStealingPool &) { std::stable_sort(arr.begin(), arr.end()); }
+
+    void countBubbleSort(std::vector<int> &arr, CountingTracer &tracer) { SortEngine::bubbleSort(arr, tracer); }
+    void countQuickSort(std::vector<int> &arr, CountingTracer &tracer) { SortEngine::quickSort(arr, 0, last(arr), tracer); }
+    void countMergeSort(std::vector<int> &arr, CountingTracer &tracer) { SortEngine::mergeSort(arr, 0, last(arr), tracer); }
+    void countHeapSort(std::vector<int> &arr, CountingTracer &tracer) { SortEngine::heapSort(arr, tracer); }
+    void countLsdRadixSort(std::vector<int> &arr, CountingTracer &tracer) { RadixSort::lsdSort(arr, tracer); }
+    void countMsdRadixSort(std::vector<int> &arr, CountingTracer &tracer) { RadixSort::msdSort(arr, tracer); }
+
+    void countStdSort(std::vector<int> &arr, CountingTracer &tracer)
+    {
+        std::sort(arr.begin(), arr.end(), [&tracer](int a, int b) { tracer.compare(); return a < b; });
+    }
+
+    void countStdStableSort(std::vector<int> &arr, CountingTracer &tracer)
+    {
+        std::stable_sort(arr.begin(), arr.end(), [&tracer](int a, int b) { tracer.compare(); return a < b; });
+    }
+
+    const std::size_t UNLIMITED = static_cast<std::size_t>(-1);
+
+    const BenchmarkAlgorithm algorithms[] = {
+        {"bubble", Benchmark::QUADRATIC_MAX_SIZE, bubbleSort, countBubbleSort, true},
+        {"quick", UNLIMITED, quickSort, countQuickSort, true},
+        {"merge", UNLIMITED, mergeSort, countMergeSort, true},
+        {"heap", UNLIMITED, heapSort, countHeapSort, true},
+        {"radix_lsd", UNLIMITED, lsdRadixSort, countLsdRadixSort, true},
+        {"radix_msd", UNLIMITED, msdRadixSort, countMsdRadixSort, true},
+        {"engine_sort", UNLIMITED, engineSort, nullptr, false},
+        {"parallel_merge", UNLIMITED, parallelMergeSort, nullptr, false},
+        {"parallel_sample", UNLIMITED, parallelSampleSort, nullptr, false},
+        {"block_merge", UNLIMITED, blockMergeSort, nullptr, false},
+        {"argsort", UNLIMITED, argsort, nullptr, false},
+        {"auto", UNLIMITED, autoSort, nullptr, false},
+        {"std_sort", UNLIMITED, stdSort, countStdSort, false},
+        {"std_stable_sort", UNLIMITED, stdStableSort, countStdStableSort, false}};
+
+    const char *const distributionNames[DIST_COUNT] = {
+        "random", "sorted", "reversed", "organ_pipe", "few_unique", "sawtooth", "nearly_sorted"};
+
+    const BenchmarkAlgorithm &findAlgorithm(const std::string &name)
+    {
+        for (const BenchmarkAlgorithm &algorithm : algorithms)
+        {
+            if (name == algorithm.name)
+            {
+                return algorithm;
+            }
+        }
+        throw std::invalid_argument("unknown algorithm: " + name);
+    }
+
+    // Counts an algorithm does not report are written as missing
+    void writeCount(std::ostream &out, long long count, const char *missing)
+    {
+        if (count >= 0)
+        {
+            out << count;
+        }
+        else
+        {
+            out << missing;
+        }
+    }
+}
+
+// Quotes, backslashes and every control character are escaped, the
+// latter as \u00XX; other bytes (UTF-8) are copied as they are
+std::string Benchmark::jsonString(const std::string &s)
+{
+    static const char HEX[] = "0123456789abcdef";
+    std::string quoted = "\"";
+    for (char c : s)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if (c == '\n')
+        {
+            quoted += "\\n";
+        }
+        else if (byte < 0x20 || byte == 0x7f)
+        {
+            quoted += "\\u00";
+            quoted += HEX[byte >> 4];
+            quoted += HEX[byte & 15];
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// ==================== INPUT GENERATION ====================
+
+std::vector<int> Benchmark::generate(InputDistribution distribution, std::size_t n, std::uint64_t seed)
+{
+    std::vector<int> arr(n);
+    std::mt19937_64 rng(seed);
+
+    switch (distribution)
+    {
+    case DIST_RANDOM:
+        for (int &value : arr)
+        {
+            value = static_cast<int>(rng());
+        }
+        break;
+    case DIST_SORTED:
+        for (std::size_t i = 0; i < n; i++)
+        {
+            arr[i] = static_cast<int>(i);
+        }
+        break;
+    case DIST_REVERSED:
+        for (std::size_t i = 0; i < n; i++)
+        {
+            arr[i] = static_cast<int>(n - 1 - i);
+        }
+        break;
+    case DIST_ORGAN_PIPE:
+        for (std::size_t i = 0; i < n; i++)
+        {
+            arr[i] = static_cast<int>(std::min(i, n - 1 - i));
+        }
+        break;
+    case DIST_FEW_UNIQUE:
+        for (int &value : arr)
+        {
+            value = static_cast<int>(rng() % 16);
+        }
+        break;
+    case DIST_SAWTOOTH:
+    {
+        std::size_t period = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(n))));
+        for (std::size_t i = 0; i < n; i++)
+        {
+            arr[i] = static_cast<int>(i % period);
+        }
+        break;
+    }
+    case DIST_NEARLY_SORTED:
+        for (std::size_t i = 0; i < n; i++)
+        {
+            arr[i] = static_cast<int>(i);
+        }
+        if (n > 1)
+        {
+            for (std::size_t swaps = std::max<std::size_t>(1, n / 200); swaps > 0; swaps--)
+            {
+                std::swap(arr[rng() % n], arr[rng() % n]);
+            }
+        }
+        break;
+    default:
+        throw std::invalid_argument("unknown input distribution");
+    }
+
+    return arr;
+}
+
+const char *Benchmark::distributionName(InputDistribution distribution)
+{
+    return distribution >= 0 && distribution < DIST_COUNT ? distributionNames[distribution] : "unknown";
+}
+
+InputDistribution Benchmark::parseDistribution(const std::string &name)
+{
+    for (int d = 0; d < DIST_COUNT; d++)
+    {
+        if (name == distributionNames[d])
+        {
+            return static_cast<InputDistribution>(d);
+        }
+    }
+    throw std::invalid_argument("unknown input distribution: " + name);
+}
+
+std::vector<std::string> Benchmark::algorithmNames()
+{
+    std::vector<std::string> names;
+    for (const BenchmarkAlgorithm &algorithm : algorithms)
+    {
+        names.push_back(algorithm.name);
+    }
+    return names;
+}
+
+void Benchmark::sort(const std::string &algorithm, std::vector<int> &arr, WorkStealingPool &pool)
+{
+    findAlgorithm(algorithm).sort(arr, pool);
+}
+
+// Powers of 1000: 10K is 10000
+std::size_t Benchmark::parseCount(const std::string &text)
+{
+    char *end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(text.c_str(), &end, 10);
+    if (end == text.c_str() || text[0] == '-')
+    {
+        throw std::invalid_argument("not a number: " + text);
+    }
+    std::string suffix(end);
+    unsigned long long scale = 1;
+    if (suffix == "K" || suffix == "k")
+    {
+        scale = 1000;
+    }
+    else if (suffix == "M" || suffix == "m")
+    {
+        scale = 1000000;
+    }
+    else if (suffix == "G" || suffix == "g")
+    {
+        scale = 1000000000;
+    }
+    else if (!suffix.empty())
+    {
+        throw std::invalid_argument("not a number: " + text);
+    }
+    if (errno == ERANGE || value > std::numeric_limits<std::size_t>::max() / scale)
+    {
+        throw std::invalid_argument("number too large: " + text);
+    }
+    return static_cast<std::size_t>(value * scale);
+}
+
+double Benchmark::median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    std::size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2;
+}
+
+// ==================== BENCHMARK RUN ====================
+
+std::vector<BenchmarkResult> Benchmark::run(const BenchmarkOptions &options, std::ostream *progress)
+{
+    if (options.repeats < 1 || options.warmups < 0)
+    {
+        throw std::invalid_argument("repeats must be positive and warm-ups non-negative");
+    }
+
+    std::vector<InputDistribution> distributions = options.distributions;
+    if (distributions.empty())
+    {
+        for (int d = 0; d < DIST_COUNT; d++)
+        {
+            distributions.push_back(static_cast<InputDistribution>(d));
+        }
+    }
+    std::vector<const BenchmarkAlgorithm *> selected;
+    for (const std::string &name : options.algorithms.empty() ? algorithmNames() : options.algorithms)
+    {
+        selected.push_back(&findAlgorithm(name));
+    }
+
+    WorkStealingPool pool(options.threads);
+    std::vector<BenchmarkResult> results;
+    std::vector<int> arr;
+
+    for (std::size_t n : options.sizes)
+    {
+        for (InputDistribution distribution : distributions)
+        {
+            const std::vector<int> input = generate(distribution, n, options.seed);
+            std::vector<int> expected = input;
+            std::sort(expected.begin(), expected.end());
+
+            for (const BenchmarkAlgorithm *algorithm : selected)
+            {
+                if (n > algorithm->maxSize)
+                {
+                    continue;
+                }
+
+                BenchmarkResult result;
+                result.algorithm = algorithm->name;
+                result.distribution = distribution;
+                result.size = n;
+                result.repeats = options.repeats;
+                result.comparisons = result.swaps = result.moves = -1;
+                result.sorted = true;
+
+                std::vector<double> times;
+                for (int round = 0; round < options.warmups + options.repeats; round++)
+                {
+                    arr = input;
+                    auto start = std::chrono::steady_clock::now();
+                    algorithm->sort(arr, pool);
+                    auto stop = std::chrono::steady_clock::now();
+
+                    if (round >= options.warmups)
+                    {
+                        times.push_back(std::chrono::duration<double, std::nano>(stop - start).count() /
+                                        std::max<std::size_t>(n, 1));
+                        result.sorted = result.sorted && arr == expected;
+                    }
+                }
+                result.medianNs = median(times);
+                result.minNs = *std::min_element(times.begin(), times.end());
+                result.maxNs = *std::max_element(times.begin(), times.end());
+
+                if (options.counts && algorithm->count)
+                {
+                    CountingTracer tracer;
+                    arr = input;
+                    algorithm->count(arr, tracer);
+                    result.comparisons = tracer.comparisons;
+                    if (algorithm->countsSwaps)
+                    {
+                        result.swaps = tracer.swaps;
+                        result.moves = tracer.moves;
+                    }
+                }
+
+                results.push_back(result);
+                if (progress)
+                {
+                    writeTable(*progress, std::vector<BenchmarkResult>(1, result));
+                }
+            }
+        }
+    }
+
+    return results;
+}
+
+// ==================== OUTPUT ====================
+
+void Benchmark::writeTable(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    std::ios::fmtflags flags = out.flags();
+    for (const BenchmarkResult &r : results)
+    {
+        out << std::left << std::setw(16) << r.algorithm << std::setw(14) << distributionName(r.distribution)
+            << std::right << std::setw(10) << r.size << std::fixed << std::setprecision(2)
+            << std::setw(10) << r.medianNs << " ns/elem"
+            << "  [" << r.minNs << " .. " << r.maxNs << "]";
+        if (r.comparisons >= 0)
+        {
+            out << "  cmp " << r.comparisons;
+        }
+        if (r.swaps >= 0)
+        {
+            out << "  swp " << r.swaps << "  mov " << r.moves;
+        }
+        if (!r.sorted)
+        {
+            out << "  NOT SORTED";
+        }
+        out << std::endl;
+    }
+    out.flags(flags);
+}
+
+void Benchmark::writeCsv(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    out << "algorithm,distribution,size,repeats,median_ns_per_element,min_ns_per_element,"
+           "max_ns_per_element,comparisons,swaps,moves,sorted\n";
+    for (const BenchmarkResult &r : results)
+    {
+        out << r.algorithm << ',' << distributionName(r.distribution) << ',' << r.size << ','
+            << r.repeats << ',' << r.medianNs << ',' << r.minNs << ',' << r.maxNs << ',';
+        writeCount(out, r.comparisons, "");
+        out << ',';
+        writeCount(out, r.swaps, "");
+        out << ',';
+        writeCount(out, r.moves, "");
+        out << ',' << (r.sorted ? "true" : "false") << '\n';
+    }
+}
+
+void Benchmark::writeJson(std::ostream &out, const std::vector<BenchmarkResult> &results)
+{
+    out << "[\n";
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        const BenchmarkResult &r = results[i];
+        out << "  {\"algorithm\": " << jsonString(r.algorithm)
+            << ", \"distribution\": " << jsonString(distributionName(r.distribution))
+            << ", \"size\": " << r.size << ", \"repeats\": " << r.repeats
+            << ", \"median_ns_per_element\": " << r.medianNs
+            << ", \"min_ns_per_element\": " << r.minNs
+            << ", \"max_ns_per_element\": " << r.maxNs;
+        out << ", \"comparisons\": ";
+        writeCount(out, r.comparisons, "null");
+        out << ", \"swaps\": ";
+        writeCount(out, r.swaps, "null");
+        out << ", \"moves\": ";
+        writeCount(out, r.moves, "null");
+        out << ", \"sorted\": " << (r.sorted ? "true" : "false") << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
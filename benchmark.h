@@ -0,0 +1,99 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+/**
+ * Benchmark suite for the sorting kernels
+ * Times the un-instrumented kernels behind sorting.h (plus the parallel
+ * sorts and std::sort/std::stable_sort as baselines) on int arrays of
+ * several sizes and input distributions. Each case runs warm-up rounds and
+ * then timed repeats on fresh copies of the same input; the median, minimum
+ * and maximum are reported in ns per element. Comparison, swap and move
+ * counts come from one extra, untimed run with a CountingTracer (that run uses
+ * insertion sort leaves instead of the sorting networks, so its counts are
+ * those of the scalar algorithm).
+ * Builds without utils.cpp/main.cpp, so it runs on any platform: make bench
+ */
+
+class WorkStealingPool;
+
+// Input patterns the benchmark generates
+enum InputDistribution
+{
+    DIST_RANDOM,        // uniform random ints
+    DIST_SORTED,        // 0, 1, 2, ...
+    DIST_REVERSED,      // n-1, n-2, ..., 0
+    DIST_ORGAN_PIPE,    // ascending to the middle, then descending
+    DIST_FEW_UNIQUE,    // random values from a set of 16
+    DIST_SAWTOOTH,      // ascending ramps of about sqrt(n) elements
+    DIST_NEARLY_SORTED, // sorted, then 1% of the elements swapped at random
+    DIST_COUNT
+};
+
+struct BenchmarkOptions
+{
+    std::vector<std::size_t> sizes;                // element counts to run
+    std::vector<InputDistribution> distributions; // empty: all of them
+    std::vector<std::string> algorithms;          // empty: all of them
+    int warmups;                                   // untimed runs before the repeats
+    int repeats;                                   // timed runs per case
+    int threads;                                   // parallel sort threads, 0 = all
+    bool counts;                                   // also collect comparison/swap counts
+    std::uint64_t seed;
+
+    BenchmarkOptions() : warmups(1), repeats(5), threads(0), counts(true), seed(42) {}
+};
+
+struct BenchmarkResult
+{
+    std::string algorithm;
+    InputDistribution distribution;
+    std::size_t size;
+    int repeats;
+    double medianNs; // ns per element
+    double minNs;
+    double maxNs;
+    long long comparisons; // -1 where the algorithm cannot be counted
+    long long swaps;
+    long long moves;
+    bool sorted; // every timed run produced a sorted array
+};
+
+class Benchmark
+{
+public:
+    // Bubble sort is skipped on larger inputs
+    enum
+    {
+        QUADRATIC_MAX_SIZE = 1 << 15
+    };
+
+    static std::vector<BenchmarkResult> run(const BenchmarkOptions &options, std::ostream *progress = nullptr);
+
+    static std::vector<int> generate(InputDistribution distribution, std::size_t n, std::uint64_t seed);
+
+    static const char *distributionName(InputDistribution distribution);
+    static InputDistribution parseDistribution(const std::string &name);
+    static std::vector<std::string> algorithmNames();
+    // Run one of algorithmNames() on arr, untimed and unchecked; throws
+    // std::invalid_argument for any other name (used by the batch runner)
+    static void sort(const std::string &algorithm, std::vector<int> &arr, WorkStealingPool &pool);
+
+    // Output formats
+    static void writeTable(std::ostream &out, const std::vector<BenchmarkResult> &results);
+    static void writeCsv(std::ostream &out, const std::vector<BenchmarkResult> &results);
+    static void writeJson(std::ostream &out, const std::vector<BenchmarkResult> &results);
+    // s as a JSON string literal, quotes included (also used by the batch runner)
+    static std::string jsonString(const std::string &s);
+
+    // Shared with bench_main and the batch runner: a non-negative count with an
+    // optional K/M/G suffix (throws std::invalid_argument), and the median
+    static std::size_t parseCount(const std::string &text);
+    static double median(std::vector<double> values);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,423 @@
+#ifndef BLOCK_MERGE_SORT_H
+#define BLOCK_MERGE_SORT_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <iterator>
+#include <cstddef>
+#include <cmath>
+#include "sort_traits.h"
+
+/**
+ * Stable block merge sort for AlgoVault (after WikiSort)
+ * A bottom-up merge sort whose merges need only a small buffer:
+ *   - a merge whose shorter run fits in the buffer is an ordinary buffered
+ *     merge;
+ *   - longer runs are block merged: A is cut into blocks of about sqrt(|A|)
+ *     elements that are rolled through B and dropped where their first
+ *     element belongs, and each dropped block is merged locally with the B
+ *     elements in front of it, from the buffer when a block fits there and
+ *     with rotations otherwise.
+ * The buffer size is chosen by the caller: SQRT_BUFFER (the default) takes
+ * sqrt(n) elements and keeps the sort O(n log n); 0 works without a buffer
+ * (local merges by rotation, O(n log^2 n) in the worst case); the more it is
+ * given, the more merges are plain buffered merges. Besides the buffer only
+ * one index per block, O(sqrt(n)), is allocated.
+ * Positions are std::ptrdiff_t, so ranges are not limited to 2^31 elements.
+ */
+
+class BlockMergeSort
+{
+public:
+    enum
+    {
+        SQRT_BUFFER = -1,           // bufferSize for a buffer of sqrt(n) elements
+        INSERTION_SORT_RUN = 16     // the first pass insertion sorts runs of this length
+    };
+
+    // Stable sort of [first, last) by comp(proj(a), proj(b)) with a merge
+    // buffer of bufferSize elements (SQRT_BUFFER: sqrt(last - first))
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void sort(Iter first, Iter last, std::ptrdiff_t bufferSize = SQRT_BUFFER,
+                     Compare comp = Compare(), Projection proj = Projection());
+
+private:
+    typedef std::ptrdiff_t Index;
+
+    // Buffer and block bookkeeping shared by the merges of one sort
+    template <typename Value>
+    struct Workspace
+    {
+        Value *cache;
+        Index cacheSize;
+        Index *tags; // original position of each rolling A block
+    };
+
+    template <typename Iter, typename Compare>
+    static void insertionSort(Iter arr, Index begin, Index end, Compare &comp);
+
+    // First position in [begin, end) whose element is not less than value
+    template <typename Iter, typename T, typename Compare>
+    static Index lowerBound(Iter arr, Index begin, Index end, const T &value, Compare &comp);
+    // First position in [begin, end) whose element is greater than value
+    template <typename Iter, typename T, typename Compare>
+    static Index upperBound(Iter arr, Index begin, Index end, const T &value, Compare &comp);
+
+    // Swap [a, a + count) with [b, b + count)
+    template <typename Iter>
+    static void blockSwap(Iter arr, Index a, Index b, Index count)
+    {
+        std::swap_ranges(arr + a, arr + a + count, arr + b);
+    }
+    // Rotate [begin, end) so that mid comes first, through the cache when one side fits
+    template <typename Iter, typename Value>
+    static void rotate(Iter arr, Index begin, Index mid, Index end, Value *cache, Index cacheSize);
+
+    template <typename Iter, typename Value, typename Compare>
+    static void merge(Iter arr, Index begin, Index mid, Index end, Workspace<Value> &work, Compare &comp);
+    template <typename Iter, typename Value, typename Compare>
+    static void blockMerge(Iter arr, Index begin, Index mid, Index end, Workspace<Value> &work, Compare &comp);
+
+    // Merge A (cached in cache[0, lenA)) with B = [mid, end) into [mid - lenA, end)
+    template <typename Iter, typename Value, typename Compare>
+    static void mergeFromCache(Iter arr, Value *cache, Index lenA, Index mid, Index end, Compare &comp);
+    // Merge A = [begin, mid) with B (cached in cache[0, end - mid)) into [begin, end)
+    template <typename Iter, typename Value, typename Compare>
+    static void mergeFromCacheBackward(Iter arr, Index begin, Index mid, Index end, Value *cache, Compare &comp);
+    // Merge [begin, mid) with [mid, end) by rotations (recursive halving),
+    // through the cache once a run fits in it
+    template <typename Iter, typename Value, typename Compare>
+    static void mergeInPlace(Iter arr, Index begin, Index mid, Index end, Value *cache, Index cacheSize,
+                             Compare &comp);
+};
+
+// ==================== DRIVER ====================
+
+template <typename Iter, typename Compare, typename Projection>
+void BlockMergeSort::sort(Iter first, Iter last, std::ptrdiff_t bufferSize, Compare comp, Projection proj)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+
+    Index n = last - first;
+    if (n < 2)
+        return;
+
+    Index sqrtN = static_cast<Index>(std::ceil(std::sqrt(static_cast<double>(n))));
+    if (bufferSize < 0)
+        bufferSize = sqrtN;
+    // No merge ever needs more than its shorter run
+    bufferSize = std::min<Index>(bufferSize, n / 2);
+
+    std::vector<Value> cache(bufferSize);
+    std::vector<Index> tags(sqrtN + 1);
+    Workspace<Value> work = {cache.data(), bufferSize, tags.data()};
+
+    for (Index begin = 0; begin < n; begin += INSERTION_SORT_RUN)
+        insertionSort(first, begin, std::min<Index>(begin + INSERTION_SORT_RUN, n), order);
+
+    for (Index width = INSERTION_SORT_RUN; width < n; width *= 2)
+    {
+        for (Index begin = 0; begin + width < n; begin += 2 * width)
+            merge(first, begin, begin + width, std::min(begin + 2 * width, n), work, order);
+    }
+}
+
+template <typename Iter, typename Compare>
+void BlockMergeSort::insertionSort(Iter arr, Index begin, Index end, Compare &comp)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    for (Index i = begin + 1; i < end; i++)
+    {
+        if (!comp(arr[i], arr[i - 1]))
+            continue;
+        Value value = std::move(arr[i]);
+        Index j = i;
+        do
+        {
+            arr[j] = std::move(arr[j - 1]);
+            j--;
+        } while (j > begin && comp(value, arr[j - 1]));
+        arr[j] = std::move(value);
+    }
+}
+
+template <typename Iter, typename T, typename Compare>
+BlockMergeSort::Index BlockMergeSort::lowerBound(Iter arr, Index begin, Index end, const T &value, Compare &comp)
+{
+    while (begin < end)
+    {
+        Index mid = begin + (end - begin) / 2;
+        if (comp(arr[mid], value))
+            begin = mid + 1;
+        else
+            end = mid;
+    }
+    return begin;
+}
+
+template <typename Iter, typename T, typename Compare>
+BlockMergeSort::Index BlockMergeSort::upperBound(Iter arr, Index begin, Index end, const T &value, Compare &comp)
+{
+    while (begin < end)
+    {
+        Index mid = begin + (end - begin) / 2;
+        if (comp(value, arr[mid]))
+            end = mid;
+        else
+            begin = mid + 1;
+    }
+    return begin;
+}
+
+template <typename Iter, typename Value>
+void BlockMergeSort::rotate(Iter arr, Index begin, Index mid, Index end, Value *cache, Index cacheSize)
+{
+    Index left = mid - begin, right = end - mid;
+    if (left == 0 || right == 0)
+        return;
+    if (left <= cacheSize)
+    {
+        std::move(arr + begin, arr + mid, cache);
+        std::move(arr + mid, arr + end, arr + begin);
+        std::move(cache, cache + left, arr + begin + right);
+    }
+    else if (right <= cacheSize)
+    {
+        std::move(arr + mid, arr + end, cache);
+        std::move_backward(arr + begin, arr + mid, arr + end);
+        std::move(cache, cache + right, arr + begin);
+    }
+    else
+    {
+        std::rotate(arr + begin, arr + mid, arr + end);
+    }
+}
+
+// ==================== MERGING ====================
+
+template <typename Iter, typename Value, typename Compare>
+void BlockMergeSort::merge(Iter arr, Index begin, Index mid, Index end, Workspace<Value> &work, Compare &comp)
+{
+    // Already in order, or B entirely before A
+    if (!comp(arr[mid], arr[mid - 1]))
+        return;
+    if (comp(arr[end - 1], arr[begin]))
+    {
+        rotate(arr, begin, mid, end, work.cache, work.cacheSize);
+        return;
+    }
+
+    // Leave out the prefix of A and the suffix of B that are already in place
+    begin = upperBound(arr, begin, mid, arr[mid], comp);
+    end = lowerBound(arr, mid, end, arr[mid - 1], comp);
+
+    if (mid - begin <= work.cacheSize)
+    {
+        std::move(arr + begin, arr + mid, work.cache);
+        mergeFromCache(arr, work.cache, mid - begin, mid, end, comp);
+    }
+    else if (end - mid <= work.cacheSize)
+    {
+        std::move(arr + mid, arr + end, work.cache);
+        mergeFromCacheBackward(arr, begin, mid, end, work.cache, comp);
+    }
+    else
+    {
+        blockMerge(arr, begin, mid, end, work, comp);
+    }
+}
+
+template <typename Iter, typename Value, typename Compare>
+void BlockMergeSort::mergeFromCache(Iter arr, Value *cache, Index lenA, Index mid, Index end, Compare &comp)
+{
+    Value *a = cache, *aEnd = cache + lenA;
+    Index out = mid - lenA, b = mid;
+    while (a < aEnd && b < end)
+    {
+        if (comp(arr[b], *a))
+            arr[out++] = std::move(arr[b++]);
+        else
+            arr[out++] = std::move(*a++);
+    }
+    // What is left of B is already in place
+    std::move(a, aEnd, arr + out);
+}
+
+template <typename Iter, typename Value, typename Compare>
+void BlockMergeSort::mergeFromCacheBackward(Iter arr, Index begin, Index mid, Index end, Value *cache, Compare &comp)
+{
+    Value *b = cache + (end - mid);
+    Index a = mid, out = end;
+    while (a > begin && b > cache)
+    {
+        if (comp(*(b - 1), arr[a - 1]))
+            arr[--out] = std::move(arr[--a]);
+        else
+            arr[--out] = std::move(*--b);
+    }
+    std::move_backward(cache, b, arr + out);
+}
+
+template <typename Iter, typename Value, typename Compare>
+void BlockMergeSort::mergeInPlace(Iter arr, Index begin, Index mid, Index end, Value *cache, Index cacheSize,
+                                  Compare &comp)
+{
+    while (begin < mid && mid < end)
+    {
+        if (mid - begin <= cacheSize)
+        {
+            std::move(arr + begin, arr + mid, cache);
+            mergeFromCache(arr, cache, mid - begin, mid, end, comp);
+            return;
+        }
+        if (end - mid <= cacheSize)
+        {
+            std::move(arr + mid, arr + end, cache);
+            mergeFromCacheBackward(arr, begin, mid, end, cache, comp);
+            return;
+        }
+
+        if (mid - begin == 1 && end - mid == 1)
+        {
+            if (comp(arr[mid], arr[begin]))
+                std::iter_swap(arr + begin, arr + mid);
+            return;
+        }
+
+        // Split the longer run in half and the other one where that middle
+        // element belongs, swap the two inner pieces, and merge both halves
+        Index cutA, cutB;
+        if (mid - begin > end - mid)
+        {
+            cutA = begin + (mid - begin) / 2;
+            cutB = lowerBound(arr, mid, end, arr[cutA], comp);
+        }
+        else
+        {
+            cutB = mid + (end - mid) / 2;
+            cutA = upperBound(arr, begin, mid, arr[cutB], comp);
+        }
+        rotate(arr, cutA, mid, cutB, cache, cacheSize);
+        Index split = cutA + (cutB - mid);
+        mergeInPlace(arr, begin, cutA, split, cache, cacheSize, comp);
+        begin = split;
+        mid = cutB;
+    }
+}
+
+// Merge A = [begin, mid) with B = [mid, end), both longer than the buffer
+// The full A blocks roll through B in a group, each swapped with the next
+// B block; whenever the block that came first in A (found by its tag, so
+// equal keys keep their order) has a first element not greater than the
+// last element of the B block just passed, that A block is dropped there,
+// and the A block dropped before it is merged with the B elements between
+// the two. Every local merge involves one A block, so the cache needs to
+// hold a block, not a run.
+template <typename Iter, typename Value, typename Compare>
+void BlockMergeSort::blockMerge(Iter arr, Index begin, Index mid, Index end, Workspace<Value> &work, Compare &comp)
+{
+    Index lenA = mid - begin;
+    Index blockSize = static_cast<Index>(std::sqrt(static_cast<double>(lenA)));
+    bool cached = blockSize <= work.cacheSize;
+
+    // A's uneven first block is the first one dropped
+    Index lastA = begin, lastAEnd = begin + lenA % blockSize;
+    Index lastB = lastAEnd, lastBEnd = lastAEnd;
+    Index blockA = lastAEnd, blockAEnd = mid;
+    Index blockB = mid, blockBEnd = mid + std::min(blockSize, end - mid);
+
+    // tags[(head + i) % blockCount] is the original index of the i-th rolling A block
+    Index blockCount = (blockAEnd - blockA) / blockSize;
+    Index head = 0, remaining = blockCount, minA = 0;
+    Index *tags = work.tags;
+    for (Index i = 0; i < blockCount; i++)
+        tags[i] = i;
+
+    if (cached)
+        std::move(arr + lastA, arr + lastAEnd, work.cache);
+
+    while (remaining > 0)
+    {
+        Index minStart = blockA + minA * blockSize;
+        if ((lastBEnd > lastB && !comp(arr[lastBEnd - 1], arr[minStart])) || blockB == blockBEnd)
+        {
+            // Drop the first A block here: split the last B block at its
+            // first element and bring it to the front of the rolling group
+            Index split = lowerBound(arr, lastB, lastBEnd, arr[minStart], comp);
+            Index rest = lastBEnd - split;
+            blockSwap(arr, blockA, minStart, blockSize);
+            std::swap(tags[head], tags[(head + minA) % blockCount]);
+
+            // Merge the previously dropped A block with the B elements after it
+            if (cached)
+                mergeFromCache(arr, work.cache, lastAEnd - lastA, lastAEnd, split, comp);
+            else
+                mergeInPlace(arr, lastA, lastAEnd, split, work.cache, work.cacheSize, comp);
+
+            // Put the dropped block in front of the rest of the split B block;
+            // when it is cached its old place can simply be swapped over
+            if (cached)
+            {
+                std::move(arr + blockA, arr + blockA + blockSize, work.cache);
+                blockSwap(arr, split, blockA + blockSize - rest, rest);
+            }
+            else
+            {
+                rotate(arr, split, blockA, blockA + blockSize, work.cache, work.cacheSize);
+            }
+
+            lastA = blockA - rest;
+            lastAEnd = lastA + blockSize;
+            lastB = lastAEnd;
+            lastBEnd = lastB + rest;
+            blockA += blockSize;
+            head = (head + 1) % blockCount;
+            remaining--;
+
+            minA = 0;
+            for (Index i = 1; i < remaining; i++)
+            {
+                if (tags[(head + i) % blockCount] < tags[(head + minA) % blockCount])
+                    minA = i;
+            }
+        }
+        else if (blockBEnd - blockB < blockSize)
+        {
+            // The uneven last B block goes in front of the rolling group
+            // (the cache may hold the last dropped A block, so not through it)
+            Index len = blockBEnd - blockB;
+            rotate(arr, blockA, blockB, blockBEnd, work.cache, Index(0));
+            lastB = blockA;
+            lastBEnd = blockA + len;
+            blockA += len;
+            blockAEnd += len;
+            blockB = blockBEnd;
+        }
+        else
+        {
+            // Roll the group on: its first block swaps places with the next B block
+            blockSwap(arr, blockA, blockB, blockSize);
+            tags[(head + remaining) % blockCount] = tags[head];
+            head = (head + 1) % blockCount;
+            minA = minA == 0 ? remaining - 1 : minA - 1;
+
+            lastB = blockA;
+            lastBEnd = blockA + blockSize;
+            blockA += blockSize;
+            blockAEnd += blockSize;
+            blockB += blockSize;
+            blockBEnd = std::min(blockBEnd + blockSize, end);
+        }
+    }
+
+    // The last dropped A block and whatever is left of B
+    if (cached)
+        mergeFromCache(arr, work.cache, lastAEnd - lastA, lastAEnd, end, comp);
+    else
+        mergeInPlace(arr, lastA, lastAEnd, end, work.cache, work.cacheSize, comp);
+}
+
+#endif // BLOCK_MERGE_SORT_H
@@ -19,7 +19,7 @@ echo Compiling AlgoVault...
 echo.
 
 REM Compile the project
-g++ -std=c++11 -Wall -Wextra -O2 -o AlgoVault.exe main.cpp utils.cpp sorting.cpp graph.cpp
+g++ -std=c++11 -Wall -Wextra -O2 -pthread -o AlgoVault.exe main.cpp utils.cpp sorting.cpp graph.cpp graph_core.cpp csr_graph.cpp graph_bfs.cpp graph_sssp.cpp graph_paths.cpp thread_pool.cpp parallel_sort.cpp auto_sort.cpp external_sort.cpp trace_log.cpp renderer.cpp benchmark.cpp batch_runner.cpp bulk_loader.cpp mapped_file.cpp dataset.cpp
 
 REM Check if compilation was successful
 if errorlevel 1 (
@@ -0,0 +1,247 @@
+#include "bulk_loader.h"
+#include "mapped_file.h"
+#include "dataset.h"
+#include "thread_pool.h"
+#include "external_sort.h"
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    inline bool isSpace(char c)
+    {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    inline bool isDigit(char c)
+    {
+        return static_cast<unsigned>(c - '0') < 10u;
+    }
+
+    bool littleEndian()
+    {
+        const std::uint32_t one = 1;
+        unsigned char first;
+        std::memcpy(&first, &one, 1);
+        return first == 1;
+    }
+
+    void swapBytes(std::vector<int> &arr)
+    {
+        for (int &value : arr)
+        {
+            std::uint32_t v = static_cast<std::uint32_t>(value);
+            v = (v >> 24) | ((v >> 8) & 0xFF00u) | ((v << 8) & 0xFF0000u) | (v << 24);
+            value = static_cast<int>(v);
+        }
+    }
+
+    // Parse a whole mapped file; pool may be null for a single-threaded parse
+    std::vector<int> parseFile(const MappedFile &file, WorkStealingPool *pool)
+    {
+        const char *data = file.data();
+        std::size_t size = file.size();
+
+        // Chunk boundaries are moved forward to the next whitespace, so no
+        // number is split between two chunks
+        std::size_t chunks = 1;
+        if (pool)
+        {
+            chunks = std::min<std::size_t>(static_cast<std::size_t>(pool->size()) * BulkLoader::CHUNKS_PER_THREAD,
+                                           size / BulkLoader::MIN_CHUNK_BYTES);
+            chunks = std::max<std::size_t>(chunks, 1);
+        }
+        std::vector<std::size_t> bounds(chunks + 1, size);
+        bounds[0] = 0;
+        for (std::size_t c = 1; c < chunks; c++)
+        {
+            std::size_t b = std::max(size / chunks * c, bounds[c - 1]);
+            while (b < size && !isSpace(data[b]))
+                b++;
+            bounds[c] = b;
+        }
+
+        std::vector<std::size_t> offsets(chunks + 1, 0);
+        std::vector<std::ptrdiff_t> errors(chunks, -1);
+        std::vector<int> arr;
+
+        if (!pool || chunks == 1)
+        {
+            arr.resize(BulkLoader::count(data, data + size));
+            errors[0] = BulkLoader::parse(data, data + size, arr.data());
+        }
+        else
+        {
+            {
+                TaskGroup group(*pool);
+                for (std::size_t c = 0; c < chunks; c++)
+                {
+                    group.run([&, c]()
+                              { offsets[c + 1] = BulkLoader::count(data + bounds[c], data + bounds[c + 1]); });
+                }
+                group.wait();
+            }
+            for (std::size_t c = 0; c < chunks; c++)
+            {
+                offsets[c + 1] += offsets[c];
+            }
+
+            arr.resize(offsets[chunks]);
+            {
+                TaskGroup group(*pool);
+                for (std::size_t c = 0; c < chunks; c++)
+                {
+                    group.run([&, c]()
+                              { errors[c] = BulkLoader::parse(data + bounds[c], data + bounds[c + 1],
+                                                              arr.data() + offsets[c]); });
+                }
+                group.wait();
+            }
+        }
+
+        for (std::size_t c = 0; c < chunks; c++)
+        {
+            if (errors[c] >= 0)
+            {
+                throw std::runtime_error(file.name() + ": not a 32-bit integer at byte " +
+                                         std::to_string(bounds[c] + errors[c]));
+            }
+        }
+        return arr;
+    }
+}
+
+// ==================== PARSING ====================
+
+std::size_t BulkLoader::count(const char *begin, const char *end)
+{
+    std::size_t numbers = 0;
+    bool inNumber = false;
+    for (const char *p = begin; p < end; p++)
+    {
+        bool space = isSpace(*p);
+        numbers += !space && !inNumber;
+        inNumber = !space;
+    }
+    return numbers;
+}
+
+std::ptrdiff_t BulkLoader::parse(const char *begin, const char *end, int *out)
+{
+    const std::uint64_t limit = static_cast<std::uint64_t>(std::numeric_limits<int>::max()) + 1;
+    const char *p = begin;
+
+    while (true)
+    {
+        while (p < end && isSpace(*p))
+            p++;
+        if (p == end)
+            return -1;
+
+        const char *start = p;
+        bool negative = *p == '-';
+        if (*p == '-' || *p == '+')
+            p++;
+        if (p == end || !isDigit(*p))
+            return start - begin;
+
+        std::uint64_t value = 0;
+        while (p < end && isDigit(*p))
+        {
+            value = value * 10 + static_cast<unsigned>(*p - '0');
+            if (value > limit)
+                return start - begin;
+            p++;
+        }
+        if ((p < end && !isSpace(*p)) || (!negative && value == limit))
+            return start - begin;
+
+        *out++ = negative ? static_cast<int>(-static_cast<std::int64_t>(value)) : static_cast<int>(value);
+    }
+}
+
+// ==================== LOADING ====================
+
+std::vector<int> BulkLoader::loadText(const std::string &path, WorkStealingPool &pool)
+{
+    MappedFile file(path);
+    file.adviseSequential();
+    return parseFile(file, &pool);
+}
+
+std::vector<int> BulkLoader::loadText(const std::string &path, int threads)
+{
+    MappedFile file(path);
+    file.adviseSequential();
+    if (file.size() < 2 * static_cast<std::size_t>(MIN_CHUNK_BYTES))
+    {
+        return parseFile(file, nullptr);
+    }
+    WorkStealingPool pool(threads);
+    return parseFile(file, &pool);
+}
+
+std::vector<int> BulkLoader::loadBinary(const std::string &path)
+{
+    BinaryFile file(path, false);
+    std::uint64_t bytes = file.size();
+    if (bytes % sizeof(std::int32_t) != 0)
+    {
+        throw std::runtime_error(path + " is not a whole number of 32-bit ints");
+    }
+
+    std::vector<int> arr(static_cast<std::size_t>(bytes / sizeof(std::int32_t)));
+    if (!arr.empty())
+    {
+        file.read(0, arr.data(), arr.size() * sizeof(int));
+    }
+    if (!littleEndian())
+    {
+        swapBytes(arr);
+    }
+    return arr;
+}
+
+std::vector<int> BulkLoader::loadDataset(const std::string &path, const std::string &section)
+{
+    Dataset dataset(path);
+    DatasetArray array = dataset.array(section);
+    return std::vector<int>(array.data, array.data + array.size);
+}
+
+std::vector<int> BulkLoader::load(const std::string &path, int threads)
+{
+    if (endsWith(path, ".bin"))
+    {
+        return loadBinary(path);
+    }
+    if (endsWith(path, ".avds"))
+    {
+        return loadDataset(path);
+    }
+    return loadText(path, threads);
+}
+
+bool BulkLoader::endsWith(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void BulkLoader::saveBinary(const std::string &path, const std::vector<int> &arr)
+{
+    BinaryFile file(path, true);
+    if (arr.empty())
+    {
+        return;
+    }
+    if (littleEndian())
+    {
+        file.write(0, arr.data(), arr.size() * sizeof(int));
+        return;
+    }
+    std::vector<int> swapped = arr;
+    swapBytes(swapped);
+    file.write(0, swapped.data(), swapped.size() * sizeof(int));
+}
@@ -0,0 +1,56 @@
+#ifndef BULK_LOADER_H
+#define BULK_LOADER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+class WorkStealingPool;
+
+/**
+ * Bulk loading of int arrays for AlgoVault
+ *   loadText    - whitespace-separated decimal ints. The file is memory-mapped
+ *                 (mapped_file.h) and cut into chunks at whitespace, one or
+ *                 more per thread; every chunk counts its numbers, a prefix
+ *                 sum over the counts gives each chunk its place in the
+ *                 array, and the chunks then parse straight into it in parallel
+ *   loadBinary  - raw little-endian 32-bit ints (the External Sort format),
+ *                 read in one go with no parsing at all
+ *   loadDataset - copy of an array section of a dataset file (dataset.h)
+ *   load        - loadBinary for .bin files, loadDataset for .avds files,
+ *                 loadText for anything else
+ * Numbers are parsed by hand (an optional sign, then digits), since
+ * std::from_chars needs C++17. Malformed or out-of-range numbers throw
+ * std::runtime_error with their byte offset.
+ */
+
+class BulkLoader
+{
+public:
+    enum
+    {
+        MIN_CHUNK_BYTES = 1 << 20, // smaller files are parsed by a single thread
+        CHUNKS_PER_THREAD = 4      // spare chunks for the faster threads to steal
+    };
+
+    // threads: 0 uses all hardware threads
+    static std::vector<int> loadText(const std::string &path, int threads = 0);
+    static std::vector<int> loadText(const std::string &path, WorkStealingPool &pool);
+    static std::vector<int> loadBinary(const std::string &path);
+    // section: the array's name, empty for the first array in the file
+    static std::vector<int> loadDataset(const std::string &path, const std::string &section = "");
+    static std::vector<int> load(const std::string &path, int threads = 0);
+    // Whether text ends with suffix, e.g. a path with ".avds" (also used by the batch runner)
+    static bool endsWith(const std::string &text, const std::string &suffix);
+
+    // Write arr as a .bin file that loadBinary reads back
+    static void saveBinary(const std::string &path, const std::vector<int> &arr);
+
+    // Whitespace-separated numbers in [begin, end): how many there are, and
+    // parsing them into out (which has room for count() ints). parse returns
+    // the offset of the first bad number from begin, or -1 if all were good
+    static std::size_t count(const char *begin, const char *end);
+    static std::ptrdiff_t parse(const char *begin, const char *end, int *out);
+};
+
+#endif // BULK_LOADER_H
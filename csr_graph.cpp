@@ -0,0 +1,251 @@
+#include "csr_graph.h"
+#include "graph.h"
+#include "dataset.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// ==================== CONSTRUCTION ====================
+
+CsrGraph::CsrGraph(int vertices)
+    : vertexCount(vertices), edgeTotal(0), isWeighted(false), isDirected(false),
+      offsets(static_cast<std::size_t>(vertices) + 1, 0)
+{
+    pointAtStorage();
+}
+
+CsrGraph::CsrGraph(int vertices, const std::vector<GraphEdge> &edges, bool weighted, bool directed)
+    : CsrGraph(CsrGraph(vertices), edges, weighted, directed)
+{
+}
+
+CsrGraph::CsrGraph(const CsrGraph &base, const std::vector<GraphEdge> &edges, bool weighted, bool directed)
+    : vertexCount(base.vertexCount), edgeTotal(0), isWeighted(weighted), isDirected(directed),
+      offsets(static_cast<std::size_t>(base.vertexCount) + 1, 0)
+{
+    // Counting pass: the edges every vertex already has, plus the new ones
+    for (int v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] = base.degree(v);
+    }
+    for (const GraphEdge &edge : edges)
+    {
+        if (edge.u < 0 || edge.u >= vertexCount || edge.v < 0 || edge.v >= vertexCount)
+        {
+            throw std::invalid_argument("edge " + std::to_string(edge.u) + " " + std::to_string(edge.v) +
+                                        " is outside the graph's " + std::to_string(vertexCount) + " vertices");
+        }
+        offsets[edge.u + 1]++;
+        if (!directed)
+            offsets[edge.v + 1]++;
+    }
+    for (int v = 0; v < vertexCount; v++)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+
+    // Each vertex's old edges go first, then the new ones in the order given
+    targets.resize(offsets[vertexCount]);
+    weights.resize(weighted ? targets.size() : 0);
+    std::vector<std::uint64_t> next(vertexCount);
+    for (int v = 0; v < vertexCount; v++)
+    {
+        next[v] = offsets[v];
+        for (std::uint64_t e = base.edgeBegin(v); e < base.edgeEnd(v); e++)
+        {
+            targets[next[v]] = base.targetData[e];
+            if (weighted)
+                weights[next[v]] = base.weight(e);
+            next[v]++;
+        }
+    }
+    for (const GraphEdge &edge : edges)
+    {
+        std::uint64_t slot = next[edge.u]++;
+        targets[slot] = edge.v;
+        if (weighted)
+            weights[slot] = edge.weight;
+        if (!directed)
+        {
+            slot = next[edge.v]++;
+            targets[slot] = edge.u;
+            if (weighted)
+                weights[slot] = edge.weight;
+        }
+    }
+
+    edgeTotal = targets.size();
+    pointAtStorage();
+}
+
+CsrGraph::CsrGraph(const DatasetGraph &graph, bool copy)
+    : vertexCount(graph.vertices), edgeTotal(graph.edges), isWeighted(graph.weights != nullptr),
+      isDirected(graph.directed), offsetData(graph.offsets), targetData(graph.targets), weightData(graph.weights)
+{
+    if (copy)
+    {
+        offsets.assign(graph.offsets, graph.offsets + vertexCount + 1);
+        targets.assign(graph.targets, graph.targets + graph.edges);
+        if (graph.weights)
+            weights.assign(graph.weights, graph.weights + graph.edges);
+        pointAtStorage();
+    }
+}
+
+CsrGraph::CsrGraph(const CsrGraph &other)
+    : vertexCount(other.vertexCount), edgeTotal(other.edgeTotal), isWeighted(other.isWeighted),
+      isDirected(other.isDirected), offsetData(other.offsetData), targetData(other.targetData),
+      weightData(other.weightData), offsets(other.offsets), targets(other.targets), weights(other.weights)
+{
+    if (!offsets.empty())
+    {
+        pointAtStorage();
+    }
+}
+
+CsrGraph &CsrGraph::operator=(const CsrGraph &other)
+{
+    CsrGraph copy(other);
+    *this = std::move(copy);
+    return *this;
+}
+
+void CsrGraph::pointAtStorage()
+{
+    offsetData = offsets.data();
+    targetData = targets.data();
+    weightData = isWeighted ? weights.data() : nullptr;
+}
+
+DatasetGraph CsrGraph::view() const
+{
+    DatasetGraph graph;
+    graph.vertices = vertexCount;
+    graph.edges = edgeTotal;
+    graph.offsets = offsetData;
+    graph.targets = targetData;
+    graph.weights = weightData;
+    graph.directed = isDirected;
+    return graph;
+}
+
+CsrGraph CsrGraph::transposed() const
+{
+    CsrGraph reversed(vertexCount);
+    reversed.isWeighted = isWeighted;
+    reversed.isDirected = isDirected;
+
+    std::vector<std::uint64_t> &counts = reversed.offsets;
+    for (std::uint64_t e = 0; e < edgeTotal; e++)
+    {
+        counts[targetData[e] + 1]++;
+    }
+    for (int v = 0; v < vertexCount; v++)
+    {
+        counts[v + 1] += counts[v];
+    }
+
+    reversed.targets.resize(edgeTotal);
+    reversed.weights.resize(isWeighted ? edgeTotal : 0);
+    std::vector<std::uint64_t> next(counts.begin(), counts.end() - 1);
+    for (int u = 0; u < vertexCount; u++)
+    {
+        for (std::uint64_t e = offsetData[u]; e < offsetData[u + 1]; e++)
+        {
+            std::uint64_t slot = next[targetData[e]]++;
+            reversed.targets[slot] = u;
+            if (isWeighted)
+                reversed.weights[slot] = weightData[e];
+        }
+    }
+
+    reversed.edgeTotal = edgeTotal;
+    reversed.pointAtStorage();
+    return reversed;
+}
+
+// ==================== QUIET ALGORITHMS ====================
+
+std::vector<int> CsrGraph::bfsLevels(int startVertex) const
+{
+    std::vector<int> level(vertexCount, -1);
+    std::vector<int> queue;
+    queue.reserve(vertexCount);
+
+    level[startVertex] = 0;
+    queue.push_back(startVertex);
+    for (std::size_t head = 0; head < queue.size(); head++)
+    {
+        int currentVertex = queue[head];
+        for (int neighbor : neighbors(currentVertex))
+        {
+            if (level[neighbor] < 0)
+            {
+                level[neighbor] = level[currentVertex] + 1;
+                queue.push_back(neighbor);
+            }
+        }
+    }
+    return level;
+}
+
+// Neighbors are pushed in reverse so they are visited left to right, as in Graph::DFS
+std::vector<int> CsrGraph::dfsOrder(int startVertex) const
+{
+    std::vector<bool> visited(vertexCount, false);
+    std::vector<int> order;
+    std::vector<int> stack(1, startVertex);
+
+    while (!stack.empty())
+    {
+        int currentVertex = stack.back();
+        stack.pop_back();
+        if (visited[currentVertex])
+            continue;
+
+        visited[currentVertex] = true;
+        order.push_back(currentVertex);
+        Neighbors range = neighbors(currentVertex);
+        for (const std::int32_t *neighbor = range.end(); neighbor != range.begin();)
+        {
+            --neighbor;
+            if (!visited[*neighbor])
+                stack.push_back(*neighbor);
+        }
+    }
+    return order;
+}
+
+// Distances are 64-bit: a path of many large weights overflows an int
+std::vector<std::uint64_t> CsrGraph::shortestDistances(int startVertex) const
+{
+    typedef std::pair<std::uint64_t, int> Entry; // distance, vertex
+    std::vector<std::uint64_t> dist(vertexCount, std::numeric_limits<std::uint64_t>::max());
+    std::vector<bool> visited(vertexCount, false);
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > pq;
+
+    dist[startVertex] = 0;
+    pq.push(Entry(0, startVertex));
+    while (!pq.empty())
+    {
+        int u = pq.top().second;
+        pq.pop();
+        if (visited[u])
+            continue;
+
+        visited[u] = true;
+        for (std::uint64_t e = edgeBegin(u); e < edgeEnd(u); e++)
+        {
+            int v = targetData[e];
+            std::uint64_t candidate = dist[u] + static_cast<std::uint64_t>(weight(e));
+            if (!visited[v] && candidate < dist[v])
+            {
+                dist[v] = candidate;
+                pq.push(Entry(candidate, v));
+            }
+        }
+    }
+    return dist;
+}
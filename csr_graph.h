@@ -0,0 +1,98 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+struct GraphEdge;
+struct DatasetGraph;
+
+/**
+ * Compressed sparse row (CSR) graph for AlgoVault
+ * The edges of vertex v are targets[offsets[v]] .. targets[offsets[v + 1] - 1],
+ * with weights[] in step, so a vertex's neighbors are one sequential run of
+ * memory: 4 bytes per edge (8 weighted) plus 8 per vertex, where a
+ * std::list adjacency node costs a heap allocation and two pointers.
+ * Immutable once built. An edge list is turned into CSR form with a counting
+ * pass: count every vertex's edges, prefix-sum the counts into offsets, then
+ * drop each edge into the next free slot of its vertex, which keeps each
+ * vertex's edges in the order they were given. A CsrGraph can also refer to
+ * a graph inside a mapped dataset file (dataset.h) without copying it, in
+ * which case the Dataset has to outlive it.
+ */
+
+class CsrGraph
+{
+public:
+    // Neighbors of one vertex, for range-based for loops
+    struct Neighbors
+    {
+        const std::int32_t *first, *last;
+
+        const std::int32_t *begin() const { return first; }
+        const std::int32_t *end() const { return last; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    };
+
+    // vertices with no edges
+    explicit CsrGraph(int vertices = 0);
+    // Each edge is stored both ways unless directed; weights are kept if weighted
+    CsrGraph(int vertices, const std::vector<GraphEdge> &edges, bool weighted, bool directed);
+    // base's edges, then the given ones after them at every vertex
+    CsrGraph(const CsrGraph &base, const std::vector<GraphEdge> &edges, bool weighted, bool directed);
+    // Refers to graph's arrays in place, or owns a copy of them
+    explicit CsrGraph(const DatasetGraph &graph, bool copy = false);
+
+    CsrGraph(const CsrGraph &other);
+    CsrGraph &operator=(const CsrGraph &other);
+    CsrGraph(CsrGraph &&other) = default;
+    CsrGraph &operator=(CsrGraph &&other) = default;
+
+    int size() const { return vertexCount; }
+    std::uint64_t edgeCount() const { return edgeTotal; }
+    bool weighted() const { return isWeighted; }
+    bool directed() const { return isDirected; }
+
+    Neighbors neighbors(int v) const
+    {
+        Neighbors range = {targetData + offsetData[v], targetData + offsetData[v + 1]};
+        return range;
+    }
+    std::size_t degree(int v) const { return static_cast<std::size_t>(offsetData[v + 1] - offsetData[v]); }
+
+    // Edge-index access, for loops that need the weights too
+    std::uint64_t edgeBegin(int v) const { return offsetData[v]; }
+    std::uint64_t edgeEnd(int v) const { return offsetData[v + 1]; }
+    int target(std::uint64_t e) const { return targetData[e]; }
+    int weight(std::uint64_t e) const { return weightData ? weightData[e] : 1; } // 1 when unweighted
+
+    // The arrays in dataset form, e.g. for DatasetWriter::addGraph
+    DatasetGraph view() const;
+
+    // Every edge reversed (the incoming edges of each vertex), by the same counting pass
+    CsrGraph transposed() const;
+
+    // Quiet algorithms: nothing is printed
+    std::vector<int> bfsLevels(int startVertex) const;                  // hops from startVertex, -1 where unreachable
+    std::vector<int> dfsOrder(int startVertex) const;                   // reachable vertices in DFS visiting order
+    std::vector<std::uint64_t> shortestDistances(int startVertex) const; // Dijkstra; UINT64_MAX where unreachable
+
+private:
+    int vertexCount;
+    std::uint64_t edgeTotal;
+    bool isWeighted;
+    bool isDirected;
+    const std::uint64_t *offsetData;
+    const std::int32_t *targetData;
+    const std::int32_t *weightData; // nullptr when unweighted
+
+    // Storage when the graph owns its arrays (empty for a view)
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::int32_t> targets;
+    std::vector<std::int32_t> weights;
+
+    void pointAtStorage();
+};
+
+#endif // CSR_GRAPH_H
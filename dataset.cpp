@@ -0,0 +1,381 @@
+#include "dataset.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+const char DatasetFormat::MAGIC[8] = {'A', 'V', 'D', 'A', 'T', 'A', '\0', '\0'};
+
+static_assert(sizeof(DatasetHeader) == 64, "dataset header must be 64 bytes");
+static_assert(sizeof(DatasetSection) == 96, "dataset section entry must be 96 bytes");
+
+namespace
+{
+    const std::size_t HEADER_CHECKED_BYTES = 48;
+}
+
+// ==================== FORMAT ====================
+
+std::uint64_t DatasetFormat::checksum(const void *data, std::size_t bytes, std::uint64_t hash)
+{
+    const std::uint64_t prime = 1099511628211ULL;
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    std::size_t words = bytes / 4;
+    for (std::size_t i = 0; i < words; i++)
+    {
+        std::uint32_t word;
+        std::memcpy(&word, p + 4 * i, 4);
+        hash = (hash ^ word) * prime;
+    }
+    if (bytes % 4)
+    {
+        std::uint32_t word = 0;
+        std::memcpy(&word, p + 4 * words, bytes % 4);
+        hash = (hash ^ word) * prime;
+    }
+    return hash;
+}
+
+std::uint64_t DatasetFormat::alignUp(std::uint64_t offset)
+{
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+std::uint64_t DatasetFormat::targetsOffset(std::uint64_t vertices)
+{
+    return alignUp((vertices + 1) * sizeof(std::uint64_t));
+}
+
+std::uint64_t DatasetFormat::weightsOffset(std::uint64_t vertices, std::uint64_t edges)
+{
+    return alignUp(targetsOffset(vertices) + edges * sizeof(std::int32_t));
+}
+
+std::uint64_t DatasetFormat::graphBytes(std::uint64_t vertices, std::uint64_t edges, bool weighted)
+{
+    std::uint64_t last = weighted ? weightsOffset(vertices, edges) : targetsOffset(vertices);
+    return last + edges * sizeof(std::int32_t);
+}
+
+std::string DatasetFormat::sectionName(const DatasetSection &section)
+{
+    const char *end = std::find(section.name, section.name + sizeof(section.name), '\0');
+    return std::string(section.name, end);
+}
+
+std::string DatasetFormat::kindName(std::uint32_t kind)
+{
+    switch (kind)
+    {
+    case DATASET_ARRAY:
+        return "array";
+    case DATASET_GRAPH:
+        return "graph";
+    default:
+        return "kind " + std::to_string(kind);
+    }
+}
+
+// ==================== WRITER ====================
+
+DatasetWriter::DatasetWriter(const std::string &path)
+    : file(path, true), end(sizeof(DatasetHeader)), finished(false)
+{
+}
+
+DatasetSection &DatasetWriter::beginSection(const std::string &name, DatasetKind kind, std::uint32_t flags)
+{
+    if (finished)
+    {
+        throw std::runtime_error(file.name() + " is already finished");
+    }
+    if (name.empty() || name.size() > DatasetFormat::MAX_NAME)
+    {
+        throw std::invalid_argument("dataset section names need 1 to 31 characters: " + name);
+    }
+    for (const DatasetSection &section : sections)
+    {
+        if (DatasetFormat::sectionName(section) == name)
+        {
+            throw std::invalid_argument("two dataset sections named " + name);
+        }
+    }
+
+    DatasetSection section;
+    std::memset(&section, 0, sizeof(section));
+    section.kind = kind;
+    section.flags = flags;
+    std::memcpy(section.name, name.data(), name.size());
+    section.offset = DatasetFormat::alignUp(end);
+    section.checksum = DatasetFormat::OFFSET_BASIS;
+    sections.push_back(section);
+    return sections.back();
+}
+
+void DatasetWriter::append(DatasetSection &section, std::uint64_t at, const void *data, std::size_t bytes)
+{
+    // The gap before an aligned part is left as a hole in the file, which
+    // reads back as zeros; it is checksummed as such
+    static const char zeros[DatasetFormat::ALIGNMENT] = {};
+    while (section.bytes < at)
+    {
+        std::size_t gap = static_cast<std::size_t>(std::min<std::uint64_t>(at - section.bytes, sizeof(zeros)));
+        section.checksum = DatasetFormat::checksum(zeros, gap, section.checksum);
+        section.bytes += gap;
+    }
+
+    if (bytes > 0)
+    {
+        file.write(section.offset + at, data, bytes);
+        section.checksum = DatasetFormat::checksum(data, bytes, section.checksum);
+        section.bytes += bytes;
+    }
+    end = section.offset + section.bytes;
+}
+
+void DatasetWriter::addArray(const std::string &name, const int *data, std::size_t size, bool sorted)
+{
+    DatasetSection &section = beginSection(name, DATASET_ARRAY, sorted ? DATASET_SORTED : 0);
+    section.count = size;
+    append(section, 0, data, size * sizeof(int));
+}
+
+void DatasetWriter::addGraph(const std::string &name, const DatasetGraph &graph)
+{
+    if (graph.vertices < 0)
+    {
+        throw std::invalid_argument("negative vertex count for graph " + name);
+    }
+    std::uint32_t flags = (graph.weights ? DATASET_WEIGHTED : 0) | (graph.directed ? DATASET_DIRECTED : 0);
+    DatasetSection &section = beginSection(name, DATASET_GRAPH, flags);
+    section.count = graph.vertices;
+    section.edges = graph.edges;
+
+    std::size_t edgeBytes = static_cast<std::size_t>(graph.edges * sizeof(std::int32_t));
+    append(section, 0, graph.offsets, (static_cast<std::size_t>(graph.vertices) + 1) * sizeof(std::uint64_t));
+    append(section, DatasetFormat::targetsOffset(graph.vertices), graph.targets, edgeBytes);
+    if (graph.weights)
+    {
+        append(section, DatasetFormat::weightsOffset(graph.vertices, graph.edges), graph.weights, edgeBytes);
+    }
+}
+
+void DatasetWriter::finish()
+{
+    if (finished)
+    {
+        return;
+    }
+
+    DatasetHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, DatasetFormat::MAGIC, sizeof(header.magic));
+    header.version = DatasetFormat::VERSION;
+    header.byteOrder = DatasetFormat::BYTE_ORDER_MARK;
+    header.sectionCount = static_cast<std::uint32_t>(sections.size());
+    header.tableOffset = DatasetFormat::alignUp(end);
+
+    std::size_t tableBytes = sections.size() * sizeof(DatasetSection);
+    if (tableBytes > 0)
+    {
+        file.write(header.tableOffset, sections.data(), tableBytes);
+    }
+    header.fileSize = header.tableOffset + tableBytes;
+    header.tableChecksum = DatasetFormat::checksum(sections.data(), tableBytes);
+    header.headerChecksum = DatasetFormat::checksum(&header, HEADER_CHECKED_BYTES);
+    file.write(0, &header, sizeof(header));
+    finished = true;
+}
+
+// ==================== READER ====================
+
+Dataset::Dataset(const std::string &path) : file(path)
+{
+    DatasetHeader header;
+    if (file.size() < sizeof(header))
+    {
+        throw std::runtime_error(path + " is not an AlgoVault dataset");
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, DatasetFormat::MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw std::runtime_error(path + " is not an AlgoVault dataset");
+    }
+    if (header.byteOrder != DatasetFormat::BYTE_ORDER_MARK)
+    {
+        throw std::runtime_error(path + " was written with the other byte order");
+    }
+    if (header.version != DatasetFormat::VERSION)
+    {
+        throw std::runtime_error(path + " has unsupported dataset version " + std::to_string(header.version));
+    }
+    if (DatasetFormat::checksum(&header, HEADER_CHECKED_BYTES) != header.headerChecksum)
+    {
+        throw std::runtime_error(path + ": damaged header");
+    }
+
+    std::uint64_t size = file.size();
+    if (header.fileSize != size)
+    {
+        throw std::runtime_error(path + " is " + std::to_string(size) + " bytes, the header says " +
+                                 std::to_string(header.fileSize) + " (truncated or appended to?)");
+    }
+    if (header.tableOffset > size || (size - header.tableOffset) / sizeof(DatasetSection) < header.sectionCount)
+    {
+        throw std::runtime_error(path + ": section table is outside the file");
+    }
+    const char *tableData = file.data() + header.tableOffset;
+    std::size_t tableBytes = header.sectionCount * sizeof(DatasetSection);
+    if (DatasetFormat::checksum(tableData, tableBytes) != header.tableChecksum)
+    {
+        throw std::runtime_error(path + ": damaged section table");
+    }
+    table.resize(header.sectionCount);
+    if (tableBytes > 0)
+    {
+        std::memcpy(table.data(), tableData, tableBytes);
+    }
+
+    // Every section has to fit the file and agree with its own sizes, so the
+    // pointers handed out below never leave the mapping
+    for (const DatasetSection &section : table)
+    {
+        std::string where = path + ": section " + DatasetFormat::sectionName(section);
+        if (section.offset % DatasetFormat::ALIGNMENT != 0 || section.offset > header.tableOffset ||
+            section.bytes > header.tableOffset - section.offset)
+        {
+            throw std::runtime_error(where + " is outside the data");
+        }
+
+        bool fits;
+        if (section.kind == DATASET_ARRAY)
+        {
+            fits = section.count <= section.bytes / sizeof(std::int32_t) &&
+                   section.count * sizeof(std::int32_t) == section.bytes;
+        }
+        else if (section.kind == DATASET_GRAPH)
+        {
+            fits = section.count < static_cast<std::uint64_t>(std::numeric_limits<int>::max()) &&
+                   section.edges <= section.bytes / sizeof(std::int32_t) &&
+                   DatasetFormat::graphBytes(section.count, section.edges, (section.flags & DATASET_WEIGHTED) != 0) ==
+                       section.bytes;
+        }
+        else
+        {
+            throw std::runtime_error(where + " has unknown " + DatasetFormat::kindName(section.kind));
+        }
+        if (!fits)
+        {
+            throw std::runtime_error(where + ": sizes do not match its data");
+        }
+    }
+}
+
+const DatasetSection &Dataset::find(DatasetKind kind, const std::string &name) const
+{
+    for (const DatasetSection &section : table)
+    {
+        if (name.empty() ? section.kind == static_cast<std::uint32_t>(kind) : DatasetFormat::sectionName(section) == name)
+        {
+            if (section.kind != static_cast<std::uint32_t>(kind))
+            {
+                throw std::runtime_error(file.name() + ": " + name + " is not " +
+                                         (kind == DATASET_ARRAY ? "an array" : "a graph"));
+            }
+            return section;
+        }
+    }
+    throw std::runtime_error(file.name() + " has no " + DatasetFormat::kindName(kind) +
+                             (name.empty() ? "" : " named " + name));
+}
+
+DatasetArray Dataset::array(const std::string &name) const
+{
+    return array(find(DATASET_ARRAY, name));
+}
+
+DatasetGraph Dataset::graph(const std::string &name) const
+{
+    return graph(find(DATASET_GRAPH, name));
+}
+
+DatasetArray Dataset::array(const DatasetSection &section) const
+{
+    DatasetArray array;
+    array.data = reinterpret_cast<const std::int32_t *>(file.data() + section.offset);
+    array.size = static_cast<std::size_t>(section.count);
+    array.sorted = (section.flags & DATASET_SORTED) != 0;
+    return array;
+}
+
+DatasetGraph Dataset::graph(const DatasetSection &section) const
+{
+    const char *base = file.data() + section.offset;
+    DatasetGraph graph;
+    graph.vertices = static_cast<int>(section.count);
+    graph.edges = section.edges;
+    graph.offsets = reinterpret_cast<const std::uint64_t *>(base);
+    graph.targets = reinterpret_cast<const std::int32_t *>(base + DatasetFormat::targetsOffset(section.count));
+    graph.weights = nullptr;
+    if (section.flags & DATASET_WEIGHTED)
+    {
+        graph.weights =
+            reinterpret_cast<const std::int32_t *>(base + DatasetFormat::weightsOffset(section.count, section.edges));
+    }
+    graph.directed = (section.flags & DATASET_DIRECTED) != 0;
+    return graph;
+}
+
+void Dataset::verify() const
+{
+    for (const DatasetSection &section : table)
+    {
+        std::string where = file.name() + ": section " + DatasetFormat::sectionName(section);
+        if (DatasetFormat::checksum(file.data() + section.offset, static_cast<std::size_t>(section.bytes)) !=
+            section.checksum)
+        {
+            throw std::runtime_error(where + " is damaged (checksum mismatch)");
+        }
+
+        if (section.kind == DATASET_ARRAY)
+        {
+            DatasetArray a = array(section);
+            if (a.sorted && !std::is_sorted(a.data, a.data + a.size))
+            {
+                throw std::runtime_error(where + " is flagged sorted but is not");
+            }
+            continue;
+        }
+
+        checkGraph(section);
+    }
+}
+
+void Dataset::checkGraph(const std::string &name) const
+{
+    checkGraph(find(DATASET_GRAPH, name));
+}
+
+void Dataset::checkGraph(const DatasetSection &section) const
+{
+    std::string where = file.name() + ": section " + DatasetFormat::sectionName(section);
+    DatasetGraph g = graph(section);
+    if (g.offsets[0] != 0 || g.offsets[g.vertices] != g.edges)
+    {
+        throw std::runtime_error(where + ": edge offsets do not span the edges");
+    }
+    for (int v = 0; v < g.vertices; v++)
+    {
+        if (g.offsets[v] > g.offsets[v + 1])
+        {
+            throw std::runtime_error(where + ": edge offsets of vertex " + std::to_string(v) + " go backwards");
+        }
+    }
+    for (std::uint64_t e = 0; e < g.edges; e++)
+    {
+        if (g.targets[e] < 0 || g.targets[e] >= g.vertices)
+        {
+            throw std::runtime_error(where + ": edge " + std::to_string(e) + " leads outside the graph");
+        }
+    }
+}
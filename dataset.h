@@ -0,0 +1,184 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+#include "external_sort.h"
+
+/**
+ * Dataset files (.avds) for AlgoVault
+ * One file holds any number of named int arrays and graphs, ready to use
+ * without parsing:
+ *   header   - 64 bytes: magic, version, byte order mark, section count,
+ *              where the section table is, file size and checksums
+ *   data     - every array of every section starts on a 64-byte boundary
+ *   sections - table at the end of the file, one 96-byte entry per
+ *              section: kind, flags, name, sizes, data offset and checksum
+ * Graphs are stored in offset/edge-array form: the edges of vertex v are
+ * targets[offsets[v]] .. targets[offsets[v + 1] - 1], with weights[] in
+ * step when the graph is weighted (the CsrGraph layout, csr_graph.h). An
+ * undirected graph holds every edge in both directions.
+ *   DatasetWriter - streams sections to a new file; the table and header
+ *                   are written by finish()
+ *   Dataset       - maps a file (MappedFile) and hands out pointers into
+ *                   the mapping, so opening costs the same for 1 KB and
+ *                   10 GB. Only the header and section table are checked
+ *                   on open; verify() also checksums and bounds-checks
+ *                   the data, reading all of it, and checkGraph() only
+ *                   bounds-checks one graph.
+ * Files are in native byte order (like trace files); opening one written
+ * with the other byte order throws. Errors throw std::runtime_error.
+ */
+
+enum DatasetKind
+{
+    DATASET_ARRAY = 1, // count: elements; data: int32[count]
+    DATASET_GRAPH = 2  // count: vertices, edges: stored edges;
+                       // data: uint64 offsets[count + 1], int32 targets[edges], int32 weights[edges]
+};
+
+enum DatasetFlag
+{
+    DATASET_SORTED = 1,   // array: in ascending order
+    DATASET_WEIGHTED = 2, // graph: has weights[]
+    DATASET_DIRECTED = 4  // graph: edges stored one way only
+};
+
+// Header at offset 0, 64 bytes
+struct DatasetHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder; // BYTE_ORDER_MARK as written
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    std::uint64_t tableOffset;
+    std::uint64_t fileSize;
+    std::uint64_t tableChecksum;
+    std::uint64_t headerChecksum; // of the 48 bytes above
+    std::uint64_t padding;
+};
+
+// Section table entry, 96 bytes
+struct DatasetSection
+{
+    std::uint32_t kind;  // DatasetKind
+    std::uint32_t flags; // DatasetFlag bits
+    char name[32];       // zero-padded, at most 31 characters
+    std::uint64_t count;
+    std::uint64_t edges;
+    std::uint64_t offset; // of the data, a multiple of ALIGNMENT
+    std::uint64_t bytes;
+    std::uint64_t checksum; // of the data bytes
+    std::uint64_t reserved[2];
+};
+
+// An array section in place in the mapping
+struct DatasetArray
+{
+    const std::int32_t *data;
+    std::size_t size;
+    bool sorted;
+};
+
+// A graph section in place in the mapping
+struct DatasetGraph
+{
+    int vertices;
+    std::uint64_t edges;
+    const std::uint64_t *offsets;
+    const std::int32_t *targets;
+    const std::int32_t *weights; // nullptr when unweighted
+    bool directed;
+};
+
+class DatasetFormat
+{
+public:
+    enum
+    {
+        VERSION = 1,
+        ALIGNMENT = 64,
+        MAX_NAME = 31
+    };
+
+    static const char MAGIC[8];
+    static const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    static const std::uint64_t OFFSET_BASIS = 14695981039346656037ULL;
+
+    // 64-bit FNV-1a over 32-bit words (a last partial word is zero-padded),
+    // continuing from hash: data checksummed in parts of whole words gives
+    // the same result as all at once
+    static std::uint64_t checksum(const void *data, std::size_t bytes, std::uint64_t hash = OFFSET_BASIS);
+
+    // Byte layout of a graph section's data: where targets[] and weights[] start
+    static std::uint64_t alignUp(std::uint64_t offset);
+    static std::uint64_t targetsOffset(std::uint64_t vertices);
+    static std::uint64_t weightsOffset(std::uint64_t vertices, std::uint64_t edges);
+    static std::uint64_t graphBytes(std::uint64_t vertices, std::uint64_t edges, bool weighted);
+
+    static std::string sectionName(const DatasetSection &section);
+    static std::string kindName(std::uint32_t kind);
+};
+
+class DatasetWriter
+{
+public:
+    // Create (or truncate) the dataset file at path
+    explicit DatasetWriter(const std::string &path);
+
+    void addArray(const std::string &name, const int *data, std::size_t size, bool sorted);
+    // A CsrGraph (csr_graph.h) gives the arrays for an edge list: CsrGraph(...).view()
+    void addGraph(const std::string &name, const DatasetGraph &graph);
+
+    // Write the section table and header; the file is unreadable until then
+    void finish();
+
+private:
+    BinaryFile file;
+    std::uint64_t end;
+    std::vector<DatasetSection> sections;
+    bool finished;
+
+    DatasetSection &beginSection(const std::string &name, DatasetKind kind, std::uint32_t flags);
+    // Write at section.offset + at, updating the checksum (parts must be written in order)
+    void append(DatasetSection &section, std::uint64_t at, const void *data, std::size_t bytes);
+};
+
+class Dataset
+{
+public:
+    explicit Dataset(const std::string &path);
+
+    const std::vector<DatasetSection> &sections() const { return table; }
+    const std::string &name() const { return file.name(); }
+    std::size_t fileSize() const { return file.size(); }
+
+    // The section called name, or the first of that kind when name is empty; throws if there is none
+    const DatasetSection &find(DatasetKind kind, const std::string &name = "") const;
+    DatasetArray array(const std::string &name = "") const;
+    DatasetGraph graph(const std::string &name = "") const;
+    DatasetArray array(const DatasetSection &section) const;
+    DatasetGraph graph(const DatasetSection &section) const;
+
+    // Checksum every section and check that graphs are well formed; throws on the first problem
+    void verify() const;
+    // Only the structure of one graph, without checksums: offsets start at 0, never go
+    // backwards and end at the edge count, and every target is a vertex. One pass over
+    // offsets and targets; needed before a graph from an untrusted file is traversed
+    void checkGraph(const std::string &name = "") const;
+    void checkGraph(const DatasetSection &section) const;
+
+private:
+    MappedFile file;
+    std::vector<DatasetSection> table;
+
+    Dataset(const Dataset &);
+    Dataset &operator=(const Dataset &);
+};
+
+#endif // DATASET_H
@@ -0,0 +1,227 @@
+#include "dataset.h"
+#include "bulk_loader.h"
+#include "graph.h"
+#include "csr_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+/**
+ * Dataset tool (make dataset)
+ *   AlgoVaultData pack OUT.avds [--array NAME FILE] [--sorted NAME FILE]
+ *                               [--graph NAME FILE] [--rmat NAME SCALE]
+ *                               [--directed] [--unweighted]
+ *   AlgoVaultData info FILE.avds
+ *   AlgoVaultData verify FILE.avds
+ * pack converts int files (text or .bin, via BulkLoader) and edge lists
+ * into one dataset file; info lists its sections and verify checksums
+ * them. --rmat generates a scale-free test graph instead (Graph500 R-MAT:
+ * 2^SCALE vertices, 16 edges each, a few hubs and a small diameter).
+ * See dataset.h for the format.
+ */
+
+namespace
+{
+    void printUsage(std::ostream &out)
+    {
+        out << "Usage: AlgoVaultData pack OUT.avds ITEM...\n"
+               "       AlgoVaultData info FILE.avds\n"
+               "       AlgoVaultData verify FILE.avds\n"
+               "Items of pack, stored in the order given:\n"
+               "  --array NAME FILE   ints from a text file, or raw 32-bit ints in a .bin file\n"
+               "  --sorted NAME FILE  the same, sorted first and flagged as sorted\n"
+               "  --graph NAME FILE   edge list, \"u v [weight]\" per line\n"
+               "  --rmat NAME SCALE   generated R-MAT graph, 2^SCALE vertices and 16x as many edges\n"
+               "  --directed          store the graphs after this one way only\n"
+               "  --unweighted        store the graphs after this without weights\n";
+    }
+
+    double millisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Graph500 R-MAT: each edge picks one quadrant of the adjacency matrix per
+    // bit of the vertex ids, with probabilities A, B, C and the rest; vertex ids
+    // are then shuffled so the hubs are not all at low numbers
+    std::vector<GraphEdge> rmatEdges(int scale, int &vertices)
+    {
+        const double A = 0.57, B = 0.19, C = 0.19;
+        const int EDGE_FACTOR = 16;
+        if (scale < 1 || scale > 26)
+        {
+            throw std::invalid_argument("R-MAT scale must be 1 to 26");
+        }
+        vertices = 1 << scale;
+
+        std::mt19937_64 rng(42);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::uniform_int_distribution<int> weight(1, 255);
+        std::vector<int> label(vertices);
+        std::iota(label.begin(), label.end(), 0);
+        std::shuffle(label.begin(), label.end(), rng);
+
+        std::vector<GraphEdge> edges(static_cast<std::size_t>(vertices) * EDGE_FACTOR);
+        for (GraphEdge &edge : edges)
+        {
+            int u = 0, v = 0;
+            for (int bit = 0; bit < scale; bit++)
+            {
+                double r = unit(rng);
+                if (r >= A + B + C)
+                {
+                    u |= 1 << bit;
+                    v |= 1 << bit;
+                }
+                else if (r >= A + B)
+                {
+                    u |= 1 << bit;
+                }
+                else if (r >= A)
+                {
+                    v |= 1 << bit;
+                }
+            }
+            edge.u = label[u];
+            edge.v = label[v];
+            edge.weight = weight(rng);
+        }
+        return edges;
+    }
+
+    void pack(const std::string &path, const std::vector<std::string> &items)
+    {
+        DatasetWriter writer(path);
+        bool directed = false, weighted = true;
+        for (std::size_t i = 0; i < items.size(); i++)
+        {
+            const std::string &item = items[i];
+            if (item == "--directed")
+            {
+                directed = true;
+                continue;
+            }
+            if (item == "--unweighted")
+            {
+                weighted = false;
+                continue;
+            }
+            if (item != "--array" && item != "--sorted" && item != "--graph" && item != "--rmat")
+            {
+                throw std::invalid_argument("unknown option " + item);
+            }
+            if (i + 2 >= items.size())
+            {
+                throw std::invalid_argument(item + " needs a NAME and a " + (item == "--rmat" ? "SCALE" : "FILE"));
+            }
+            const std::string &name = items[++i];
+            const std::string &file = items[++i];
+
+            if (item == "--graph" || item == "--rmat")
+            {
+                int vertices = 0;
+                std::vector<GraphEdge> edges = item == "--rmat" ? rmatEdges(std::atoi(file.c_str()), vertices)
+                                                                : Graph::readEdgeList(file, vertices);
+                writer.addGraph(name, CsrGraph(vertices, edges, weighted, directed).view());
+                std::cout << name << ": graph of " << vertices << " vertices and " << edges.size() << " edges from "
+                          << (item == "--rmat" ? "R-MAT scale " : "") << file << "\n";
+            }
+            else
+            {
+                std::vector<int> arr = BulkLoader::load(file);
+                bool sorted = item == "--sorted";
+                if (sorted)
+                {
+                    std::sort(arr.begin(), arr.end());
+                }
+                writer.addArray(name, arr.data(), arr.size(), sorted);
+                std::cout << name << ": " << arr.size() << (sorted ? " sorted" : "") << " ints from " << file << "\n";
+            }
+        }
+        writer.finish();
+    }
+
+    void info(const std::string &path)
+    {
+        auto start = std::chrono::steady_clock::now();
+        Dataset dataset(path);
+        double openMs = millisecondsSince(start);
+
+        std::cout << path << ": " << dataset.fileSize() << " bytes, " << dataset.sections().size()
+                  << " sections, opened in " << std::fixed << std::setprecision(3) << openMs << " ms\n";
+        for (const DatasetSection &section : dataset.sections())
+        {
+            std::cout << "  " << std::left << std::setw(32) << DatasetFormat::sectionName(section) << std::setw(6)
+                      << DatasetFormat::kindName(section.kind) << std::right;
+            if (section.kind == DATASET_GRAPH)
+            {
+                std::cout << section.count << " vertices, " << section.edges << " edges"
+                          << (section.flags & DATASET_WEIGHTED ? ", weighted" : "")
+                          << (section.flags & DATASET_DIRECTED ? ", directed" : "");
+            }
+            else
+            {
+                std::cout << section.count << " ints" << (section.flags & DATASET_SORTED ? ", sorted" : "");
+            }
+            std::cout << "  (" << section.bytes << " bytes at " << section.offset << ")\n";
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        std::vector<std::string> args(argv + 1, argv + argc);
+        if (!args.empty() && (args[0] == "--help" || args[0] == "-h"))
+        {
+            printUsage(std::cout);
+            return 0;
+        }
+        if (args.size() < 2)
+        {
+            throw std::invalid_argument("expected a command and a dataset file");
+        }
+
+        const std::string &command = args[0];
+        const std::string &path = args[1];
+        if (command == "pack")
+        {
+            pack(path, std::vector<std::string>(args.begin() + 2, args.end()));
+        }
+        else if (command == "info" && args.size() == 2)
+        {
+            info(path);
+        }
+        else if (command == "verify" && args.size() == 2)
+        {
+            auto start = std::chrono::steady_clock::now();
+            Dataset dataset(path);
+            dataset.verify();
+            std::cout << path << ": " << dataset.sections().size() << " sections OK (" << std::fixed
+                      << std::setprecision(1) << millisecondsSince(start) << " ms)\n";
+        }
+        else
+        {
+            throw std::invalid_argument("unknown command " + command);
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "external_sort.h"
+
+// 64-bit file offsets on every platform
+#ifdef _WIN32
+#define ALGOVAULT_FSEEK _fseeki64
+#define ALGOVAULT_FTELL _ftelli64
+#else
+#define ALGOVAULT_FSEEK fseeko
+#define ALGOVAULT_FTELL ftello
+#endif
+
+// ==================== BINARY FILE ====================
+
+BinaryFile::BinaryFile(const std::string &path, bool writable)
+    : file(std::fopen(path.c_str(), writable ? "w+b" : "rb")), path(path)
+{
+    if (!file)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    // Transfers are large and go straight to our own buffers
+    std::setvbuf(file, nullptr, _IONBF, 0);
+}
+
+BinaryFile::~BinaryFile()
+{
+    std::fclose(file);
+}
+
+void BinaryFile::seek(std::uint64_t offset)
+{
+    if (ALGOVAULT_FSEEK(file, offset, SEEK_SET) != 0)
+    {
+        throw std::runtime_error("cannot seek in " + path);
+    }
+}
+
+std::uint64_t BinaryFile::size()
+{
+    if (ALGOVAULT_FSEEK(file, 0, SEEK_END) != 0)
+    {
+        throw std::runtime_error("cannot seek in " + path);
+    }
+    return static_cast<std::uint64_t>(ALGOVAULT_FTELL(file));
+}
+
+void BinaryFile::read(std::uint64_t offset, void *data, std::size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return; // data may be null (an empty vector's data())
+    }
+
+    seek(offset);
+    if (std::fread(data, 1, bytes, file) != bytes)
+    {
+        throw std::runtime_error("short read from " + path);
+    }
+}
+
+void BinaryFile::write(std::uint64_t offset, const void *data, std::size_t bytes)
+{
+    if (bytes == 0)
+    {
+        return; // data may be null (an empty vector's data())
+    }
+
+    seek(offset);
+    if (std::fwrite(data, 1, bytes, file) != bytes)
+    {
+        throw std::runtime_error("cannot write to " + path);
+    }
+}
+
+// ==================== I/O THREAD ====================
+
+IoThread::IoThread() : stopping(false)
+{
+    worker = std::thread(&IoThread::loop, this);
+}
+
+IoThread::~IoThread()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+std::future<void> IoThread::submit(const std::function<void()> &job)
+{
+    std::packaged_task<void()> task(job);
+    std::future<void> done = task.get_future();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(std::move(task));
+    }
+    wake.notify_one();
+    return done;
+}
+
+void IoThread::loop()
+{
+    while (true)
+    {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+            {
+                return;
+            }
+            task = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        task();
+    }
+}
+
+// ==================== EXTERNAL SORT ====================
+
+std::string ExternalSort::tempPath(const ExternalSortOptions &options, const std::string &output, int pass)
+{
+    std::string base = output;
+    if (!options.tempDirectory.empty())
+    {
+        std::size_t slash = output.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? output : output.substr(slash + 1);
+        base = options.tempDirectory + "/" + name;
+    }
+    return base + ".run" + std::to_string(pass);
+}
@@ -0,0 +1,578 @@
+#ifndef EXTERNAL_SORT_H
+#define EXTERNAL_SORT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include "sort_engine.h"
+
+/**
+ * External-memory sorting for AlgoVault
+ * Sorts a binary file of fixed-size records (raw ints, or any trivially
+ * copyable struct) that can be far larger than RAM, within a memory budget:
+ *   1. Run formation - the input is read in large sequential chunks, each
+ *      chunk is sorted in memory by SortEngine::sort and written out as a
+ *      run; reading the next chunk and writing the previous run overlap the
+ *      sort of the current one (three chunk buffers in rotation)
+ *   2. Merging - the runs are k-way merged through a loser tree. Every run
+ *      is read through two alternating buffers, so its next block is fetched
+ *      while the current one is merged, and the output is written the same
+ *      way. If the budget cannot give every run a block of at least
+ *      minBlockSize bytes, runs are merged in several passes.
+ * All disk transfers run on one background IoThread, in submission order.
+ * Errors (missing file, short read, full disk) throw std::runtime_error.
+ */
+
+struct ExternalSortOptions
+{
+    std::size_t memoryBudget;  // bytes for all buffers, the in-memory sort's scratch included
+    std::size_t minBlockSize;  // smallest read per run while merging; limits the merge fan-in
+    std::string tempDirectory; // where run files go; empty puts them next to the output
+
+    ExternalSortOptions() : memoryBudget(std::size_t(256) << 20), minBlockSize(std::size_t(1) << 20) {}
+};
+
+struct ExternalSortStats
+{
+    std::uint64_t elements; // records sorted
+    std::uint64_t runs;     // sorted runs written by run formation
+    int mergePasses;        // passes over the data after run formation
+
+    ExternalSortStats() : elements(0), runs(0), mergePasses(0) {}
+};
+
+// Binary file read and written at explicit byte offsets
+class BinaryFile
+{
+public:
+    // writable: create (or truncate) the file for reading and writing
+    BinaryFile(const std::string &path, bool writable);
+    ~BinaryFile();
+
+    std::uint64_t size();
+    // Transfers of zero bytes do nothing
+    void read(std::uint64_t offset, void *data, std::size_t bytes);
+    void write(std::uint64_t offset, const void *data, std::size_t bytes);
+
+    const std::string &name() const { return path; }
+
+private:
+    std::FILE *file;
+    std::string path;
+
+    BinaryFile(const BinaryFile &);
+    BinaryFile &operator=(const BinaryFile &);
+
+    void seek(std::uint64_t offset);
+};
+
+// Background thread that runs I/O jobs one at a time in submission order;
+// the returned future rethrows anything the job threw
+class IoThread
+{
+public:
+    IoThread();
+    ~IoThread();
+
+    std::future<void> submit(const std::function<void()> &job);
+
+private:
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::deque<std::packaged_task<void()> > jobs;
+    bool stopping;
+
+    IoThread(const IoThread &);
+    IoThread &operator=(const IoThread &);
+
+    void loop();
+};
+
+// Tournament tree of losers over k sequences: every internal node keeps the
+// sequence that lost the match played there, tree[0] the overall winner.
+// Replacing the winner's key replays only the matches on its leaf-to-root
+// path, one comparison per level, with no data-dependent choice of child.
+// Ties go to the lower sequence index, so merging runs in order is stable.
+template <typename T, typename Compare>
+class LoserTree
+{
+public:
+    LoserTree(int k, Compare &comp) : k(k), comp(comp), keys(k), live(k, false), tree(std::max(k, 1), 0) {}
+
+    // Set the first key of sequence i (sequences without one start exhausted)
+    void set(int i, const T &key)
+    {
+        keys[i] = key;
+        live[i] = true;
+    }
+
+    // Play all matches; call once after set()
+    void build()
+    {
+        std::vector<int> winners(2 * k);
+        for (int i = 0; i < k; i++)
+            winners[k + i] = i;
+        for (int node = k - 1; node > 0; node--)
+        {
+            int a = winners[2 * node];
+            int b = winners[2 * node + 1];
+            bool aWins = beats(a, b);
+            winners[node] = aWins ? a : b;
+            tree[node] = aWins ? b : a;
+        }
+        tree[0] = k > 1 ? winners[1] : 0;
+    }
+
+    bool empty() const { return !live[tree[0]]; }
+    int top() const { return tree[0]; }
+    const T &topKey() const { return keys[tree[0]]; }
+
+    // The winning sequence moved on to key
+    void replaceTop(const T &key)
+    {
+        keys[tree[0]] = key;
+        replay(tree[0]);
+    }
+
+    // The winning sequence ran out
+    void removeTop()
+    {
+        live[tree[0]] = false;
+        replay(tree[0]);
+    }
+
+private:
+    int k;
+    Compare &comp;
+    std::vector<T> keys;
+    std::vector<char> live;
+    std::vector<int> tree;
+
+    bool beats(int a, int b) const
+    {
+        if (!live[a] || !live[b])
+            return live[a] && !live[b];
+        if (comp(keys[a], keys[b]))
+            return true;
+        return !comp(keys[b], keys[a]) && a < b;
+    }
+
+    void replay(int leaf)
+    {
+        int winner = leaf;
+        for (int node = (leaf + k) >> 1; node > 0; node >>= 1)
+        {
+            if (beats(tree[node], winner))
+                std::swap(tree[node], winner);
+        }
+        tree[0] = winner;
+    }
+};
+
+class ExternalSort
+{
+public:
+    // Sort the records of type T in input by comp(proj(a), proj(b)) and write
+    // them to output, which must be a different file
+    template <typename T, typename Compare = SortLess, typename Projection = SortIdentity>
+    static ExternalSortStats sortFile(const std::string &input, const std::string &output,
+                                      const ExternalSortOptions &options = ExternalSortOptions(),
+                                      Compare comp = Compare(), Projection proj = Projection());
+
+private:
+    // A sorted run: a range of records in a run file
+    struct Run
+    {
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    template <typename T>
+    class RunReader;
+    template <typename T>
+    class RunWriter;
+
+    static std::string tempPath(const ExternalSortOptions &options, const std::string &output, int pass);
+
+    template <typename T, typename Compare, typename Projection>
+    static std::vector<Run> formRuns(BinaryFile &in, std::uint64_t total, BinaryFile &out,
+                                     std::size_t runLength, IoThread &io, Compare &comp, Projection &proj);
+    template <typename T>
+    static std::future<void> submitRead(IoThread &io, BinaryFile &in, const Run &run, std::vector<T> &chunk);
+    template <typename T, typename Less>
+    static void mergeRuns(BinaryFile &in, const Run *runs, int count, BinaryFile &out,
+                          std::uint64_t outOffset, std::size_t blockLength, IoThread &io, Less &less);
+};
+
+// ==================== RUN READER / WRITER ====================
+
+// Reads one run through two buffers: while the records of one are being
+// consumed, the I/O thread fills the other with the next block
+template <typename T>
+class ExternalSort::RunReader
+{
+public:
+    RunReader(BinaryFile &file, const Run &run, std::size_t blockLength, IoThread &io)
+        : file(file), io(io), next(run.offset), remaining(run.length), current(0), pos(0)
+    {
+        for (int b = 0; b < 2; b++)
+        {
+            buffers[b].resize(static_cast<std::size_t>(std::min<std::uint64_t>(blockLength, run.length)));
+            sizes[b] = 0;
+        }
+        fetch(0);
+        fetch(1);
+        wait(0);
+    }
+
+    ~RunReader()
+    {
+        // The I/O thread may still be writing into a buffer
+        for (int b = 0; b < 2; b++)
+        {
+            if (pending[b].valid())
+                pending[b].wait();
+        }
+    }
+
+    bool empty() const { return pos == sizes[current]; }
+    const T &value() const { return buffers[current][pos]; }
+
+    void advance()
+    {
+        if (++pos < sizes[current])
+            return;
+
+        // Buffer used up: refill it in the background and switch to the other one
+        fetch(current);
+        current ^= 1;
+        pos = 0;
+        wait(current);
+    }
+
+private:
+    BinaryFile &file;
+    IoThread &io;
+    std::uint64_t next;      // first record not yet requested
+    std::uint64_t remaining; // records not yet requested
+    std::vector<T> buffers[2];
+    std::size_t sizes[2];
+    std::future<void> pending[2];
+    int current;
+    std::size_t pos;
+
+    void fetch(int b)
+    {
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(buffers[b].size(), remaining));
+        sizes[b] = count;
+        if (count == 0)
+            return;
+
+        BinaryFile *source = &file;
+        T *data = buffers[b].data();
+        std::uint64_t offset = next * sizeof(T);
+        pending[b] = io.submit([source, offset, data, count]()
+                               { source->read(offset, data, count * sizeof(T)); });
+        next += count;
+        remaining -= count;
+    }
+
+    void wait(int b)
+    {
+        if (pending[b].valid())
+            pending[b].get();
+    }
+};
+
+// Appends records to a file through two buffers, writing one in the
+// background while the other fills
+template <typename T>
+class ExternalSort::RunWriter
+{
+public:
+    RunWriter(BinaryFile &file, std::uint64_t offset, std::size_t blockLength, IoThread &io)
+        : file(file), io(io), next(offset), current(0), pos(0)
+    {
+        buffers[0].resize(blockLength);
+        buffers[1].resize(blockLength);
+    }
+
+    ~RunWriter()
+    {
+        for (int b = 0; b < 2; b++)
+        {
+            if (pending[b].valid())
+                pending[b].wait();
+        }
+    }
+
+    void push(const T &value)
+    {
+        buffers[current][pos++] = value;
+        if (pos == buffers[current].size())
+            flush();
+    }
+
+    // Write out what is buffered and wait for all writes to finish
+    void finish()
+    {
+        flush();
+        for (int b = 0; b < 2; b++)
+        {
+            if (pending[b].valid())
+                pending[b].get();
+        }
+    }
+
+private:
+    BinaryFile &file;
+    IoThread &io;
+    std::uint64_t next; // record offset of the next write
+    std::vector<T> buffers[2];
+    std::future<void> pending[2];
+    int current;
+    std::size_t pos;
+
+    void flush()
+    {
+        if (pos == 0)
+            return;
+
+        BinaryFile *target = &file;
+        const T *data = buffers[current].data();
+        std::uint64_t offset = next * sizeof(T);
+        std::size_t count = pos;
+        pending[current] = io.submit([target, offset, data, count]()
+                                     { target->write(offset, data, count * sizeof(T)); });
+        next += count;
+
+        current ^= 1;
+        pos = 0;
+        if (pending[current].valid())
+            pending[current].get();
+    }
+};
+
+// ==================== EXTERNAL SORT ====================
+
+template <typename T, typename Compare, typename Projection>
+ExternalSortStats ExternalSort::sortFile(const std::string &input, const std::string &output,
+                                         const ExternalSortOptions &options, Compare comp, Projection proj)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "records are read and written as raw bytes");
+
+    BinaryFile in(input, false);
+    std::uint64_t bytes = in.size();
+    if (bytes % sizeof(T) != 0)
+        throw std::runtime_error(input + ": size is not a multiple of the record size");
+
+    ExternalSortStats stats;
+    stats.elements = bytes / sizeof(T);
+    if (stats.elements == 0)
+    {
+        // Nothing to read or sort: just create the empty output
+        BinaryFile out(output, true);
+        return stats;
+    }
+
+    // Three chunks rotate between reading, sorting and writing, and the
+    // in-memory sort may need up to one more chunk of scratch (radix sort)
+    std::size_t runLength = std::max<std::size_t>(options.memoryBudget / (4 * sizeof(T)), 1);
+    if (stats.elements <= runLength)
+    {
+        // Fits in memory: no runs, no merge
+        std::vector<T> data(static_cast<std::size_t>(stats.elements));
+        in.read(0, data.data(), data.size() * sizeof(T));
+        SortEngine::sort(data.begin(), data.end(), comp, proj);
+        BinaryFile out(output, true);
+        out.write(0, data.data(), data.size() * sizeof(T));
+        stats.runs = 1;
+        return stats;
+    }
+
+    IoThread io;
+    typename SortComparator<Compare, Projection>::Type less = SortComparator<Compare, Projection>::make(comp, proj);
+
+    // Each merge input and the output get two blocks of at least minBlockSize
+    std::size_t blockBytes = std::max<std::size_t>(options.minBlockSize, sizeof(T));
+    std::size_t maxFanIn = std::max<std::size_t>(options.memoryBudget / (2 * blockBytes), 3) - 1;
+
+    std::string runPath = tempPath(options, output, 0);
+    std::string nextPath;
+    std::unique_ptr<BinaryFile> runFile;
+    std::unique_ptr<BinaryFile> nextFile;
+    try
+    {
+        runFile.reset(new BinaryFile(runPath, true));
+        std::vector<Run> runs = formRuns<T>(in, stats.elements, *runFile, runLength, io, comp, proj);
+        stats.runs = runs.size();
+
+        for (int pass = 1; runs.size() > 1; pass++)
+        {
+            nextPath = runs.size() <= maxFanIn ? output : tempPath(options, output, pass);
+            nextFile.reset(new BinaryFile(nextPath, true));
+
+            std::vector<Run> merged;
+            std::uint64_t offset = 0;
+            for (std::size_t first = 0; first < runs.size(); first += maxFanIn)
+            {
+                int count = static_cast<int>(std::min(maxFanIn, runs.size() - first));
+                std::size_t blockLength =
+                    std::max<std::size_t>(options.memoryBudget / ((2 * count + 2) * sizeof(T)), 1);
+                mergeRuns<T>(*runFile, &runs[first], count, *nextFile, offset, blockLength, io, less);
+
+                Run run = {offset, 0};
+                for (int i = 0; i < count; i++)
+                    run.length += runs[first + i].length;
+                merged.push_back(run);
+                offset += run.length;
+            }
+
+            runFile.reset();
+            std::remove(runPath.c_str());
+            runFile.swap(nextFile);
+            runPath = nextPath;
+            runs.swap(merged);
+            stats.mergePasses++;
+        }
+    }
+    catch (...)
+    {
+        // Leave no run files behind
+        runFile.reset();
+        nextFile.reset();
+        if (runPath != output)
+            std::remove(runPath.c_str());
+        if (!nextPath.empty() && nextPath != output)
+            std::remove(nextPath.c_str());
+        throw;
+    }
+
+    return stats;
+}
+
+// Cut the input into sorted runs of runLength records, written back to back to out
+template <typename T, typename Compare, typename Projection>
+std::vector<ExternalSort::Run> ExternalSort::formRuns(BinaryFile &in, std::uint64_t total, BinaryFile &out,
+                                                      std::size_t runLength, IoThread &io,
+                                                      Compare &comp, Projection &proj)
+{
+    std::vector<Run> runs;
+    for (std::uint64_t offset = 0; offset < total; offset += runLength)
+    {
+        Run run = {offset, std::min<std::uint64_t>(runLength, total - offset)};
+        runs.push_back(run);
+    }
+
+    // Chunk i lives in buffers[i % 3]: while it is sorted, chunk i + 1 is
+    // read into the next buffer and run i - 1 is written from the previous one
+    std::vector<T> buffers[3];
+    std::future<void> reading;
+    std::future<void> writing[3];
+
+    try
+    {
+        reading = submitRead(io, in, runs[0], buffers[0]);
+        for (std::size_t i = 0; i < runs.size(); i++)
+        {
+            std::vector<T> &chunk = buffers[i % 3];
+            reading.get();
+
+            if (i + 1 < runs.size())
+            {
+                int ahead = (i + 1) % 3;
+                if (writing[ahead].valid())
+                    writing[ahead].get();
+                reading = submitRead(io, in, runs[i + 1], buffers[ahead]);
+            }
+
+            SortEngine::sort(chunk.begin(), chunk.end(), comp, proj);
+
+            BinaryFile *target = &out;
+            const T *data = chunk.data();
+            std::uint64_t offset = runs[i].offset * sizeof(T);
+            std::size_t bytes = chunk.size() * sizeof(T);
+            writing[i % 3] = io.submit([target, offset, data, bytes]()
+                                       { target->write(offset, data, bytes); });
+        }
+
+        for (int b = 0; b < 3; b++)
+        {
+            if (writing[b].valid())
+                writing[b].get();
+        }
+    }
+    catch (...)
+    {
+        // Do not free buffers the I/O thread may still be using
+        if (reading.valid())
+            reading.wait();
+        for (int b = 0; b < 3; b++)
+        {
+            if (writing[b].valid())
+                writing[b].wait();
+        }
+        throw;
+    }
+    return runs;
+}
+
+// Resize chunk to the run and queue reading the run's records into it
+template <typename T>
+std::future<void> ExternalSort::submitRead(IoThread &io, BinaryFile &in, const Run &run, std::vector<T> &chunk)
+{
+    chunk.resize(static_cast<std::size_t>(run.length));
+
+    BinaryFile *source = &in;
+    T *data = chunk.data();
+    std::uint64_t offset = run.offset * sizeof(T);
+    std::size_t bytes = chunk.size() * sizeof(T);
+    return io.submit([source, offset, data, bytes]()
+                     { source->read(offset, data, bytes); });
+}
+
+// k-way merge of runs[0, count) from in, written to out starting at record outOffset
+template <typename T, typename Less>
+void ExternalSort::mergeRuns(BinaryFile &in, const Run *runs, int count, BinaryFile &out,
+                             std::uint64_t outOffset, std::size_t blockLength, IoThread &io, Less &less)
+{
+    std::vector<std::unique_ptr<RunReader<T> > > readers;
+    LoserTree<T, Less> tree(count, less);
+    for (int i = 0; i < count; i++)
+    {
+        readers.push_back(std::unique_ptr<RunReader<T> >(new RunReader<T>(in, runs[i], blockLength, io)));
+        if (!readers[i]->empty())
+            tree.set(i, readers[i]->value());
+    }
+    tree.build();
+
+    RunWriter<T> writer(out, outOffset, blockLength, io);
+    while (!tree.empty())
+    {
+        int i = tree.top();
+        writer.push(tree.topKey());
+
+        RunReader<T> &reader = *readers[i];
+        reader.advance();
+        if (reader.empty())
+            tree.removeTop();
+        else
+            tree.replaceTop(reader.value());
+    }
+    writer.finish();
+}
+
+#endif // EXTERNAL_SORT_H
@@ -1,31 +1,15 @@
 #include "graph.h"
 #include "utils.h"
+#include "trace_log.h"
+#include "dataset.h"
+#include "graph_paths.h"
+#include "graph_sssp.h"
 #include <iostream>
+#include <memory>
 #include <algorithm>
 #include <thread>
 #include <chrono>
 
-// Constructor
-Graph::Graph(int v) : vertices(v)
-{
-    adjList.resize(v);
-    weightedAdjList.resize(v);
-}
-
-// Add edge for unweighted graph
-void Graph::addEdge(int u, int v)
-{
-    adjList[u].push_back(v);
-    adjList[v].push_back(u); // For undirected graph
-}
-
-// Add weighted edge for weighted graph
-void Graph::addWeightedEdge(int u, int v, int weight)
-{
-    weightedAdjList[u].push_back(std::make_pair(v, weight));
-    weightedAdjList[v].push_back(std::make_pair(u, weight)); // For undirected graph
-}
-
 // Create sample unweighted graph for demonstration
 void Graph::createSampleGraph()
 {
@@ -138,10 +122,12 @@ void Graph::displayGraph()
     std::cout << "\n--- Graph Adjacency List ---" << std::endl;
     Utils::resetColor();
 
+    const CsrGraph &graph = adjacency();
+
     for (int i = 0; i < vertices; i++)
     {
         std::cout << "Vertex " << i << ": ";
-        for (auto &neighbor : adjList[i])
+        for (int neighbor : graph.neighbors(i))
         {
             std::cout << neighbor << " ";
         }
@@ -156,12 +142,14 @@ void Graph::displayWeightedGraph()
     std::cout << "\n--- Weighted Graph Adjacency List ---" << std::endl;
     Utils::resetColor();
 
+    const CsrGraph &graph = weightedAdjacency();
+
     for (int i = 0; i < vertices; i++)
     {
         std::cout << "Vertex " << i << ": ";
-        for (auto &edge : weightedAdjList[i])
+        for (std::uint64_t e = graph.edgeBegin(i); e < graph.edgeEnd(i); e++)
         {
-            std::cout << "(" << edge.first << "," << edge.second << ") ";
+            std::cout << "(" << graph.target(e) << "," << graph.weight(e) << ") ";
         }
         std::cout << std::endl;
     }
@@ -193,6 +181,136 @@ void Graph::showComplexityInfo(const std::string &algorithm)
     {
         Utils::printComplexity("Dijkstra's Algorithm", "O((V + E) log V)", "O(V)");
     }
+    else if (algorithm == "Path")
+    {
+        Utils::printComplexity("Point-to-Point Dijkstra / A*", "O((V + E) log V) worst case", "O(V)");
+    }
+}
+
+// ==================== STEP HOOKS ====================
+// Every step of BFS, DFS and Dijkstra goes through these: recorded as a
+// GraphEvent when a TraceLog is attached, printed otherwise
+
+// A vertex taken from the queue/stack; waiting[head..] is what is still in it, and
+// "neighborsOf vertex after: " introduces the neighbors that follow
+void Graph::showVisit(int vertex, const std::string &algorithm, const std::string &structure,
+                      const std::vector<int> &waiting, std::size_t head, const std::string &neighborsOf,
+                      const std::string &after)
+{
+    if (traceLog)
+    {
+        traceLog->record(TRACE_GRAPH_EVENT, GRAPH_VISIT, vertex, static_cast<int>(waiting.size() - head));
+        return;
+    }
+
+    std::string state = structure + ": [";
+    for (std::size_t i = head; i < waiting.size(); i++)
+    {
+        if (i > head)
+            state += ", ";
+        state += std::to_string(waiting[i]);
+    }
+    state += "]";
+    printTraversalStep(vertex, algorithm, state);
+
+    Utils::setColor(LIGHT_BLUE);
+    std::cout << "  " << neighborsOf << " " << vertex << after << ": ";
+    Utils::resetColor();
+}
+
+void Graph::showNeighbor(int vertex, int neighbor, bool added, const std::string &addedNote)
+{
+    if (traceLog)
+    {
+        traceLog->record(TRACE_GRAPH_EVENT, added ? GRAPH_DISCOVER : GRAPH_ALREADY_VISITED, vertex, neighbor);
+        return;
+    }
+
+    std::cout << neighbor << " ";
+    Utils::setColor(added ? GREEN : RED);
+    std::cout << (added ? "(" + addedNote + ") " : std::string("(already visited) "));
+    Utils::resetColor();
+}
+
+void Graph::endVisit()
+{
+    if (traceLog)
+        return;
+    std::cout << std::endl;
+    Utils::printSeparator('-', 20);
+}
+
+void Graph::showSettle(int vertex, int distance, int step)
+{
+    if (traceLog)
+    {
+        traceLog->record(TRACE_GRAPH_EVENT, GRAPH_SETTLE, vertex, 0, 0, distance);
+        return;
+    }
+
+    Utils::setColor(LIGHT_GREEN);
+    std::cout << "Step " << step << " - Processing vertex " << vertex << " (distance: " << distance << ")"
+              << std::endl;
+    Utils::resetColor();
+    Utils::setColor(LIGHT_BLUE);
+    std::cout << "  Checking neighbors of vertex " << vertex << ":" << std::endl;
+    Utils::resetColor();
+}
+
+// event: GRAPH_RELAX, GRAPH_ALREADY_VISITED or GRAPH_NO_IMPROVEMENT; distance: v's distance after the check
+void Graph::showRelax(GraphEvent event, int u, int v, int weight, int distance)
+{
+    if (traceLog)
+    {
+        if (event == GRAPH_ALREADY_VISITED)
+            traceLog->record(TRACE_GRAPH_EVENT, event, u, v);
+        else
+            traceLog->record(TRACE_GRAPH_EVENT, event, u, v, weight, distance);
+        return;
+    }
+
+    std::cout << "    Neighbor " << v << " (edge weight: " << weight << ")";
+    if (event == GRAPH_RELAX)
+    {
+        Utils::setColor(GREEN);
+        std::cout << " -> Updated distance to " << distance << std::endl;
+    }
+    else if (event == GRAPH_ALREADY_VISITED)
+    {
+        Utils::setColor(RED);
+        std::cout << " -> Already visited" << std::endl;
+    }
+    else
+    {
+        Utils::setColor(YELLOW);
+        std::cout << " -> No improvement (current: " << distance << ")" << std::endl;
+    }
+    Utils::resetColor();
+}
+
+// The distance table after a vertex is settled (the trace has the changes already)
+void Graph::endSettle(const std::vector<int> &dist)
+{
+    if (traceLog)
+        return;
+
+    Utils::setColor(CYAN);
+    std::cout << "  Current distances: ";
+    for (int i = 0; i < vertices; i++)
+    {
+        if (dist[i] == std::numeric_limits<int>::max())
+        {
+            std::cout << "∞ ";
+        }
+        else
+        {
+            std::cout << dist[i] << " ";
+        }
+    }
+    std::cout << std::endl;
+    Utils::resetColor();
+
+    Utils::printSeparator('-', 30);
 }
 
 // ==================== BREADTH-FIRST SEARCH ====================
@@ -204,72 +322,51 @@ void Graph::BFS(int startVertex)
     std::cout << "BFS explores vertices level by level using a queue." << std::endl;
     Utils::resetColor();
 
-    displayGraph();
+    if (!traceLog)
+        displayGraph();
 
     std::vector<bool> visited(vertices, false);
-    std::queue<int> queue;
+    const CsrGraph &graph = adjacency();
+    // The queue is queue[head..]; popped vertices stay in front of head
+    std::vector<int> queue;
+    std::size_t head = 0;
 
     Utils::setColor(YELLOW);
     std::cout << "\nStarting BFS from vertex " << startVertex << std::endl;
     Utils::resetColor();
 
     visited[startVertex] = true;
-    queue.push(startVertex);
+    queue.push_back(startVertex);
 
     std::cout << "\nTraversal order:" << std::endl;
     Utils::printSeparator('-', 40);
 
-    while (!queue.empty())
+    while (head < queue.size())
     {
-        int currentVertex = queue.front();
-        queue.pop();
-
-        // Show current queue state
-        std::string queueState = "Queue: [";
-        std::queue<int> tempQueue = queue;
-        bool first = true;
-        while (!tempQueue.empty())
-        {
-            if (!first)
-                queueState += ", ";
-            queueState += std::to_string(tempQueue.front());
-            tempQueue.pop();
-            first = false;
-        }
-        queueState += "]";
-
-        printTraversalStep(currentVertex, "BFS", queueState);
+        int currentVertex = queue[head++];
+        showVisit(currentVertex, "BFS", "Queue", queue, head, "Exploring neighbors of", "");
 
         // Explore all adjacent vertices
-        Utils::setColor(LIGHT_BLUE);
-        std::cout << "  Exploring neighbors of " << currentVertex << ": ";
-        Utils::resetColor();
-
-        for (auto &neighbor : adjList[currentVertex])
+        for (int neighbor : graph.neighbors(currentVertex))
         {
-            std::cout << neighbor << " ";
-            if (!visited[neighbor])
+            bool added = !visited[neighbor];
+            if (added)
             {
                 visited[neighbor] = true;
-                queue.push(neighbor);
-                Utils::setColor(GREEN);
-                std::cout << "(added to queue) ";
-                Utils::resetColor();
-            }
-            else
-            {
-                Utils::setColor(RED);
-                std::cout << "(already visited) ";
-                Utils::resetColor();
+                queue.push_back(neighbor);
             }
+            showNeighbor(currentVertex, neighbor, added, "added to queue");
         }
-        std::cout << std::endl;
-        Utils::printSeparator('-', 20);
+        endVisit();
     }
 
     Utils::setColor(LIGHT_GREEN);
     std::cout << "\nBFS traversal completed!" << std::endl;
     Utils::resetColor();
+    if (traceLog)
+    {
+        std::cout << traceLog->size() << " steps recorded to " << traceLog->name() << std::endl;
+    }
 
     showComplexityInfo("BFS");
 }
@@ -283,87 +380,52 @@ void Graph::DFS(int startVertex)
     std::cout << "DFS explores as far as possible along each branch using a stack." << std::endl;
     Utils::resetColor();
 
-    displayGraph();
+    if (!traceLog)
+        displayGraph();
 
     std::vector<bool> visited(vertices, false);
-    std::stack<int> stack;
+    const CsrGraph &graph = adjacency();
+    std::vector<int> stack; // top at the back
 
     Utils::setColor(YELLOW);
     std::cout << "\nStarting DFS from vertex " << startVertex << std::endl;
     Utils::resetColor();
 
-    stack.push(startVertex);
+    stack.push_back(startVertex);
 
     std::cout << "\nTraversal order:" << std::endl;
     Utils::printSeparator('-', 40);
 
     while (!stack.empty())
     {
-        int currentVertex = stack.top();
-        stack.pop();
-
-        if (!visited[currentVertex])
-        {
-            visited[currentVertex] = true;
-
-            // Show current stack state
-            std::string stackState = "Stack: [";
-            std::stack<int> tempStack = stack;
-            std::vector<int> stackContents;
-            while (!tempStack.empty())
-            {
-                stackContents.push_back(tempStack.top());
-                tempStack.pop();
-            }
-
-            for (int i = stackContents.size() - 1; i >= 0; i--)
-            {
-                if (i < (int)stackContents.size() - 1)
-                    stackState += ", ";
-                stackState += std::to_string(stackContents[i]);
-            }
-            stackState += "]";
-
-            printTraversalStep(currentVertex, "DFS", stackState);
-
-            // Add all unvisited neighbors to stack (in reverse order to maintain left-to-right traversal)
-            Utils::setColor(LIGHT_BLUE);
-            std::cout << "  Adding unvisited neighbors of " << currentVertex << " to stack: ";
-            Utils::resetColor();
+        int currentVertex = stack.back();
+        stack.pop_back();
+        if (visited[currentVertex])
+            continue;
 
-            std::vector<int> neighbors;
-            for (auto &neighbor : adjList[currentVertex])
-            {
-                neighbors.push_back(neighbor);
-            }
+        visited[currentVertex] = true;
+        showVisit(currentVertex, "DFS", "Stack", stack, 0, "Adding unvisited neighbors of", " to stack");
 
-            // Add in reverse order to maintain proper traversal order
-            for (int i = neighbors.size() - 1; i >= 0; i--)
-            {
-                int neighbor = neighbors[i];
-                std::cout << neighbor << " ";
-                if (!visited[neighbor])
-                {
-                    stack.push(neighbor);
-                    Utils::setColor(GREEN);
-                    std::cout << "(added) ";
-                    Utils::resetColor();
-                }
-                else
-                {
-                    Utils::setColor(RED);
-                    std::cout << "(already visited) ";
-                    Utils::resetColor();
-                }
-            }
-            std::cout << std::endl;
-            Utils::printSeparator('-', 20);
+        // Add in reverse order to maintain left-to-right traversal
+        CsrGraph::Neighbors range = graph.neighbors(currentVertex);
+        for (const std::int32_t *neighbor = range.end(); neighbor != range.begin();)
+        {
+            --neighbor;
+            bool added = !visited[*neighbor];
+            if (added)
+                stack.push_back(*neighbor);
+            showNeighbor(currentVertex, *neighbor, added, "added");
         }
+        endVisit();
     }
 
     Utils::setColor(LIGHT_GREEN);
     std::cout << "\nDFS traversal completed!" << std::endl;
     Utils::resetColor();
+    if (traceLog)
+    {
+        std::cout << traceLog->size() << " steps recorded to " << traceLog->name() << std::endl;
+    }
 
     showComplexityInfo("DFS");
 }
@@ -377,12 +439,14 @@ void Graph::dijkstra(int startVertex)
     std::cout << "Dijkstra's algorithm finds shortest paths from source to all vertices." << std::endl;
     Utils::resetColor();
 
-    displayWeightedGraph();
+    if (!traceLog)
+        displayWeightedGraph();
 
     // Initialize distances and parent array
     std::vector<int> dist(vertices, std::numeric_limits<int>::max());
     std::vector<int> parent(vertices, -1);
     std::vector<bool> visited(vertices, false);
+    const CsrGraph &graph = weightedAdjacency();
 
     // Priority queue to store vertices and their distances
     std::priority_queue<MinHeapNode, std::vector<MinHeapNode>, Compare> pq;
@@ -409,68 +473,39 @@ void Graph::dijkstra(int startVertex)
             continue; // Skip if already visited
 
         visited[u] = true;
-
-        Utils::setColor(LIGHT_GREEN);
-        std::cout << "Step " << step++ << " - Processing vertex " << u
-                  << " (distance: " << dist[u] << ")" << std::endl;
-        Utils::resetColor();
+        showSettle(u, dist[u], step++);
 
         // Update distances of all adjacent vertices
-        Utils::setColor(LIGHT_BLUE);
-        std::cout << "  Checking neighbors of vertex " << u << ":" << std::endl;
-        Utils::resetColor();
-
-        for (auto &edge : weightedAdjList[u])
+        for (std::uint64_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); e++)
         {
-            int v = edge.first;
-            int weight = edge.second;
-
-            std::cout << "    Neighbor " << v << " (edge weight: " << weight << ")";
+            int v = graph.target(e);
+            int weight = graph.weight(e);
 
-            if (!visited[v] && dist[u] != std::numeric_limits<int>::max() &&
-                dist[u] + weight < dist[v])
+            if (!visited[v] && dist[u] + weight < dist[v])
             {
                 dist[v] = dist[u] + weight;
                 parent[v] = u;
                 pq.push(MinHeapNode(v, dist[v]));
-
-                Utils::setColor(GREEN);
-                std::cout << " -> Updated distance to " << dist[v] << std::endl;
-                Utils::resetColor();
-            }
-            else if (visited[v])
-            {
-                Utils::setColor(RED);
-                std::cout << " -> Already visited" << std::endl;
-                Utils::resetColor();
+                showRelax(GRAPH_RELAX, u, v, weight, dist[v]);
             }
             else
             {
-                Utils::setColor(YELLOW);
-                std::cout << " -> No improvement (current: " << dist[v] << ")" << std::endl;
-                Utils::resetColor();
+                showRelax(visited[v] ? GRAPH_ALREADY_VISITED : GRAPH_NO_IMPROVEMENT, u, v, weight, dist[v]);
             }
         }
+        endSettle(dist);
+    }
 
-        // Show current distances
-        Utils::setColor(CYAN);
-        std::cout << "  Current distances: ";
-        for (int i = 0; i < vertices; i++)
-        {
-            if (dist[i] == std::numeric_limits<int>::max())
-            {
-                std::cout << "∞ ";
-            }
-            else
-            {
-                std::cout << dist[i] << " ";
-            }
-        }
-        std::cout << std::endl;
+    // The distances are in the trace (GRAPH_SETTLE), only summarize them
+    if (traceLog)
+    {
+        int reached = static_cast<int>(std::count(visited.begin(), visited.end(), true));
+        Utils::setColor(LIGHT_GREEN);
+        std::cout << "\nReached " << reached << " of " << vertices << " vertices from " << startVertex << std::endl;
         Utils::resetColor();
-
-        Utils::printSeparator('-', 30);
-        // Pause removed for compatibility
+        std::cout << traceLog->size() << " steps recorded to " << traceLog->name() << std::endl;
+        showComplexityInfo("Dijkstra");
+        return;
     }
 
     // Print final results
@@ -505,6 +540,72 @@ void Graph::dijkstra(int startVertex)
     showComplexityInfo("Dijkstra");
 }
 
+// ==================== POINT-TO-POINT SHORTEST PATH ====================
+
+void Graph::shortestPath(int source, int target)
+{
+    Utils::printHeader("SHORTEST PATH BETWEEN TWO VERTICES");
+    Utils::setColor(CYAN);
+    std::cout << "Three searches for one path; each stops once no shorter path to " << target << " is left."
+              << std::endl;
+    Utils::resetColor();
+
+    if (!traceLog)
+        displayWeightedGraph();
+
+    const CsrGraph &graph = weightedAdjacency();
+    PathFinder finder(graph);
+    Landmarks landmarks(graph, std::min<int>(Landmarks::DEFAULT_COUNT, vertices));
+
+    const char *const names[] = {"Dijkstra, stopping at the target", "Bidirectional Dijkstra",
+                                 "A* with landmark bounds (ALT)"};
+    for (int method = 0; method < 3; method++)
+    {
+        PathResult result;
+        if (method == 0)
+            result = finder.dijkstra(source, target);
+        else if (method == 1)
+            result = finder.bidirectional(source, target);
+        else
+            result = finder.astar(source, target, landmarks);
+
+        Utils::setColor(YELLOW);
+        std::cout << "\n" << names[method] << std::endl;
+        Utils::resetColor();
+        if (result.dist == GraphSssp::UNREACHED)
+        {
+            Utils::setColor(RED);
+            std::cout << "  " << target << " is unreachable from " << source << std::endl;
+            Utils::resetColor();
+        }
+        else
+        {
+            Utils::setColor(GREEN);
+            std::cout << "  Distance: " << result.dist << std::endl;
+            Utils::resetColor();
+            std::cout << "  Path: ";
+            for (std::size_t i = 0; i < result.path.size(); i++)
+            {
+                std::cout << (i ? " -> " : "") << result.path[i];
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "  Settled " << result.settled << " and labelled " << result.touched << " of " << vertices
+                  << " vertices" << std::endl;
+    }
+
+    Utils::setColor(CYAN);
+    std::cout << "\nLandmarks: ";
+    for (int landmark : landmarks.vertices())
+    {
+        std::cout << landmark << " ";
+    }
+    std::cout << std::endl;
+    Utils::resetColor();
+
+    showComplexityInfo("Path");
+}
+
 // Print path from source to target
 void Graph::printPath(const std::vector<int> &parent, int target)
 {
@@ -525,10 +626,91 @@ void Graph::showGraphMenu()
     std::cout << "1. Breadth-First Search (BFS)" << std::endl;
     std::cout << "2. Depth-First Search (DFS)" << std::endl;
     std::cout << "3. Dijkstra's Shortest Path" << std::endl;
-    std::cout << "4. Back to Main Menu" << std::endl;
+    std::cout << "4. Shortest Path Between Two Vertices" << std::endl;
+    std::cout << "5. Trace Graph Algorithm to File" << std::endl;
+    std::cout << "6. Back to Main Menu" << std::endl;
     Utils::printSeparator('-', 30);
 }
 
+namespace
+{
+    // Ask for the starting vertex (and target, for choice 4) and run menu choice 1-4 on g;
+    // with a trace path, choice 1-3 records its steps to that file instead of printing them
+    void runFromVertex(Graph &g, int choice, const std::string &tracePath = "")
+    {
+        int startVertex;
+        std::cout << "\nEnter starting vertex (0-" << (g.size() - 1) << "): ";
+        std::cin >> startVertex;
+
+        int targetVertex = 0;
+        if (choice == 4)
+        {
+            std::cout << "Enter target vertex (0-" << (g.size() - 1) << "): ";
+            std::cin >> targetVertex;
+        }
+
+        if (startVertex >= 0 && startVertex < g.size() && targetVertex >= 0 && targetVertex < g.size())
+        {
+            Utils::clearConsole();
+
+            std::unique_ptr<TraceLog> log;
+            if (!tracePath.empty())
+            {
+                try
+                {
+                    log.reset(new TraceLog(tracePath));
+                }
+                catch (const std::exception &e)
+                {
+                    Utils::setColor(RED);
+                    std::cout << "Trace failed: " << e.what() << std::endl;
+                    Utils::resetColor();
+                    return;
+                }
+                g.setTraceLog(log.get());
+            }
+
+            switch (choice)
+            {
+            case 1:
+                g.BFS(startVertex);
+                break;
+            case 2:
+                g.DFS(startVertex);
+                break;
+            case 3:
+                g.dijkstra(startVertex);
+                break;
+            case 4:
+                g.shortestPath(startVertex, targetVertex);
+                break;
+            }
+
+            if (log)
+            {
+                g.setTraceLog(nullptr);
+                try
+                {
+                    log->close();
+                    std::cout << "Replay with: AlgoVaultTrace " << tracePath << std::endl;
+                }
+                catch (const std::exception &e)
+                {
+                    Utils::setColor(RED);
+                    std::cout << "Trace failed: " << e.what() << std::endl;
+                    Utils::resetColor();
+                }
+            }
+        }
+        else
+        {
+            Utils::setColor(RED);
+            std::cout << (choice == 4 ? "Invalid starting or target vertex!" : "Invalid starting vertex!") << std::endl;
+            Utils::resetColor();
+        }
+    }
+}
+
 void Graph::runGraphAlgorithms()
 {
     int choice;
@@ -538,105 +720,100 @@ void Graph::runGraphAlgorithms()
         Utils::clearConsole();
         showGraphMenu();
 
-        std::cout << "Enter your choice (1-4): ";
+        std::cout << "Enter your choice (1-6): ";
         std::cin >> choice;
 
-        if (choice >= 1 && choice <= 3)
+        // Trace: pick the algorithm and file, then load the graph as for that algorithm
+        std::string tracePath;
+        if (choice == 5)
+        {
+            Utils::clearConsole();
+            Utils::printHeader("TRACE GRAPH ALGORITHM");
+            Utils::setColor(CYAN);
+            std::cout << "Records every step of BFS, DFS or Dijkstra to a binary trace file instead of printing it;"
+                      << std::endl;
+            std::cout << "replay the file with AlgoVaultTrace (make trace)." << std::endl;
+            Utils::resetColor();
+            std::cout << "Algorithm (1 = BFS, 2 = DFS, 3 = Dijkstra): ";
+            std::cin >> choice;
+            if (choice < 1 || choice > 3)
+            {
+                Utils::setColor(RED);
+                std::cout << "Invalid algorithm!" << std::endl;
+                Utils::resetColor();
+                Utils::pauseConsole();
+                continue;
+            }
+            std::cout << "Trace file: ";
+            std::cin >> tracePath;
+        }
+
+        if (choice >= 1 && choice <= 4)
         {
             Utils::clearConsole();
 
-            int vertices, startVertex;
             char useSample;
 
-            std::cout << "Use sample graph? (y/n): ";
+            std::cout << "Use sample graph? (y/n, or f to load a dataset file): ";
             std::cin >> useSample;
 
             if (useSample == 'y' || useSample == 'Y')
             {
-                vertices = 5; // Sample graph has 5 vertices
+                int vertices = 5; // Sample graph has 5 vertices
                 Graph g(vertices);
 
-                if (choice == 3)
-                { // Dijkstra needs weighted graph
+                if (choice >= 3)
+                { // Dijkstra and the path queries need a weighted graph
                     g.createSampleWeightedGraph();
                 }
                 else
                 { // BFS and DFS use unweighted graph
                     g.createSampleGraph();
                 }
+                runFromVertex(g, choice, tracePath);
+            }
+            else if (useSample == 'f' || useSample == 'F')
+            {
+                std::string path;
+                std::cout << "Dataset file (.avds): ";
+                std::cin >> path;
 
-                std::cout << "\nEnter starting vertex (0-" << (vertices - 1) << "): ";
-                std::cin >> startVertex;
-
-                if (startVertex >= 0 && startVertex < vertices)
+                try
                 {
-                    Utils::clearConsole();
-
-                    switch (choice)
-                    {
-                    case 1:
-                        g.BFS(startVertex);
-                        break;
-                    case 2:
-                        g.DFS(startVertex);
-                        break;
-                    case 3:
-                        g.dijkstra(startVertex);
-                        break;
-                    }
+                    // The first graph in the file, used as stored (weight 1 if it has none)
+                    Dataset dataset(path);
+                    dataset.checkGraph();
+                    DatasetGraph stored = dataset.graph();
+                    Graph g(stored.vertices);
+                    g.addEdges(stored);
+                    runFromVertex(g, choice, tracePath);
                 }
-                else
+                catch (const std::exception &e)
                 {
                     Utils::setColor(RED);
-                    std::cout << "Invalid starting vertex!" << std::endl;
+                    std::cout << "Error: " << e.what() << std::endl;
                     Utils::resetColor();
                 }
             }
             else
             {
-                vertices = Utils::getPositiveIntFromUser("Enter number of vertices: ");
+                int vertices = Utils::getPositiveIntFromUser("Enter number of vertices: ");
                 Graph g(vertices);
 
-                if (choice == 3)
-                { // Dijkstra
+                if (choice >= 3)
+                { // Dijkstra and the path queries
                     g.inputWeightedGraph();
                 }
                 else
                 { // BFS and DFS
                     g.inputGraph();
                 }
-
-                std::cout << "\nEnter starting vertex (0-" << (vertices - 1) << "): ";
-                std::cin >> startVertex;
-
-                if (startVertex >= 0 && startVertex < vertices)
-                {
-                    Utils::clearConsole();
-
-                    switch (choice)
-                    {
-                    case 1:
-                        g.BFS(startVertex);
-                        break;
-                    case 2:
-                        g.DFS(startVertex);
-                        break;
-                    case 3:
-                        g.dijkstra(startVertex);
-                        break;
-                    }
-                }
-                else
-                {
-                    Utils::setColor(RED);
-                    std::cout << "Invalid starting vertex!" << std::endl;
-                    Utils::resetColor();
-                }
+                runFromVertex(g, choice, tracePath);
             }
 
             Utils::pauseConsole();
         }
-        else if (choice == 4)
+        else if (choice == 6)
         {
             return;
         }
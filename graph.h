@@ -2,24 +2,66 @@
 #define GRAPH_H
 
 #include <vector>
-#include <list>
 #include <queue>
 #include <stack>
 #include <string>
 #include <limits>
+#include "csr_graph.h"
 
 /**
  * Graph Algorithms Implementation for AlgoVault
- * Includes: BFS, DFS, Dijkstra's Shortest Path
- * Uses adjacency list representation
+ * Includes: BFS, DFS, Dijkstra's Shortest Path, point-to-point shortest paths
+ * Edges are kept in compressed sparse row form (csr_graph.h): edges added
+ * with addEdge/addWeightedEdge are collected and folded into the CSR
+ * arrays the next time an algorithm runs
+ * With a TraceLog attached (setTraceLog), BFS, DFS and Dijkstra record the
+ * steps below to it instead of printing them; the graph menu's Trace Graph
+ * Algorithm to File entry does that for one run
  */
 
+class TraceLog;
+struct DatasetGraph;
+
+// One line of an edge list file
+struct GraphEdge
+{
+    int u, v, weight;
+};
+
+// Steps recorded to a TraceLog (arguments a, b, c, valueA of the event)
+enum GraphEvent
+{
+    GRAPH_VISIT,           // a: vertex taken from the queue/stack, b: vertices still waiting
+    GRAPH_DISCOVER,        // a: vertex, b: neighbor added to the queue/stack
+    GRAPH_ALREADY_VISITED, // a: vertex, b: neighbor skipped
+    GRAPH_SETTLE,          // a: vertex processed by Dijkstra, valueA: its distance
+    GRAPH_RELAX,           // a: u, b: v, c: edge weight, valueA: new distance of v
+    GRAPH_NO_IMPROVEMENT   // a: u, b: v, c: edge weight, valueA: current distance of v
+};
+
 class Graph
 {
 private:
     int vertices;
-    std::vector<std::list<int>> adjList;                         // For BFS and DFS
-    std::vector<std::list<std::pair<int, int>>> weightedAdjList; // For Dijkstra (vertex, weight)
+    mutable CsrGraph csr;                            // For BFS and DFS
+    mutable CsrGraph weightedCsr;                    // For Dijkstra
+    mutable std::vector<GraphEdge> newEdges;         // Added since csr was built
+    mutable std::vector<GraphEdge> newWeightedEdges; // Added since weightedCsr was built
+    TraceLog *traceLog;                              // Record steps here instead of printing them
+
+    // The CSR graphs with every edge added so far
+    const CsrGraph &adjacency() const;
+    const CsrGraph &weightedAdjacency() const;
+
+    // Step hooks of the algorithms: record to traceLog if attached, print otherwise
+    void showVisit(int vertex, const std::string &algorithm, const std::string &structure,
+                   const std::vector<int> &waiting, std::size_t head, const std::string &neighborsOf,
+                   const std::string &after);
+    void showNeighbor(int vertex, int neighbor, bool added, const std::string &addedNote);
+    void endVisit();
+    void showSettle(int vertex, int distance, int step);
+    void showRelax(GraphEvent event, int u, int v, int weight, int distance);
+    void endSettle(const std::vector<int> &dist);
 
 public:
     // Constructors
@@ -28,6 +70,7 @@ public:
     // Graph building functions
     void addEdge(int u, int v);                     // For unweighted graphs
     void addWeightedEdge(int u, int v, int weight); // For weighted graphs
+    void addEdges(const DatasetGraph &graph);       // Replace all edges by a dataset graph's, as stored
     void createSampleGraph();                       // Create a sample graph for demonstration
     void createSampleWeightedGraph();               // Create a sample weighted graph
 
@@ -43,6 +86,20 @@ public:
     void BFS(int startVertex);
     void DFS(int startVertex);
     void dijkstra(int startVertex);
+    void shortestPath(int source, int target); // Compares the PathFinder queries (graph_paths.h)
+
+    // Record the algorithms' steps to log instead of printing them (nullptr prints again)
+    void setTraceLog(TraceLog *log) { traceLog = log; }
+
+    // Quiet versions for batch runs (graph_core.cpp): nothing is printed
+    int size() const { return vertices; }
+    std::vector<int> bfsLevels(int startVertex) const;                  // hops from startVertex, -1 where unreachable
+    std::vector<int> dfsOrder(int startVertex) const;                   // reachable vertices in DFS visiting order
+    std::vector<std::uint64_t> shortestDistances(int startVertex) const; // UINT64_MAX where unreachable
+
+    // Edge list file: "u v [weight]" per line (weight 1 if left out), # starts a comment;
+    // vertices is set to one more than the largest vertex named
+    static std::vector<GraphEdge> readEdgeList(const std::string &path, int &vertices);
 
     // Utility functions
     void printTraversalStep(int vertex, const std::string &algorithm, const std::string &structure);
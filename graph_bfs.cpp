@@ -0,0 +1,285 @@
+#include "graph_bfs.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace
+{
+    // One bit per vertex
+    class Bitmap
+    {
+    public:
+        explicit Bitmap(int bits) : words((static_cast<std::size_t>(bits) + 63) / 64, 0) {}
+
+        bool get(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+        void set(int i) { words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+        void clear() { std::fill(words.begin(), words.end(), 0); }
+        void swap(Bitmap &other) { words.swap(other.words); }
+
+        // The set bits in ascending order
+        void collect(std::vector<int> &out) const
+        {
+            for (std::size_t w = 0; w < words.size(); w++)
+            {
+                for (int bit = 0; bit < 64 && (words[w] >> bit) != 0; bit++)
+                {
+                    if ((words[w] >> bit) & 1)
+                        out.push_back(static_cast<int>(w * 64 + bit));
+                }
+            }
+        }
+
+    private:
+        std::vector<std::uint64_t> words;
+    };
+
+    // Visited bits shared by the threads of a parallel search
+    class AtomicBitmap
+    {
+    public:
+        explicit AtomicBitmap(int bits) : words((static_cast<std::size_t>(bits) + 63) / 64)
+        {
+            for (std::atomic<std::uint64_t> &word : words)
+                word.store(0, std::memory_order_relaxed);
+        }
+
+        // Sets bit i; true only for the one caller that changed it
+        bool claim(int i)
+        {
+            std::atomic<std::uint64_t> &word = words[i >> 6];
+            const std::uint64_t bit = std::uint64_t(1) << (i & 63);
+            std::uint64_t old = word.load(std::memory_order_relaxed);
+            while (!(old & bit))
+            {
+                if (word.compare_exchange_weak(old, old | bit, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+    private:
+        std::vector<std::atomic<std::uint64_t> > words;
+    };
+
+    void start(BfsResult &result, const CsrGraph &graph, int source)
+    {
+        result.parent.assign(graph.size(), -1);
+        result.depth.assign(graph.size(), -1);
+        result.parent[source] = source;
+        result.depth[source] = 0;
+        result.reached = 1;
+    }
+
+    // Expand every frontier vertex; returns the edge count of the next frontier
+    std::uint64_t topDownStep(const CsrGraph &graph, BfsResult &result, int level, const std::vector<int> &frontier,
+                              std::vector<int> &next)
+    {
+        std::uint64_t scout = 0;
+        for (int u : frontier)
+        {
+            result.edgesExamined += graph.degree(u);
+            for (int v : graph.neighbors(u))
+            {
+                if (result.parent[v] < 0)
+                {
+                    result.parent[v] = u;
+                    result.depth[v] = level + 1;
+                    next.push_back(v);
+                    scout += graph.degree(v);
+                }
+            }
+        }
+        result.reached += next.size();
+        result.topDownSteps++;
+        return scout;
+    }
+
+    // Every unvisited vertex takes the first in-neighbor found in the frontier;
+    // returns the size of the next frontier
+    std::size_t bottomUpStep(const CsrGraph &incoming, BfsResult &result, int level, const Bitmap &frontier,
+                             Bitmap &next)
+    {
+        std::size_t awake = 0;
+        for (int v = 0; v < incoming.size(); v++)
+        {
+            if (result.parent[v] >= 0)
+                continue;
+            for (int u : incoming.neighbors(v))
+            {
+                result.edgesExamined++;
+                if (frontier.get(u))
+                {
+                    result.parent[v] = u;
+                    result.depth[v] = level + 1;
+                    next.set(v);
+                    awake++;
+                    break;
+                }
+            }
+        }
+        result.reached += awake;
+        result.bottomUpSteps++;
+        return awake;
+    }
+}
+
+BfsResult GraphBfs::directionOptimizing(const CsrGraph &graph, int source, const CsrGraph *incoming, int alpha,
+                                        int beta)
+{
+    CsrGraph transpose;
+    if (!incoming)
+    {
+        if (graph.directed())
+        {
+            transpose = graph.transposed();
+            incoming = &transpose;
+        }
+        else
+        {
+            incoming = &graph;
+        }
+    }
+
+    BfsResult result;
+    start(result, graph, source);
+
+    const std::size_t vertices = static_cast<std::size_t>(graph.size());
+    std::vector<int> frontier(1, source), next;
+    Bitmap front(graph.size()), nextFront(graph.size());
+    std::uint64_t scout = graph.degree(source);
+    std::uint64_t unexplored = graph.edgeCount();
+    int level = 0;
+
+    while (!frontier.empty())
+    {
+        if (scout > unexplored / alpha)
+        {
+            // Bottom-up while the frontier is large or still growing
+            for (int v : frontier)
+                front.set(v);
+            std::size_t awake = frontier.size(), previous;
+            do
+            {
+                previous = awake;
+                awake = bottomUpStep(*incoming, result, level++, front, nextFront);
+                front.swap(nextFront);
+                nextFront.clear();
+            } while (awake >= previous || awake > vertices / beta);
+
+            frontier.clear();
+            front.collect(frontier);
+            front.clear();
+            scout = 0;
+            for (int v : frontier)
+                scout += graph.degree(v);
+        }
+        else
+        {
+            unexplored -= std::min(scout, unexplored);
+            scout = topDownStep(graph, result, level++, frontier, next);
+            frontier.swap(next);
+            next.clear();
+        }
+    }
+    return result;
+}
+
+// parent and depth of a vertex are written only by the thread that claimed
+// it, and read after the level's tasks have been joined
+BfsResult GraphBfs::parallel(const CsrGraph &graph, int source, WorkStealingPool &pool)
+{
+    BfsResult result;
+    start(result, graph, source);
+    AtomicBitmap visited(graph.size());
+    visited.claim(source);
+
+    std::vector<int> frontier(1, source), next;
+    std::vector<std::vector<int> > found; // next-frontier buffer of each chunk
+    std::vector<std::uint64_t> examined;
+    std::vector<std::size_t> position;
+    for (int level = 0; !frontier.empty(); level++)
+    {
+        const std::size_t size = frontier.size();
+        const int chunks = static_cast<int>(
+            std::max<std::size_t>(1, std::min<std::size_t>(size / PARALLEL_GRAIN, 8 * pool.size())));
+        found.resize(std::max<std::size_t>(found.size(), chunks));
+        examined.assign(chunks, 0);
+
+        auto expand = [&](int c)
+        {
+            std::vector<int> &out = found[c];
+            out.clear();
+            std::uint64_t edges = 0;
+            for (std::size_t i = size * c / chunks; i < size * (c + 1) / chunks; i++)
+            {
+                int u = frontier[i];
+                edges += graph.degree(u);
+                for (int v : graph.neighbors(u))
+                {
+                    if (visited.claim(v))
+                    {
+                        result.parent[v] = u;
+                        result.depth[v] = level + 1;
+                        out.push_back(v);
+                    }
+                }
+            }
+            examined[c] = edges;
+        };
+
+        if (chunks == 1)
+        {
+            expand(0);
+            next.swap(found[0]);
+        }
+        else
+        {
+            TaskGroup group(pool);
+            for (int c = 0; c < chunks; c++)
+            {
+                group.run([&expand, c]() { expand(c); });
+            }
+            group.wait();
+
+            // Prefix sum of the buffer sizes: where each chunk's vertices go
+            position.assign(chunks + 1, 0);
+            for (int c = 0; c < chunks; c++)
+            {
+                position[c + 1] = position[c] + found[c].size();
+            }
+            next.resize(position[chunks]);
+            for (int c = 0; c < chunks; c++)
+            {
+                group.run([&found, &next, &position, c]()
+                          { std::copy(found[c].begin(), found[c].end(), next.begin() + position[c]); });
+            }
+            group.wait();
+        }
+
+        for (int c = 0; c < chunks; c++)
+        {
+            result.edgesExamined += examined[c];
+        }
+        result.reached += next.size();
+        result.topDownSteps++;
+        frontier.swap(next);
+        next.clear();
+    }
+    return result;
+}
+
+BfsResult GraphBfs::topDown(const CsrGraph &graph, int source)
+{
+    BfsResult result;
+    start(result, graph, source);
+
+    std::vector<int> frontier(1, source), next;
+    for (int level = 0; !frontier.empty(); level++)
+    {
+        topDownStep(graph, result, level, frontier, next);
+        frontier.swap(next);
+        next.clear();
+    }
+    return result;
+}
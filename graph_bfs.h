@@ -0,0 +1,70 @@
+#ifndef GRAPH_BFS_H
+#define GRAPH_BFS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csr_graph.h"
+
+class WorkStealingPool;
+
+/**
+ * Direction-optimizing BFS for AlgoVault (Beamer, Asanovic and Patterson)
+ * A top-down step scans the edges of every frontier vertex; a bottom-up step
+ * instead lets every unvisited vertex look for a parent in the frontier and
+ * stop at the first one it finds. On low-diameter graphs the few middle
+ * levels hold most of the vertices, and there bottom-up examines a fraction
+ * of the edges top-down would. The search switches:
+ *   to bottom-up   when the frontier's edges exceed 1/ALPHA of the edges
+ *                  of the still unvisited vertices
+ *   back to top-down when the frontier shrinks below 1/BETA of the
+ *                  vertices and is no longer growing
+ * Top-down steps keep the frontier as a vertex list; bottom-up steps use
+ * dense bitmaps (one bit per vertex) for the current and next frontier, so
+ * the frontier test is one bit probe.
+ * Bottom-up needs each vertex's incoming edges: undirected graphs have them
+ * already, directed graphs use a transposed copy (built here unless given).
+ *
+ * The parallel version is level-synchronous top-down: each level's frontier
+ * is cut into chunks run on the pool, every chunk collects the vertices it
+ * discovers in its own buffer, and a prefix sum over the buffer sizes gives
+ * each one its place in the next frontier. A vertex is claimed with a
+ * compare-and-swap on a shared visited bitmap, so exactly one chunk records
+ * its parent and adds it; depths match the sequential search, parents can be
+ * any frontier neighbor.
+ */
+
+struct BfsResult
+{
+    std::vector<int> parent; // BFS tree parent, the source is its own parent, -1 unreached
+    std::vector<int> depth;  // hops from the source, -1 unreached
+    std::size_t reached;
+    int topDownSteps;
+    int bottomUpSteps;
+    std::uint64_t edgesExamined;
+
+    BfsResult() : reached(0), topDownSteps(0), bottomUpSteps(0), edgesExamined(0) {}
+};
+
+class GraphBfs
+{
+public:
+    enum
+    {
+        ALPHA = 15,           // switch to bottom-up when frontier edges > unexplored edges / ALPHA
+        BETA = 18,            // switch back when the frontier < vertices / BETA
+        PARALLEL_GRAIN = 1024 // minimum frontier vertices per parallel task
+    };
+
+    // incoming: the transpose of a directed graph, if one is at hand
+    static BfsResult directionOptimizing(const CsrGraph &graph, int source, const CsrGraph *incoming = nullptr,
+                                         int alpha = ALPHA, int beta = BETA);
+
+    // Level-synchronous BFS on all of pool's threads
+    static BfsResult parallel(const CsrGraph &graph, int source, WorkStealingPool &pool);
+
+    // Plain top-down BFS with the same result, for comparison
+    static BfsResult topDown(const CsrGraph &graph, int source);
+};
+
+#endif // GRAPH_BFS_H
@@ -0,0 +1,126 @@
+#include "graph.h"
+#include "dataset.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * The parts of Graph that need no console: construction (the CSR
+ * adjacency and its rebuilds), the quiet algorithm versions, and loading
+ * graphs from edge list and dataset files. Kept apart from graph.cpp
+ * so that tools without utils.cpp (make batch) can link them.
+ */
+
+// Constructor
+Graph::Graph(int v) : vertices(v), csr(v), weightedCsr(v), traceLog(nullptr)
+{
+}
+
+// Add edge for unweighted graph
+void Graph::addEdge(int u, int v)
+{
+    GraphEdge edge = {u, v, 1};
+    newEdges.push_back(edge); // Stored both ways (undirected) when csr is rebuilt
+}
+
+// Add weighted edge for weighted graph
+void Graph::addWeightedEdge(int u, int v, int weight)
+{
+    GraphEdge edge = {u, v, weight};
+    newWeightedEdges.push_back(edge);
+}
+
+// Copies of the dataset's offset/edge arrays, for both algorithms. Undirected
+// graphs are stored with both directions of every edge, so nothing is mirrored
+void Graph::addEdges(const DatasetGraph &graph)
+{
+    vertices = graph.vertices;
+    csr = CsrGraph(graph, true);
+    weightedCsr = csr;
+    newEdges.clear();
+    newWeightedEdges.clear();
+}
+
+// Edges added since the last build are merged in with one counting pass,
+// after the ones every vertex already has
+const CsrGraph &Graph::adjacency() const
+{
+    if (!newEdges.empty())
+    {
+        csr = CsrGraph(csr, newEdges, false, false);
+        std::vector<GraphEdge>().swap(newEdges);
+    }
+    return csr;
+}
+
+const CsrGraph &Graph::weightedAdjacency() const
+{
+    if (!newWeightedEdges.empty())
+    {
+        weightedCsr = CsrGraph(weightedCsr, newWeightedEdges, true, false);
+        std::vector<GraphEdge>().swap(newWeightedEdges);
+    }
+    return weightedCsr;
+}
+
+// ==================== EDGE LIST FILES ====================
+
+std::vector<GraphEdge> Graph::readEdgeList(const std::string &path, int &vertices)
+{
+    std::ifstream file(path.c_str());
+    if (!file)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    std::vector<GraphEdge> edges;
+    std::string line;
+    vertices = 0;
+    for (int number = 1; std::getline(file, line); number++)
+    {
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+        {
+            line.erase(comment);
+        }
+        std::istringstream words(line);
+        GraphEdge edge;
+        if (!(words >> edge.u))
+        {
+            continue; // blank line
+        }
+        if (!(words >> edge.v) || edge.u < 0 || edge.v < 0)
+        {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": expected \"u v [weight]\"");
+        }
+        if (!(words >> edge.weight))
+        {
+            edge.weight = 1;
+        }
+        else if (edge.weight < 0)
+        {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": negative weight");
+        }
+        vertices = std::max(vertices, std::max(edge.u, edge.v) + 1);
+        edges.push_back(edge);
+    }
+    return edges;
+}
+
+// ==================== QUIET ALGORITHMS ====================
+
+std::vector<int> Graph::bfsLevels(int startVertex) const
+{
+    return adjacency().bfsLevels(startVertex);
+}
+
+std::vector<int> Graph::dfsOrder(int startVertex) const
+{
+    return adjacency().dfsOrder(startVertex);
+}
+
+std::vector<std::uint64_t> Graph::shortestDistances(int startVertex) const
+{
+    return weightedAdjacency().shortestDistances(startVertex);
+}
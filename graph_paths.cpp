@@ -0,0 +1,287 @@
+#include "graph_paths.h"
+#include "graph_sssp.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+const std::uint32_t Landmarks::UNKNOWN;
+
+PathResult::PathResult() : dist(GraphSssp::UNREACHED), settled(0), touched(0)
+{
+}
+
+// ==================== LANDMARKS ====================
+
+namespace
+{
+    // Distances from one Dijkstra run, stored in column i of a vertex-major table
+    void storeColumn(std::vector<std::uint32_t> &table, int count, int i, const std::vector<std::uint64_t> &dist)
+    {
+        for (std::size_t v = 0; v < dist.size(); v++)
+        {
+            table[v * count + i] =
+                dist[v] < Landmarks::UNKNOWN ? static_cast<std::uint32_t>(dist[v]) : Landmarks::UNKNOWN;
+        }
+    }
+}
+
+Landmarks::Landmarks(const CsrGraph &graph, int count) : count(count), directed(graph.directed())
+{
+    if (count < 1)
+    {
+        throw std::invalid_argument("at least one landmark is needed");
+    }
+    const int n = graph.size();
+    if (n == 0)
+    {
+        return;
+    }
+
+    // Landmarks on the edge of the graph give the tightest bounds, so they are
+    // picked by farthest-point selection within the highest-degree vertex's reach
+    int hub = 0;
+    for (int v = 1; v < n; v++)
+    {
+        if (graph.degree(v) > graph.degree(hub))
+            hub = v;
+    }
+    const std::vector<std::uint64_t> reach = GraphSssp::dijkstra(graph, hub).dist;
+    std::vector<std::uint64_t> nearest(reach); // distance to the closest landmark so far, for the first: to hub
+
+    CsrGraph transpose;
+    if (directed)
+    {
+        transpose = graph.transposed();
+        to.assign(static_cast<std::size_t>(n) * count, UNKNOWN);
+    }
+    from.assign(static_cast<std::size_t>(n) * count, UNKNOWN);
+
+    for (int i = 0; i < count; i++)
+    {
+        int next = hub;
+        for (int v = 0; v < n; v++)
+        {
+            if (reach[v] != GraphSssp::UNREACHED && nearest[v] > nearest[next])
+                next = v;
+        }
+        landmarks.push_back(next);
+
+        const std::vector<std::uint64_t> dist = GraphSssp::dijkstra(graph, next).dist;
+        storeColumn(from, count, i, dist);
+        if (directed)
+        {
+            storeColumn(to, count, i, GraphSssp::dijkstra(transpose, next).dist);
+        }
+        for (int v = 0; v < n; v++)
+        {
+            nearest[v] = i == 0 ? dist[v] : std::min(nearest[v], dist[v]);
+        }
+    }
+}
+
+std::uint64_t Landmarks::estimate(int vertex, int target) const
+{
+    if (landmarks.empty())
+    {
+        return 0;
+    }
+    const std::uint32_t *fromV = &from[static_cast<std::size_t>(vertex) * count];
+    const std::uint32_t *fromT = &from[static_cast<std::size_t>(target) * count];
+    // Undirected: the distance to a landmark is the distance from it
+    const std::uint32_t *toV = directed ? &to[static_cast<std::size_t>(vertex) * count] : fromV;
+    const std::uint32_t *toT = directed ? &to[static_cast<std::size_t>(target) * count] : fromT;
+
+    std::uint32_t bound = 0;
+    for (int i = 0; i < count; i++)
+    {
+        // d(L, t) <= d(L, v) + d(v, t)
+        if (fromT[i] != UNKNOWN && fromV[i] != UNKNOWN && fromT[i] > fromV[i])
+            bound = std::max(bound, fromT[i] - fromV[i]);
+        // d(v, L) <= d(v, t) + d(t, L)
+        if (toV[i] != UNKNOWN && toT[i] != UNKNOWN && toV[i] > toT[i])
+            bound = std::max(bound, toV[i] - toT[i]);
+    }
+    return bound;
+}
+
+// ==================== QUERIES ====================
+
+PathFinder::Search::Search(int vertices)
+    : dist(vertices, GraphSssp::UNREACHED), parent(vertices, -1), queue(vertices)
+{
+}
+
+PathFinder::PathFinder(const CsrGraph &graph)
+    : graph(graph), forward(graph.size()), backward(graph.size()), estimates(graph.size(), GraphSssp::UNREACHED)
+{
+    if (graph.directed())
+    {
+        transpose = graph.transposed();
+    }
+}
+
+void PathFinder::checkVertices(int source, int target) const
+{
+    if (source < 0 || source >= graph.size() || target < 0 || target >= graph.size())
+    {
+        throw std::invalid_argument("vertices " + std::to_string(source) + " and " + std::to_string(target) +
+                                    " are not both in the graph's " + std::to_string(graph.size()) + " vertices");
+    }
+}
+
+void PathFinder::label(Search &search, int vertex, std::uint64_t dist, int parent)
+{
+    if (forward.dist[vertex] == GraphSssp::UNREACHED && backward.dist[vertex] == GraphSssp::UNREACHED &&
+        estimates[vertex] == GraphSssp::UNREACHED)
+    {
+        touched.push_back(vertex);
+    }
+    search.dist[vertex] = dist;
+    search.parent[vertex] = parent;
+}
+
+// Builds the path through meet (-1 when there is none) and resets what the query touched;
+// the forward parents lead from meet back to the source, the backward ones on to the target
+PathResult PathFinder::finish(PathResult &result, std::uint64_t dist, int source, int meet, int target)
+{
+    if (meet >= 0)
+    {
+        result.dist = dist;
+        for (int v = meet; v != source; v = forward.parent[v])
+        {
+            result.path.push_back(v);
+        }
+        result.path.push_back(source);
+        std::reverse(result.path.begin(), result.path.end());
+        for (int v = meet; v != target;)
+        {
+            v = backward.parent[v];
+            result.path.push_back(v);
+        }
+    }
+    result.touched = touched.size();
+
+    for (int v : touched)
+    {
+        forward.dist[v] = backward.dist[v] = GraphSssp::UNREACHED;
+        forward.parent[v] = backward.parent[v] = -1;
+        estimates[v] = GraphSssp::UNREACHED;
+    }
+    touched.clear();
+    forward.queue.clear();
+    backward.queue.clear();
+    return result;
+}
+
+PathResult PathFinder::dijkstra(int source, int target)
+{
+    checkVertices(source, target);
+    PathResult result;
+    label(forward, source, 0, source);
+    forward.queue.pushOrDecrease(0, source);
+
+    while (!forward.queue.empty())
+    {
+        std::uint64_t d;
+        int u;
+        forward.queue.pop(d, u);
+        result.settled++;
+        if (u == target)
+            break;
+
+        for (std::uint64_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); e++)
+        {
+            int v = graph.target(e);
+            std::uint64_t candidate = d + static_cast<std::uint64_t>(graph.weight(e));
+            if (candidate < forward.dist[v])
+            {
+                label(forward, v, candidate, u);
+                forward.queue.pushOrDecrease(candidate, v);
+            }
+        }
+    }
+
+    bool found = forward.dist[target] != GraphSssp::UNREACHED;
+    return finish(result, forward.dist[target], source, found ? target : -1, target);
+}
+
+PathResult PathFinder::bidirectional(int source, int target)
+{
+    checkVertices(source, target);
+    const CsrGraph &incoming = graph.directed() ? transpose : graph;
+
+    PathResult result;
+    label(forward, source, 0, source);
+    label(backward, target, 0, target);
+    forward.queue.pushOrDecrease(0, source);
+    backward.queue.pushOrDecrease(0, target);
+    std::uint64_t best = source == target ? 0 : GraphSssp::UNREACHED;
+    int meet = source == target ? source : -1;
+
+    while (!forward.queue.empty() && !backward.queue.empty() &&
+           forward.queue.topKey() + backward.queue.topKey() < best)
+    {
+        bool forwardStep = forward.queue.size() <= backward.queue.size();
+        Search &search = forwardStep ? forward : backward;
+        const Search &other = forwardStep ? backward : forward;
+        const CsrGraph &edges = forwardStep ? graph : incoming;
+
+        std::uint64_t d;
+        int u;
+        search.queue.pop(d, u);
+        result.settled++;
+        for (std::uint64_t e = edges.edgeBegin(u); e < edges.edgeEnd(u); e++)
+        {
+            int v = edges.target(e);
+            std::uint64_t candidate = d + static_cast<std::uint64_t>(edges.weight(e));
+            if (candidate < search.dist[v])
+            {
+                label(search, v, candidate, u);
+                search.queue.pushOrDecrease(candidate, v);
+            }
+            if (other.dist[v] != GraphSssp::UNREACHED && search.dist[v] + other.dist[v] < best)
+            {
+                best = search.dist[v] + other.dist[v];
+                meet = v;
+            }
+        }
+    }
+    return finish(result, best, source, meet, target);
+}
+
+PathResult PathFinder::astar(int source, int target, const PathHeuristic &heuristic)
+{
+    checkVertices(source, target);
+    PathResult result;
+    label(forward, source, 0, source);
+    estimates[source] = heuristic.estimate(source, target);
+    forward.queue.pushOrDecrease(estimates[source], source);
+
+    while (!forward.queue.empty())
+    {
+        std::uint64_t key;
+        int u;
+        forward.queue.pop(key, u);
+        result.settled++;
+        if (u == target)
+            break;
+
+        const std::uint64_t d = forward.dist[u];
+        for (std::uint64_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); e++)
+        {
+            int v = graph.target(e);
+            std::uint64_t candidate = d + static_cast<std::uint64_t>(graph.weight(e));
+            if (candidate < forward.dist[v])
+            {
+                label(forward, v, candidate, u);
+                if (estimates[v] == GraphSssp::UNREACHED)
+                    estimates[v] = heuristic.estimate(v, target);
+                // A vertex already settled is queued again if an inconsistent bound let it be settled early
+                forward.queue.pushOrDecrease(candidate + estimates[v], v);
+            }
+        }
+    }
+
+    bool found = forward.dist[target] != GraphSssp::UNREACHED;
+    return finish(result, forward.dist[target], source, found ? target : -1, target);
+}
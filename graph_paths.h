@@ -0,0 +1,115 @@
+#ifndef GRAPH_PATHS_H
+#define GRAPH_PATHS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csr_graph.h"
+#include "priority_queues.h"
+
+/**
+ * Point-to-point shortest paths for AlgoVault
+ * Dijkstra from a source settles vertices in order of distance, so a query
+ * for one target can stop as soon as the target is settled; three ways to
+ * get there sooner:
+ *   dijkstra      - plain Dijkstra that stops at the target
+ *   bidirectional - Dijkstra forward from the source and backward from the
+ *                   target (over incoming edges), always growing the
+ *                   smaller of the two; once the two smallest queued
+ *                   distances add up to the best path seen where the
+ *                   searches met, no shorter path is left. Two balls of
+ *                   half the radius cover far fewer vertices than one
+ *   astar         - Dijkstra ordered by distance + a lower bound on the
+ *                   distance left (a PathHeuristic), so vertices away from
+ *                   the target wait
+ * Landmarks is the ALT heuristic (A*, landmarks, triangle inequality): the
+ * distances from (and, on directed graphs, to) a few far-apart landmark
+ * vertices are computed once by full Dijkstra runs; for every landmark L,
+ * d(L, t) - d(L, v) and d(v, L) - d(t, L) are lower bounds on d(v, t).
+ * A PathFinder keeps its per-vertex arrays between queries and resets only
+ * the vertices a query touched, so a query costs what it explores, not
+ * the size of the graph.
+ */
+
+struct PathResult
+{
+    std::uint64_t dist;    // GraphSssp::UNREACHED when there is no path
+    std::vector<int> path; // source .. target, empty when there is no path
+    std::size_t settled;   // vertices taken from the queue(s)
+    std::size_t touched;   // vertices given a tentative distance
+
+    PathResult();
+};
+
+// A lower bound on the distance from a vertex to the target. A* finds
+// shortest paths with any bound that never overestimates; when it is also
+// consistent (estimate(u) <= w(u, v) + estimate(v)) no vertex is settled twice
+class PathHeuristic
+{
+public:
+    virtual ~PathHeuristic() {}
+    virtual std::uint64_t estimate(int vertex, int target) const = 0;
+};
+
+class Landmarks : public PathHeuristic
+{
+public:
+    enum
+    {
+        DEFAULT_COUNT = 8 // landmarks; each costs a Dijkstra run (two on directed graphs) and 4 bytes per vertex
+    };
+
+    static const std::uint32_t UNKNOWN = 0xFFFFFFFFu; // unreachable, or too far for 32 bits
+
+    // The first landmark is the vertex farthest from the highest-degree vertex,
+    // each next one the vertex farthest from all landmarks chosen so far
+    explicit Landmarks(const CsrGraph &graph, int count = DEFAULT_COUNT);
+
+    std::uint64_t estimate(int vertex, int target) const;
+    const std::vector<int> &vertices() const { return landmarks; }
+
+private:
+    int count;
+    bool directed;
+    std::vector<int> landmarks;
+    std::vector<std::uint32_t> from; // from[v * count + i]: distance from landmark i to v
+    std::vector<std::uint32_t> to;   // directed graphs: distance from v to landmark i
+};
+
+class PathFinder
+{
+public:
+    // graph must outlive the finder; for a directed graph it also keeps the
+    // transpose, the incoming edges the backward search follows
+    explicit PathFinder(const CsrGraph &graph);
+
+    PathResult dijkstra(int source, int target);
+    PathResult bidirectional(int source, int target);
+    PathResult astar(int source, int target, const PathHeuristic &heuristic);
+
+private:
+    struct Search
+    {
+        std::vector<std::uint64_t> dist;
+        std::vector<int> parent; // the source (or target, searching backward) is its own
+        IndexedDaryHeap queue;
+
+        explicit Search(int vertices);
+    };
+
+    const CsrGraph &graph;
+    CsrGraph transpose;
+    Search forward;
+    Search backward;
+    std::vector<std::uint64_t> estimates; // A*: heuristic of each vertex, computed once per query
+    std::vector<int> touched;
+
+    PathFinder(const PathFinder &);
+    PathFinder &operator=(const PathFinder &);
+
+    void checkVertices(int source, int target) const;
+    void label(Search &search, int vertex, std::uint64_t dist, int parent);
+    PathResult finish(PathResult &result, std::uint64_t dist, int source, int meet, int target);
+};
+
+#endif // GRAPH_PATHS_H
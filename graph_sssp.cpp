@@ -0,0 +1,498 @@
+#include "graph_sssp.h"
+#include "priority_queues.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+
+const std::uint64_t GraphSssp::UNREACHED;
+
+namespace
+{
+    // BucketQueue and RadixHeap take a vertex again under its new distance;
+    // the heap lowers the key it already has
+    void enqueue(BucketQueue &queue, std::uint64_t key, int vertex) { queue.push(key, vertex); }
+    void enqueue(RadixHeap &queue, std::uint64_t key, int vertex) { queue.push(key, vertex); }
+    void enqueue(IndexedDaryHeap &queue, std::uint64_t key, int vertex) { queue.pushOrDecrease(key, vertex); }
+
+    template <typename Queue>
+    void search(const CsrGraph &graph, int source, Queue &queue, SsspResult &result)
+    {
+        result.dist.assign(graph.size(), GraphSssp::UNREACHED);
+        result.parent.assign(graph.size(), -1);
+        result.dist[source] = 0;
+        result.parent[source] = source;
+        enqueue(queue, 0, source);
+
+        while (!queue.empty())
+        {
+            std::uint64_t d;
+            int u;
+            queue.pop(d, u);
+            if (d != result.dist[u])
+            {
+                result.stalePops++;
+                continue;
+            }
+
+            result.reached++;
+            for (std::uint64_t e = graph.edgeBegin(u); e < graph.edgeEnd(u); e++)
+            {
+                int v = graph.target(e);
+                int w = graph.weight(e);
+                if (w < 0)
+                {
+                    throw std::invalid_argument("negative edge weight " + std::to_string(w));
+                }
+                std::uint64_t candidate = d + static_cast<std::uint64_t>(w);
+                if (candidate < result.dist[v])
+                {
+                    result.dist[v] = candidate;
+                    result.parent[v] = u;
+                    result.relaxations++;
+                    enqueue(queue, candidate, v);
+                }
+            }
+        }
+    }
+}
+
+namespace
+{
+    // body(c) for c = 0 .. chunks - 1 on the pool, or on the calling thread when chunks is 1
+    template <typename Body>
+    void forEachChunk(WorkStealingPool &pool, int chunks, const Body &body)
+    {
+        if (chunks == 1)
+        {
+            body(0);
+            return;
+        }
+        TaskGroup group(pool);
+        for (int c = 0; c < chunks; c++)
+        {
+            group.run([&body, c]() { body(c); });
+        }
+        group.wait();
+    }
+
+    int chunksFor(std::size_t items, int slots)
+    {
+        return static_cast<int>(
+            std::max<std::size_t>(1, std::min<std::size_t>(items / GraphSssp::PARALLEL_GRAIN, slots)));
+    }
+
+    // A vertex in a bucket, with the distance it was put there under
+    struct BucketEntry
+    {
+        int vertex;
+        std::uint64_t dist;
+    };
+
+    struct WeightedEdge
+    {
+        int target;
+        int weight;
+    };
+
+    // A relaxation that lowered a distance: vertex's distance became dist through from
+    struct Lowering
+    {
+        int vertex;
+        int from;
+        std::uint64_t dist;
+    };
+
+    class DeltaStepping
+    {
+    public:
+        DeltaStepping(const CsrGraph &graph, WorkStealingPool &pool, std::uint64_t delta, int largestWeight,
+                      SsspResult &result);
+
+        void run(int source);
+
+    private:
+        const CsrGraph &graph;
+        WorkStealingPool &pool;
+        SsspResult &result;
+        const std::uint64_t delta;
+        const int slots;        // task slots, each with buckets of its own
+        const std::size_t span; // buckets in each ring: every live entry is within span of the current bucket
+
+        // The graph's edges with each vertex's light ones first: light edges
+        // of v are edgeBegin(v) .. heavyStart[v] - 1, heavy ones the rest
+        std::vector<WeightedEdge> edges;
+        std::vector<std::uint64_t> heavyStart;
+
+        std::vector<std::atomic<std::uint64_t> > dist;
+        std::vector<std::atomic<unsigned char> > lowered; // distance lowered in this phase, vertex not yet claimed
+        std::vector<std::vector<std::vector<BucketEntry> > > buckets; // [slot][bucket % span]
+        std::vector<std::vector<Lowering> > lowerings;                // per slot, this phase's
+        std::vector<std::uint64_t> relaxations;                       // per slot
+        std::vector<BucketEntry> frontier, settled;
+        std::vector<std::size_t> position;
+
+        void splitEdges();
+        bool gather(std::uint64_t bucket);
+        void relax(const std::vector<BucketEntry> &from, bool light);
+    };
+
+    DeltaStepping::DeltaStepping(const CsrGraph &graph, WorkStealingPool &pool, std::uint64_t delta,
+                                 int largestWeight, SsspResult &result)
+        : graph(graph), pool(pool), result(result), delta(delta), slots(4 * pool.size()),
+          span(static_cast<std::size_t>(largestWeight / delta) + 2), edges(graph.edgeCount()),
+          heavyStart(graph.size()), dist(graph.size()), lowered(graph.size()),
+          buckets(slots, std::vector<std::vector<BucketEntry> >(span)), lowerings(slots), relaxations(slots, 0)
+    {
+    }
+
+    // A phase then reads only the edges it relaxes
+    void DeltaStepping::splitEdges()
+    {
+        const std::size_t n = heavyStart.size();
+        const int chunks = chunksFor(n, slots);
+        forEachChunk(pool, chunks, [this, n, chunks](int c)
+                     {
+                         for (std::size_t v = n * c / chunks; v < n * (c + 1) / chunks; v++)
+                         {
+                             std::uint64_t light = graph.edgeBegin(static_cast<int>(v));
+                             std::uint64_t heavy = graph.edgeEnd(static_cast<int>(v));
+                             for (std::uint64_t e = light; e < graph.edgeEnd(static_cast<int>(v)); e++)
+                             {
+                                 WeightedEdge edge = {graph.target(e), graph.weight(e)};
+                                 if (static_cast<std::uint64_t>(edge.weight) <= delta)
+                                     edges[light++] = edge;
+                                 else
+                                     edges[--heavy] = edge;
+                             }
+                             heavyStart[v] = light;
+                             dist[v].store(GraphSssp::UNREACHED, std::memory_order_relaxed);
+                             lowered[v].store(0, std::memory_order_relaxed);
+                         }
+                     });
+    }
+
+    void DeltaStepping::run(int source)
+    {
+        const std::size_t n = dist.size();
+        const int chunks = chunksFor(n, slots);
+        splitEdges();
+        result.parent.assign(n, -1);
+        result.parent[source] = source;
+        dist[source].store(0);
+        BucketEntry start = {source, 0};
+        buckets[0][0].push_back(start);
+
+        std::uint64_t bucket = 0;
+        for (;;)
+        {
+            // Light edges until the bucket stays empty, then the heavy edges of everything it held
+            while (gather(bucket))
+            {
+                settled.insert(settled.end(), frontier.begin(), frontier.end());
+                relax(frontier, true);
+            }
+            if (!settled.empty())
+            {
+                relax(settled, false);
+                settled.clear();
+            }
+
+            std::size_t step = 1;
+            while (step < span && std::none_of(buckets.begin(), buckets.end(),
+                                               [&](const std::vector<std::vector<BucketEntry> > &ring)
+                                               { return !ring[(bucket + step) % span].empty(); }))
+            {
+                step++;
+            }
+            if (step == span)
+                break;
+            bucket += step;
+        }
+
+        result.dist.resize(n);
+        std::vector<std::size_t> reached(chunks, 0);
+        forEachChunk(pool, chunks, [this, n, chunks, &reached](int c)
+                     {
+                         for (std::size_t v = n * c / chunks; v < n * (c + 1) / chunks; v++)
+                         {
+                             result.dist[v] = dist[v].load(std::memory_order_relaxed);
+                             if (result.dist[v] != GraphSssp::UNREACHED)
+                                 reached[c]++;
+                         }
+                     });
+        for (int c = 0; c < chunks; c++)
+        {
+            result.reached += reached[c];
+        }
+        for (int c = 0; c < slots; c++)
+        {
+            result.relaxations += relaxations[c];
+        }
+    }
+
+    // Moves the bucket's entries from every slot into frontier, dropping the
+    // ones whose vertex has since been put in a bucket under a lower distance
+    bool DeltaStepping::gather(std::uint64_t bucket)
+    {
+        const std::size_t ring = bucket % span;
+        std::size_t total = 0;
+        for (int c = 0; c < slots; c++)
+        {
+            total += buckets[c][ring].size();
+        }
+        const int chunks = total < GraphSssp::PARALLEL_GRAIN ? 1 : slots;
+        auto eachSlot = [&](const std::function<void(int)> &body)
+        {
+            if (chunks == 1)
+            {
+                for (int c = 0; c < slots; c++)
+                    body(c);
+            }
+            else
+            {
+                forEachChunk(pool, chunks, body);
+            }
+        };
+
+        eachSlot([this, ring](int c)
+                 {
+                     std::vector<BucketEntry> &entries = buckets[c][ring];
+                     entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                                  [this](const BucketEntry &entry)
+                                                  {
+                                                      return entry.dist !=
+                                                             dist[entry.vertex].load(std::memory_order_relaxed);
+                                                  }),
+                                   entries.end());
+                 });
+
+        // Prefix sum of what is left: where each slot's entries go
+        position.assign(slots + 1, 0);
+        for (int c = 0; c < slots; c++)
+        {
+            position[c + 1] = position[c] + buckets[c][ring].size();
+        }
+        frontier.resize(position[slots]);
+        eachSlot([this, ring](int c)
+                 {
+                     std::vector<BucketEntry> &entries = buckets[c][ring];
+                     std::copy(entries.begin(), entries.end(), frontier.begin() + position[c]);
+                     entries.clear();
+                 });
+        return !frontier.empty();
+    }
+
+    // One phase over the light (weight <= delta) or heavy edges of from's
+    // vertices, at the distances they were bucketed under. The first pass
+    // lowers distances with a compare-and-swap minimum and keeps a record of
+    // every relaxation that did; then one of the records that produced a
+    // vertex's final distance for the phase claims the vertex, so each
+    // lowered vertex gets one parent and one bucket entry. Heavy edges only
+    // reach later buckets, so in the heavy phase the distances of from's
+    // vertices cannot change, and entries made stale by an earlier light
+    // phase are skipped
+    void DeltaStepping::relax(const std::vector<BucketEntry> &from, bool light)
+    {
+        const std::size_t n = from.size();
+        const int chunks = chunksFor(n, slots);
+
+        forEachChunk(pool, chunks, [this, &from, light, n, chunks](int c)
+                     {
+                         std::vector<Lowering> &records = lowerings[c];
+                         for (std::size_t i = n * c / chunks; i < n * (c + 1) / chunks; i++)
+                         {
+                             const BucketEntry &u = from[i];
+                             if (!light && u.dist != dist[u.vertex].load(std::memory_order_relaxed))
+                                 continue;
+                             std::uint64_t first = light ? graph.edgeBegin(u.vertex) : heavyStart[u.vertex];
+                             std::uint64_t last = light ? heavyStart[u.vertex] : graph.edgeEnd(u.vertex);
+                             for (std::uint64_t e = first; e < last; e++)
+                             {
+                                 int v = edges[e].target;
+                                 std::uint64_t candidate = u.dist + static_cast<std::uint64_t>(edges[e].weight);
+                                 std::uint64_t old = dist[v].load(std::memory_order_relaxed);
+                                 while (candidate < old)
+                                 {
+                                     if (dist[v].compare_exchange_weak(old, candidate, std::memory_order_relaxed))
+                                     {
+                                         lowered[v].store(1, std::memory_order_relaxed);
+                                         Lowering record = {v, u.vertex, candidate};
+                                         records.push_back(record);
+                                         break;
+                                     }
+                                 }
+                             }
+                         }
+                     });
+
+        forEachChunk(pool, chunks, [this](int c)
+                     {
+                         std::vector<Lowering> &records = lowerings[c];
+                         for (const Lowering &record : records)
+                         {
+                             int v = record.vertex;
+                             if (record.dist == dist[v].load(std::memory_order_relaxed) &&
+                                 lowered[v].load(std::memory_order_relaxed) &&
+                                 lowered[v].exchange(0, std::memory_order_relaxed))
+                             {
+                                 result.parent[v] = record.from;
+                                 BucketEntry entry = {v, record.dist};
+                                 buckets[c][(record.dist / delta) % span].push_back(entry);
+                             }
+                         }
+                         relaxations[c] += records.size();
+                         records.clear();
+                     });
+        result.phases++;
+    }
+}
+
+SsspResult GraphSssp::dijkstra(const CsrGraph &graph, int source, QueueKind queue)
+{
+    if (source < 0 || source >= graph.size())
+    {
+        throw std::invalid_argument("source vertex " + std::to_string(source) + " is not in the graph");
+    }
+
+    // Only the buckets (and choosing them) need the largest weight, which is a
+    // pass over every edge; search itself rejects negative weights
+    int largest = 0;
+    if (queue == QUEUE_AUTO || queue == QUEUE_BUCKETS)
+    {
+        largest = maxWeight(graph);
+    }
+    if (queue == QUEUE_AUTO)
+    {
+        queue = largest <= BUCKET_MAX_WEIGHT ? QUEUE_BUCKETS : QUEUE_RADIX;
+    }
+    else if (queue == QUEUE_BUCKETS && largest > BUCKET_MAX_WEIGHT)
+    {
+        throw std::invalid_argument("edge weight " + std::to_string(largest) + " is too large for Dial's buckets " +
+                                    "(at most " + std::to_string(BUCKET_MAX_WEIGHT) + "); use the radix heap");
+    }
+
+    SsspResult result;
+    if (queue == QUEUE_BUCKETS)
+    {
+        BucketQueue buckets(largest);
+        search(graph, source, buckets, result);
+    }
+    else if (queue == QUEUE_RADIX)
+    {
+        RadixHeap heap;
+        search(graph, source, heap, result);
+    }
+    else
+    {
+        IndexedDaryHeap heap(graph.size());
+        search(graph, source, heap, result);
+    }
+    return result;
+}
+
+SsspResult GraphSssp::deltaStepping(const CsrGraph &graph, int source, WorkStealingPool &pool, std::uint64_t delta)
+{
+    if (source < 0 || source >= graph.size())
+    {
+        throw std::invalid_argument("source vertex " + std::to_string(source) + " is not in the graph");
+    }
+
+    // Largest weight, scanned in parallel as it is a pass over every edge
+    int largest = 1;
+    if (graph.weighted())
+    {
+        const std::uint64_t edges = graph.edgeCount();
+        const int chunks = chunksFor(static_cast<std::size_t>(edges / 64), 4 * pool.size());
+        std::vector<int> lowest(chunks, 0), highest(chunks, 0);
+        forEachChunk(pool, chunks, [&](int c)
+                     {
+                         for (std::uint64_t e = edges * c / chunks; e < edges * (c + 1) / chunks; e++)
+                         {
+                             lowest[c] = std::min(lowest[c], graph.weight(e));
+                             highest[c] = std::max(highest[c], graph.weight(e));
+                         }
+                     });
+        if (*std::min_element(lowest.begin(), lowest.end()) < 0)
+        {
+            throw std::invalid_argument("negative edge weight " +
+                                        std::to_string(*std::min_element(lowest.begin(), lowest.end())));
+        }
+        largest = *std::max_element(highest.begin(), highest.end());
+    }
+    if (delta == 0)
+    {
+        delta = chooseDelta(graph, largest);
+    }
+    delta = std::max<std::uint64_t>(delta, static_cast<std::uint64_t>(largest / MAX_BUCKET_SPAN));
+
+    SsspResult result;
+    DeltaStepping(graph, pool, delta, largest, result).run(source);
+    return result;
+}
+
+// The weight that about LIGHT_EDGES of an average vertex's edges do not
+// exceed, from an even sample of the edges; at least largestWeight / MAX_BUCKET_SPAN
+std::uint64_t GraphSssp::chooseDelta(const CsrGraph &graph, int largestWeight)
+{
+    const std::uint64_t edges = graph.edgeCount();
+    if (!graph.weighted() || edges == 0 || largestWeight <= 1)
+    {
+        return 1;
+    }
+
+    const std::uint64_t stride = std::max<std::uint64_t>(1, edges / DELTA_SAMPLES);
+    std::vector<int> sample;
+    for (std::uint64_t e = 0; e < edges; e += stride)
+    {
+        sample.push_back(graph.weight(e));
+    }
+    double averageDegree = static_cast<double>(edges) / std::max(1, graph.size());
+    double lightShare = std::min(1.0, LIGHT_EDGES / averageDegree);
+    std::size_t k = std::min(sample.size() - 1, static_cast<std::size_t>(lightShare * sample.size()));
+    std::nth_element(sample.begin(), sample.begin() + k, sample.end());
+
+    return static_cast<std::uint64_t>(std::max(std::max(1, sample[k]), largestWeight / MAX_BUCKET_SPAN));
+}
+
+GraphSssp::QueueKind GraphSssp::chooseQueue(const CsrGraph &graph)
+{
+    return maxWeight(graph) <= BUCKET_MAX_WEIGHT ? QUEUE_BUCKETS : QUEUE_RADIX;
+}
+
+const char *GraphSssp::queueName(QueueKind queue)
+{
+    switch (queue)
+    {
+    case QUEUE_AUTO:
+        return "auto";
+    case QUEUE_BUCKETS:
+        return "buckets";
+    case QUEUE_RADIX:
+        return "radix heap";
+    case QUEUE_HEAP:
+        return "4-ary heap";
+    }
+    return "unknown";
+}
+
+int GraphSssp::maxWeight(const CsrGraph &graph)
+{
+    if (!graph.weighted())
+    {
+        return 1;
+    }
+    int largest = 0;
+    for (std::uint64_t e = 0; e < graph.edgeCount(); e++)
+    {
+        int w = graph.weight(e);
+        if (w < 0)
+        {
+            throw std::invalid_argument("negative edge weight " + std::to_string(w));
+        }
+        if (w > largest)
+            largest = w;
+    }
+    return largest;
+}
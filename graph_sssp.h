@@ -0,0 +1,92 @@
+#ifndef GRAPH_SSSP_H
+#define GRAPH_SSSP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "csr_graph.h"
+
+class WorkStealingPool;
+
+/**
+ * Single-source shortest paths for AlgoVault's integer-weighted graphs
+ * Dijkstra's algorithm over one of the integer queues of priority_queues.h
+ * in place of a std::priority_queue, whose O(log E) operations and
+ * duplicate entries dominate on large graphs:
+ *   QUEUE_BUCKETS - Dial's buckets, for small weights (road lengths,
+ *                   latencies): constant time per operation; one bucket per
+ *                   weight, so weights above BUCKET_MAX_WEIGHT are rejected
+ *   QUEUE_RADIX   - radix heap, for any weights
+ *   QUEUE_HEAP    - indexed 4-ary heap with decrease-key: each vertex is
+ *                   in the queue at most once
+ *   QUEUE_AUTO    - buckets when the largest weight is at most
+ *                   BUCKET_MAX_WEIGHT, the radix heap otherwise
+ * Weights must not be negative. Distances are 64-bit, so long paths of
+ * large weights do not overflow.
+ *
+ * deltaStepping (Meyer and Sanders) is the parallel version: vertices are
+ * kept in buckets of distances DELTA wide, and the lowest bucket is emptied
+ * in phases that relax the light edges (weight <= DELTA) of all of its
+ * vertices at once, on all threads, until no vertex falls back into it;
+ * then the heavy edges of every vertex it held are relaxed once, as they
+ * can only reach later buckets. Distances are lowered with an atomic
+ * compare-and-swap minimum. Each phase reads the distances its vertices had
+ * when it started, and a second pass over the same edges lets one of the
+ * relaxations that set a vertex's new distance claim it, record its parent
+ * and put it in its bucket (each task into buckets of its own, joined by a
+ * prefix sum). The distances are the ones dijkstra finds. DELTA defaults to
+ * the weight below which about LIGHT_EDGES edges of an average vertex fall:
+ * smaller means more, thinner phases, larger means vertices are settled
+ * more than once.
+ */
+
+struct SsspResult
+{
+    std::vector<std::uint64_t> dist; // GraphSssp::UNREACHED where unreachable
+    std::vector<int> parent;         // previous vertex on a shortest path, the source is its own, -1 unreached
+    std::size_t reached;
+    std::uint64_t relaxations; // edges that lowered a distance
+    std::uint64_t stalePops;   // entries skipped because their vertex had been reached by a shorter path
+    int phases;                // deltaStepping: parallel relaxation rounds
+
+    SsspResult() : reached(0), relaxations(0), stalePops(0), phases(0) {}
+};
+
+class GraphSssp
+{
+public:
+    enum QueueKind
+    {
+        QUEUE_AUTO,
+        QUEUE_BUCKETS,
+        QUEUE_RADIX,
+        QUEUE_HEAP
+    };
+
+    enum
+    {
+        BUCKET_MAX_WEIGHT = 1 << 12, // largest weight the buckets take (and QUEUE_AUTO picks them for)
+        LIGHT_EDGES = 2,             // deltaStepping: light edges per average vertex the default DELTA aims at
+        DELTA_SAMPLES = 1 << 16,     // edge weights sampled to choose DELTA
+        MAX_BUCKET_SPAN = 1024,      // DELTA is at least the largest weight / MAX_BUCKET_SPAN
+        PARALLEL_GRAIN = 256         // minimum vertices per parallel task
+    };
+
+    static const std::uint64_t UNREACHED = ~std::uint64_t(0);
+
+    static SsspResult dijkstra(const CsrGraph &graph, int source, QueueKind queue = QUEUE_AUTO);
+
+    // delta: bucket width, 0 to choose it with chooseDelta (raised to largest weight / MAX_BUCKET_SPAN)
+    static SsspResult deltaStepping(const CsrGraph &graph, int source, WorkStealingPool &pool,
+                                    std::uint64_t delta = 0);
+    static std::uint64_t chooseDelta(const CsrGraph &graph, int largestWeight);
+
+    // The queue QUEUE_AUTO stands for on this graph
+    static QueueKind chooseQueue(const CsrGraph &graph);
+    static const char *queueName(QueueKind queue);
+
+    // Largest edge weight (1 for unweighted graphs); throws on negative weights
+    static int maxWeight(const CsrGraph &graph);
+};
+
+#endif // GRAPH_SSSP_H
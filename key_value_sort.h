@@ -0,0 +1,194 @@
+#ifndef KEY_VALUE_SORT_H
+#define KEY_VALUE_SORT_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include "sort_engine.h"
+
+/**
+ * Argsort and key/payload sorting for AlgoVault
+ *   argsort - the permutation that stably sorts a range: perm[i] is the
+ *             position of the element that belongs at i
+ *   sort    - sorts a key column and reorders a payload column with it
+ *             (structure-of-arrays: keys[i] goes with values[i])
+ * Only compact (key, 32-bit index) pairs move during the sort, through
+ * SortEngine::stableSort, so integer and floating-point keys are radix
+ * sorted and everything else is merge sorted. Payloads are touched once at
+ * the end, when the permutation is applied by a single gather, instead of
+ * once per radix pass or merge level. Both are stable: equal keys keep
+ * their input order.
+ */
+
+class KeyValueSort
+{
+public:
+    // Index permutation that stably sorts [first, last) by comp(proj(a), proj(b));
+    // the range itself is left as it is (its keys are copied)
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static std::vector<std::size_t> argsort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Sort keys [keysFirst, keysLast) and move the payloads starting at
+    // values to the same positions
+    template <typename KeyIter, typename ValueIter, typename Compare = SortLess>
+    static void sort(KeyIter keysFirst, KeyIter keysLast, ValueIter values, Compare comp = Compare());
+    template <typename Key, typename Value, typename Compare = SortLess>
+    static void sort(std::vector<Key> &keys, std::vector<Value> &values, Compare comp = Compare());
+
+    // Reorder [first, first + perm.size()) so that element i becomes the old
+    // element perm[i] (one gather into a buffer, then one move back)
+    template <typename Iter, typename Index>
+    static void applyPermutation(Iter first, const std::vector<Index> &perm);
+    template <typename Value, typename Index>
+    static void applyPermutation(std::vector<Value> &values, const std::vector<Index> &perm);
+
+private:
+    // What the sort moves around: a key and the position it came from
+    template <typename Key>
+    struct KeyIndex
+    {
+        Key key;
+        std::uint32_t index;
+    };
+
+    struct KeyOf
+    {
+        template <typename Key>
+        const Key &operator()(const KeyIndex<Key> &pair) const
+        {
+            return pair.key;
+        }
+    };
+
+    // The kernels index with int, so that bounds every range here too
+    static void checkSize(std::size_t n)
+    {
+        if (n > static_cast<std::size_t>(std::numeric_limits<int>::max()))
+            throw std::length_error("KeyValueSort: range too large");
+    }
+
+    // Moves a key out of the caller's range into its pair
+    struct TakeKey
+    {
+        template <typename Key>
+        Key &&operator()(Key &key) const
+        {
+            return std::move(key);
+        }
+    };
+
+    // (key, index) pairs for [first, last), sorted by key
+    template <typename Key, typename Iter, typename Fetch, typename Compare>
+    static std::vector<KeyIndex<Key> > sortedPairs(Iter first, Iter last, Fetch &fetch, Compare &comp);
+
+    // Sort the keys in place and return where each one came from
+    template <typename KeyIter, typename Compare>
+    static std::vector<std::uint32_t> sortKeys(KeyIter first, KeyIter last, Compare &comp);
+
+    template <typename Iter, typename Index>
+    static void gather(Iter first, const std::vector<Index> &perm,
+                       std::vector<typename std::iterator_traits<Iter>::value_type> &buffer);
+};
+
+// ==================== ARGSORT ====================
+
+template <typename Key, typename Iter, typename Fetch, typename Compare>
+std::vector<KeyValueSort::KeyIndex<Key> > KeyValueSort::sortedPairs(Iter first, Iter last, Fetch &fetch,
+                                                                      Compare &comp)
+{
+    std::size_t n = last - first;
+    checkSize(n);
+
+    std::vector<KeyIndex<Key> > pairs;
+    pairs.reserve(n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        KeyIndex<Key> pair = {fetch(first[i]), static_cast<std::uint32_t>(i)};
+        pairs.push_back(std::move(pair));
+    }
+    SortEngine::stableSort(pairs.begin(), pairs.end(), comp, KeyOf());
+    return pairs;
+}
+
+template <typename Iter, typename Compare, typename Projection>
+std::vector<std::size_t> KeyValueSort::argsort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    std::vector<KeyIndex<typename SortKey<Iter, Projection>::Type> > pairs =
+        sortedPairs<typename SortKey<Iter, Projection>::Type>(first, last, proj, comp);
+
+    std::vector<std::size_t> perm(pairs.size());
+    for (std::size_t i = 0; i < perm.size(); i++)
+        perm[i] = pairs[i].index;
+    return perm;
+}
+
+// ==================== KEY/PAYLOAD SORT ====================
+
+template <typename KeyIter, typename Compare>
+std::vector<std::uint32_t> KeyValueSort::sortKeys(KeyIter first, KeyIter last, Compare &comp)
+{
+    typedef typename std::iterator_traits<KeyIter>::value_type Key;
+
+    TakeKey take;
+    std::vector<KeyIndex<Key> > pairs = sortedPairs<Key>(first, last, take, comp);
+
+    std::vector<std::uint32_t> perm(pairs.size());
+    for (std::size_t i = 0; i < perm.size(); i++)
+    {
+        first[i] = std::move(pairs[i].key);
+        perm[i] = pairs[i].index;
+    }
+    return perm;
+}
+
+template <typename KeyIter, typename ValueIter, typename Compare>
+void KeyValueSort::sort(KeyIter keysFirst, KeyIter keysLast, ValueIter values, Compare comp)
+{
+    applyPermutation(values, sortKeys(keysFirst, keysLast, comp));
+}
+
+// The gathered payloads replace the vector's storage instead of being moved back
+template <typename Key, typename Value, typename Compare>
+void KeyValueSort::sort(std::vector<Key> &keys, std::vector<Value> &values, Compare comp)
+{
+    if (values.size() != keys.size())
+        throw std::invalid_argument("KeyValueSort: keys and values differ in length");
+    applyPermutation(values, sortKeys(keys.begin(), keys.end(), comp));
+}
+
+// ==================== PERMUTATIONS ====================
+
+template <typename Iter, typename Index>
+void KeyValueSort::gather(Iter first, const std::vector<Index> &perm,
+                          std::vector<typename std::iterator_traits<Iter>::value_type> &buffer)
+{
+    std::size_t n = perm.size();
+    buffer.reserve(n);
+    for (std::size_t i = 0; i < n; i++)
+        buffer.push_back(std::move(first[perm[i]]));
+}
+
+template <typename Iter, typename Index>
+void KeyValueSort::applyPermutation(Iter first, const std::vector<Index> &perm)
+{
+    std::vector<typename std::iterator_traits<Iter>::value_type> buffer;
+    gather(first, perm, buffer);
+    std::move(buffer.begin(), buffer.end(), first);
+}
+
+template <typename Value, typename Index>
+void KeyValueSort::applyPermutation(std::vector<Value> &values, const std::vector<Index> &perm)
+{
+    if (perm.size() != values.size())
+        throw std::invalid_argument("KeyValueSort: permutation and values differ in length");
+
+    std::vector<Value> buffer;
+    gather(values.begin(), perm, buffer);
+    values.swap(buffer);
+}
+
+#endif // KEY_VALUE_SORT_H
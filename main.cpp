@@ -6,6 +6,7 @@
 #include "utils.h"
 #include "sorting.h"
 #include "graph.h"
+#include "batch_runner.h"
 
 /**
  * AlgoVault - Interactive Algorithm Visualizer
@@ -63,7 +64,7 @@ void AlgoVault::showWelcomeMessage()
 
     Utils::setColor(LIGHT_GREEN);
     std::cout << "Features:" << std::endl;
-    std::cout << "• Sorting Algorithms: Bubble, Quick, Merge, Heap Sort" << std::endl;
+    std::cout << "• Sorting Algorithms: Bubble, Quick, Merge, Heap, Radix, Auto, External Sort" << std::endl;
     std::cout << "• Graph Algorithms: BFS, DFS, Dijkstra's Shortest Path" << std::endl;
     std::cout << "• Step-by-step visualization with color-coded output" << std::endl;
     std::cout << "• Time & Space complexity analysis" << std::endl;
@@ -87,11 +88,15 @@ void AlgoVault::showMainMenu()
     std::cout << "│      • Quick Sort                           │" << std::endl;
     std::cout << "│      • Merge Sort                           │" << std::endl;
     std::cout << "│      • Heap Sort                            │" << std::endl;
+    std::cout << "│      • Radix Sort                           │" << std::endl;
+    std::cout << "│      • Auto Sort                            │" << std::endl;
+    std::cout << "│      • External Sort                        │" << std::endl;
     std::cout << "├─────────────────────────────────────────────┤" << std::endl;
     std::cout << "│  2. 🕸️  Graph Algorithms                    │" << std::endl;
     std::cout << "│      • Breadth-First Search (BFS)          │" << std::endl;
     std::cout << "│      • Depth-First Search (DFS)            │" << std::endl;
     std::cout << "│      • Dijkstra's Shortest Path            │" << std::endl;
+    std::cout << "│      • Point-to-Point Shortest Path        │" << std::endl;
     std::cout << "├─────────────────────────────────────────────┤" << std::endl;
     std::cout << "│  3. ℹ️  About AlgoVault                     │" << std::endl;
     std::cout << "├─────────────────────────────────────────────┤" << std::endl;
@@ -140,9 +145,10 @@ void AlgoVault::showAbout()
     std::cout << "Sorting Algorithms:" << std::endl;
     Utils::resetColor();
     std::cout << "  • Bubble Sort    - O(n²) time, O(1) space" << std::endl;
-    std::cout << "  • Quick Sort     - O(n log n) avg, O(n²) worst time, O(log n) space" << std::endl;
+    std::cout << "  • Quick Sort     - O(n log n) time (introsort), O(log n) space" << std::endl;
     std::cout << "  • Merge Sort     - O(n log n) time, O(n) space" << std::endl;
     std::cout << "  • Heap Sort      - O(n log n) time, O(1) space" << std::endl;
+    std::cout << "  • Radix Sort     - O(w/d · (n + 2^d)) time, O(n) space" << std::endl;
     std::cout << std::endl;
 
     Utils::setColor(LIGHT_GREEN);
@@ -260,8 +266,14 @@ void AlgoVault::run()
 }
 
 // Main function - Entry point of the application
-int main()
+int main(int argc, char **argv)
 {
+    // Any arguments: run headless, without the menus (see batch_runner.h)
+    if (argc > 1)
+    {
+        return BatchRunner::main(argc, argv);
+    }
+
     try
     {
         // Enable console colors and UTF-8 support
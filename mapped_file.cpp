@@ -0,0 +1,123 @@
+#include "mapped_file.h"
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string &path)
+    : path(path), view(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(NULL)
+{
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fileHandle, &size) ||
+        static_cast<std::uint64_t>(size.QuadPart) > std::numeric_limits<std::size_t>::max())
+    {
+        close();
+        throw std::runtime_error("cannot map " + path + ": too large for the address space");
+    }
+    length = static_cast<std::size_t>(size.QuadPart);
+    if (length == 0)
+    {
+        return;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle != NULL)
+    {
+        view = static_cast<const char *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (view == nullptr)
+    {
+        close();
+        throw std::runtime_error("cannot map " + path);
+    }
+}
+
+void MappedFile::close()
+{
+    if (view)
+        UnmapViewOfFile(view);
+    if (mappingHandle != NULL)
+        CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+    view = nullptr;
+    mappingHandle = NULL;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+void MappedFile::adviseSequential()
+{
+    // FILE_FLAG_SEQUENTIAL_SCAN was already given when the file was opened
+}
+
+#else
+
+MappedFile::MappedFile(const std::string &path) : path(path), view(nullptr), length(0), descriptor(-1)
+{
+    descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        throw std::runtime_error("cannot open " + path);
+    }
+
+    struct stat info;
+    if (::fstat(descriptor, &info) != 0 ||
+        static_cast<std::uint64_t>(info.st_size) > std::numeric_limits<std::size_t>::max())
+    {
+        close();
+        throw std::runtime_error("cannot map " + path + ": too large for the address space");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length == 0)
+    {
+        return;
+    }
+
+    void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (mapped == MAP_FAILED)
+    {
+        close();
+        throw std::runtime_error("cannot map " + path);
+    }
+    view = static_cast<const char *>(mapped);
+}
+
+void MappedFile::close()
+{
+    if (view)
+        ::munmap(const_cast<char *>(view), length);
+    if (descriptor >= 0)
+        ::close(descriptor);
+    view = nullptr;
+    descriptor = -1;
+}
+
+void MappedFile::adviseSequential()
+{
+    if (view)
+        ::madvise(const_cast<char *>(view), length, MADV_SEQUENTIAL);
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+/**
+ * Read-only memory-mapped file
+ * The whole file is mapped into the address space (mmap, or a file mapping
+ * view on Windows) and read in place: nothing is copied into a buffer, and
+ * the operating system pages the file in as it is touched. An empty file
+ * has a null data() and size 0. Errors throw std::runtime_error.
+ */
+
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    const char *data() const { return view; }
+    std::size_t size() const { return length; }
+    const std::string &name() const { return path; }
+
+    // Hint that the file will be read front to back (ignored where unsupported)
+    void adviseSequential();
+
+private:
+    std::string path;
+    const char *view;
+    std::size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int descriptor;
+#endif
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    void close();
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,536 @@
+#include "parallel_sort.h"
+#include "sort_engine.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+// ==================== PARALLEL MERGE SORT ====================
+
+void ParallelSort::mergeSort(std::vector<int> &arr, int threads)
+{
+    if (threads == 1 || arr.size() < static_cast<size_t>(SEQUENTIAL_THRESHOLD))
+    {
+        SortEngine::mergeSort(arr);
+        return;
+    }
+
+    WorkStealingPool pool(threads);
+    mergeSort(arr, pool);
+}
+
+void ParallelSort::mergeSort(std::vector<int> &arr, WorkStealingPool &pool)
+{
+    int n = static_cast<int>(arr.size());
+
+    // Split into 2^depth leaves, several per thread for load balance. The
+    // merges ping-pong between arr and the buffer, so depth is kept even to
+    // make the last merge land in arr without a final copy.
+    int depth = 0;
+    while ((1 << depth) < 8 * pool.size() && (n >> (depth + 2)) >= MERGE_GRAIN)
+    {
+        depth += 2;
+    }
+
+    if (pool.size() == 1 || depth == 0)
+    {
+        SortEngine::mergeSort(arr);
+        return;
+    }
+
+    std::vector<int> buffer(n);
+    mergeSortTask(arr, buffer.data(), 0, n, depth, pool);
+}
+
+// Sort arr[lo, hi); the result ends up in arr when depth is even and in
+// buffer when it is odd. Leaves (depth 0) are sorted in arr.
+void ParallelSort::mergeSortTask(std::vector<int> &arr, int *buffer, int lo, int hi,
+                                 int depth, WorkStealingPool &pool)
+{
+    if (depth == 0)
+    {
+        NullTracer tracer;
+        SortEngine::mergeSort(arr, lo, hi - 1, tracer);
+        return;
+    }
+
+    int mid = lo + (hi - lo) / 2;
+    {
+        TaskGroup group(pool);
+        group.run([&arr, buffer, lo, mid, depth, &pool]()
+                  { mergeSortTask(arr, buffer, lo, mid, depth - 1, pool); });
+        mergeSortTask(arr, buffer, mid, hi, depth - 1, pool);
+        group.wait();
+    }
+
+    if (depth % 2 == 0)
+    {
+        parallelMerge(buffer, arr.data(), lo, mid, hi, pool);
+    }
+    else
+    {
+        parallelMerge(arr.data(), buffer, lo, mid, hi, pool);
+    }
+}
+
+// Merge src[lo, mid) and src[mid, hi) into dst[lo, hi). The output is cut
+// into equal chunks and each chunk finds its inputs by co-ranking, so the
+// chunks are merged independently (merge path partitioning).
+void ParallelSort::parallelMerge(const int *src, int *dst, int lo, int mid, int hi,
+                                 WorkStealingPool &pool)
+{
+    const int *a = src + lo;
+    const int *b = src + mid;
+    int lenA = mid - lo;
+    int lenB = hi - mid;
+    int total = hi - lo;
+
+    // Already in order: nothing to merge
+    if (lenA == 0 || lenB == 0 || !(b[0] < a[lenA - 1]))
+    {
+        std::copy(src + lo, src + hi, dst + lo);
+        return;
+    }
+
+    int chunks = std::min(total / MERGE_GRAIN, 4 * pool.size());
+    if (chunks <= 1)
+    {
+        mergeRange(a, lenA, b, lenB, dst + lo);
+        return;
+    }
+
+    TaskGroup group(pool);
+    for (int c = 0; c < chunks; c++)
+    {
+        int k0 = static_cast<int>(static_cast<long long>(total) * c / chunks);
+        int k1 = static_cast<int>(static_cast<long long>(total) * (c + 1) / chunks);
+        group.run([a, lenA, b, lenB, k0, k1, dst, lo]()
+                  {
+                      int i0 = coRank(a, lenA, b, lenB, k0);
+                      int i1 = coRank(a, lenA, b, lenB, k1);
+                      mergeRange(a + i0, i1 - i0, b + (k0 - i0), (k1 - i1) - (k0 - i0), dst + lo + k0);
+                  });
+    }
+    group.wait();
+}
+
+// Number of elements of a among the first k outputs of a stable merge of
+// a and b (equal elements are taken from a first)
+int ParallelSort::coRank(const int *a, int lenA, const int *b, int lenB, int k)
+{
+    int lo = std::max(0, k - lenB);
+    int hi = std::min(k, lenA);
+
+    while (lo < hi)
+    {
+        int i = lo + (hi - lo) / 2;
+        if (!(b[k - i - 1] < a[i]))
+        {
+            lo = i + 1; // a[i] still belongs to the first k outputs
+        }
+        else
+        {
+            hi = i;
+        }
+    }
+    return lo;
+}
+
+void ParallelSort::mergeRange(const int *a, int lenA, const int *b, int lenB, int *out)
+{
+    int i = 0;
+    int j = 0;
+    while (i < lenA && j < lenB)
+    {
+        bool takeB = b[j] < a[i];
+        *out++ = takeB ? b[j] : a[i];
+        j += takeB;
+        i += !takeB;
+    }
+    out = std::copy(a + i, a + lenA, out);
+    std::copy(b + j, b + lenB, out);
+}
+
+// ==================== PARALLEL SAMPLE SORT ====================
+
+namespace
+{
+
+// One distribution step of the sample sort: moves the elements of a[0, n)
+// into buckets by comparing them against a tree of splitters.
+//   1. classifyStripe: each thread scans its stripe and collects elements in
+//      one block-sized buffer per bucket; full buffers are written back to
+//      the front of the stripe, so every stored block holds a single bucket
+//   2. permuteBlocks: each bucket owns the blocks between its rounded-up
+//      boundaries; threads pick up misplaced blocks and swap them into the
+//      next free slot of their bucket until every block sits in its bucket
+//   3. saveMisplaced/fillHoles: the partial blocks at the bucket boundaries
+//      are fixed up from the leftover buffer contents
+class BlockDistribution
+{
+public:
+    BlockDistribution(int *a, int n, int logBuckets, const std::vector<int> &splitters, int stripes)
+        : a(a), n(n), logBuckets(logBuckets), k(1 << logBuckets), stripes(stripes),
+          tree(1 << logBuckets), numBlocks((n + B - 1) / B), full(numBlocks, 0),
+          buffers(stripes), fill(stripes << logBuckets, 0), flushed(stripes << logBuckets, 0),
+          bucketStart(k + 1), regionBlock(k + 1), writeBlock(k), readBlock(k),
+          keptBegin(k), keptEnd(k), misplaced(k), locks(new std::mutex[1 << logBuckets]),
+          overflow(B), overflowBucket(-1)
+    {
+        blocksPerStripe = (numBlocks + stripes - 1) / stripes;
+
+        // Heap-ordered tree over the k - 1 sorted splitters: node v on level l
+        // holds the splitter at its in-order position
+        for (int v = 1; v < k; v++)
+        {
+            int level = 0;
+            while ((2 << level) <= v)
+            {
+                level++;
+            }
+            tree[v] = splitters[((2 * (v - (1 << level)) + 1) << (logBuckets - level - 1)) - 1];
+        }
+    }
+
+    int buckets() const { return k; }
+    int bucketBegin(int b) const { return bucketStart[b]; }
+
+    void classifyStripe(int t)
+    {
+        int begin = t * blocksPerStripe * B;
+        int end = std::min(n, begin + blocksPerStripe * B);
+        if (begin >= end)
+        {
+            return;
+        }
+
+        std::vector<int> &buffer = buffers[t];
+        buffer.resize(k * B);
+        int *count = &fill[t * k];
+        int *blocks = &flushed[t * k];
+        int write = begin;
+
+        for (int i = begin; i < end; i++)
+        {
+            int x = a[i];
+            int b = classify(x);
+            int *slot = &buffer[b * B];
+            slot[count[b]] = x;
+            if (++count[b] == B)
+            {
+                // write + B <= i + 1, so this never overwrites unread elements
+                std::copy(slot, slot + B, a + write);
+                full[write / B] = 1;
+                write += B;
+                count[b] = 0;
+                blocks[b]++;
+            }
+        }
+    }
+
+    void computeBoundaries()
+    {
+        bucketStart[0] = 0;
+        for (int b = 0; b < k; b++)
+        {
+            int total = 0;
+            for (int t = 0; t < stripes; t++)
+            {
+                total += flushed[t * k + b] * B + fill[t * k + b];
+            }
+            bucketStart[b + 1] = bucketStart[b] + total;
+            regionBlock[b] = (bucketStart[b] + B - 1) / B;
+        }
+        regionBlock[k] = numBlocks;
+
+        for (int b = 0; b < k; b++)
+        {
+            writeBlock[b] = regionBlock[b];
+            readBlock[b] = regionBlock[b + 1] - 1;
+        }
+    }
+
+    // Blocks [region, writeBlock) of a bucket are done; [writeBlock, readBlock]
+    // are unknown (full or empty); blocks past readBlock are empty. Both
+    // pointers of a bucket, and the full[] flags of its region, are only
+    // touched under that bucket's lock.
+    void permuteBlocks(int t)
+    {
+        std::vector<int> hand(B);
+        std::vector<int> spare(B);
+        int first = t * k / stripes;
+
+        for (int step = 0; step < k;)
+        {
+            int b = (first + step) % k;
+            {
+                std::lock_guard<std::mutex> guard(locks[b]);
+                int &read = readBlock[b];
+                while (read >= writeBlock[b] && !full[read])
+                {
+                    read--;
+                }
+                if (read < writeBlock[b])
+                {
+                    step++;
+                    continue;
+                }
+                std::copy(a + read * B, a + (read + 1) * B, hand.begin());
+                full[read] = 0;
+                read--;
+            }
+
+            // Carry the block to its bucket, swapping out any unplaced block there
+            while (true)
+            {
+                int c = classify(hand[0]);
+                std::lock_guard<std::mutex> guard(locks[c]);
+                int pos = writeBlock[c]++;
+
+                if (pos <= readBlock[c] && full[pos])
+                {
+                    std::copy(a + pos * B, a + (pos + 1) * B, spare.begin());
+                    std::copy(hand.begin(), hand.end(), a + pos * B);
+                    hand.swap(spare);
+                    continue;
+                }
+
+                if (pos < n / B)
+                {
+                    std::copy(hand.begin(), hand.end(), a + pos * B);
+                }
+                else
+                {
+                    // Last block slot reaches past the end of the array
+                    std::copy(hand.begin(), hand.end(), overflow.begin());
+                    overflowBucket = c;
+                }
+                break;
+            }
+        }
+    }
+
+    // Move the elements of bucket c's full blocks that lie outside its final
+    // range [bucketStart[c], bucketStart[c + 1]) aside
+    void saveMisplaced(int c)
+    {
+        int overflowBase = (numBlocks - 1) * B;
+        int writtenEnd = writeBlock[c] * B;
+
+        keptBegin[c] = regionBlock[c] * B;
+        keptEnd[c] = std::min(writtenEnd, bucketStart[c + 1]);
+        if (overflowBucket == c)
+        {
+            keptEnd[c] = std::min(keptEnd[c], overflowBase);
+        }
+        keptEnd[c] = std::max(keptEnd[c], keptBegin[c]);
+
+        for (int i = keptEnd[c]; i < writtenEnd; i++)
+        {
+            misplaced[c].push_back(overflowBucket == c && i >= overflowBase ? overflow[i - overflowBase] : a[i]);
+        }
+    }
+
+    // Fill the rest of bucket c's final range from the misplaced elements and
+    // the leftovers in the classification buffers
+    void fillHoles(int c)
+    {
+        int pos = bucketStart[c];
+        int holeEnd = std::min(keptBegin[c], bucketStart[c + 1]);
+        std::vector<int> &saved = misplaced[c];
+
+        for (size_t i = 0; i < saved.size(); i++)
+        {
+            put(saved[i], c, pos, holeEnd);
+        }
+        for (int t = 0; t < stripes; t++)
+        {
+            const int *leftover = buffers[t].empty() ? nullptr : &buffers[t][c * B];
+            for (int i = 0; i < fill[t * k + c]; i++)
+            {
+                put(leftover[i], c, pos, holeEnd);
+            }
+        }
+    }
+
+private:
+    enum
+    {
+        B = ParallelSort::BLOCK_SIZE
+    };
+
+    int *a;
+    int n;
+    int logBuckets;
+    int k;
+    int stripes;
+    std::vector<int> tree;
+    int numBlocks;
+    int blocksPerStripe;
+    std::vector<unsigned char> full; // per block: holds a not yet placed block
+
+    std::vector<std::vector<int> > buffers; // per stripe: one block per bucket
+    std::vector<int> fill;                  // per stripe and bucket: elements in the buffer
+    std::vector<int> flushed;               // per stripe and bucket: full blocks written
+
+    std::vector<int> bucketStart; // final bucket boundaries (elements)
+    std::vector<int> regionBlock; // bucket boundaries rounded up to blocks
+    std::vector<int> writeBlock;
+    std::vector<int> readBlock;
+    std::vector<int> keptBegin;
+    std::vector<int> keptEnd;
+    std::vector<std::vector<int> > misplaced;
+    std::unique_ptr<std::mutex[]> locks;
+
+    std::vector<int> overflow;
+    int overflowBucket;
+
+    // Branchless descent of the splitter tree; equal keys go left, so bucket
+    // b receives the x with splitter[b - 1] < x <= splitter[b]
+    int classify(int x) const
+    {
+        int b = 1;
+        for (int level = 0; level < logBuckets; level++)
+        {
+            b = 2 * b + (tree[b] < x);
+        }
+        return b - k;
+    }
+
+    void put(int x, int c, int &pos, int &holeEnd)
+    {
+        if (pos == holeEnd)
+        {
+            pos = keptEnd[c];
+            holeEnd = bucketStart[c + 1];
+        }
+        a[pos++] = x;
+    }
+};
+
+} // namespace
+
+void ParallelSort::sampleSort(std::vector<int> &arr, int threads)
+{
+    if (threads == 1 || arr.size() < static_cast<size_t>(SEQUENTIAL_THRESHOLD))
+    {
+        SortEngine::quickSort(arr);
+        return;
+    }
+
+    WorkStealingPool pool(threads);
+    sampleSort(arr, pool);
+}
+
+void ParallelSort::sampleSort(std::vector<int> &arr, WorkStealingPool &pool)
+{
+    sampleSortRange(arr, 0, static_cast<int>(arr.size()), pool);
+}
+
+void ParallelSort::sampleSortRange(std::vector<int> &arr, int begin, int n, WorkStealingPool &pool)
+{
+    NullTracer tracer;
+    if (pool.size() == 1 || n < SEQUENTIAL_THRESHOLD)
+    {
+        SortEngine::quickSort(arr, begin, begin + n - 1, tracer);
+        return;
+    }
+
+    // Keep several blocks per bucket on average
+    int logBuckets = LOG_BUCKETS;
+    while (logBuckets > 1 && (n >> logBuckets) < 4 * BLOCK_SIZE)
+    {
+        logBuckets--;
+    }
+    int k = 1 << logBuckets;
+
+    // Draw the sample with a fixed-seed xorshift so runs are reproducible
+    std::vector<int> sample(OVERSAMPLING * k);
+    unsigned state = 2463534242u ^ static_cast<unsigned>(n);
+    for (size_t i = 0; i < sample.size(); i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        sample[i] = arr[begin + static_cast<int>(state % static_cast<unsigned>(n))];
+    }
+    SortEngine::quickSort(sample);
+
+    // A sample of a single value means (almost) all keys are equal, which the
+    // introsort handles in linear time
+    if (!(sample.front() < sample.back()))
+    {
+        SortEngine::quickSort(arr, begin, begin + n - 1, tracer);
+        return;
+    }
+
+    std::vector<int> splitters(k - 1);
+    for (int i = 0; i < k - 1; i++)
+    {
+        splitters[i] = sample[(i + 1) * OVERSAMPLING - 1];
+    }
+
+    std::vector<int> bounds(k + 1);
+    {
+        int stripes = std::min(pool.size(), (n + BLOCK_SIZE - 1) / BLOCK_SIZE);
+        BlockDistribution dist(arr.data() + begin, n, logBuckets, splitters, stripes);
+
+        TaskGroup group(pool);
+        for (int t = 0; t < stripes; t++)
+        {
+            group.run([&dist, t]() { dist.classifyStripe(t); });
+        }
+        group.wait();
+
+        dist.computeBoundaries();
+
+        for (int t = 0; t < stripes; t++)
+        {
+            group.run([&dist, t]() { dist.permuteBlocks(t); });
+        }
+        group.wait();
+
+        for (int c = 0; c < k; c++)
+        {
+            group.run([&dist, c]() { dist.saveMisplaced(c); });
+        }
+        group.wait();
+
+        for (int c = 0; c < k; c++)
+        {
+            group.run([&dist, c]() { dist.fillHoles(c); });
+        }
+        group.wait();
+
+        for (int c = 0; c <= k; c++)
+        {
+            bounds[c] = begin + dist.bucketBegin(c);
+        }
+    }
+
+    // Buckets larger than a fair share of the threads are distributed again
+    // in parallel; the rest are sorted sequentially, one task each
+    TaskGroup group(pool);
+    for (int c = 0; c < k; c++)
+    {
+        int lo = bounds[c];
+        int size = bounds[c + 1] - lo;
+        if (size < 2)
+        {
+            continue;
+        }
+
+        group.run([&arr, &pool, lo, size, n]()
+                  {
+                      if (size > n / pool.size() && size < n)
+                      {
+                          sampleSortRange(arr, lo, size, pool);
+                      }
+                      else
+                      {
+                          NullTracer tracer;
+                          SortEngine::quickSort(arr, lo, lo + size - 1, tracer);
+                      }
+                  });
+    }
+    group.wait();
+}
@@ -0,0 +1,52 @@
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <vector>
+#include "thread_pool.h"
+
+/**
+ * Multi-threaded sorting for large arrays
+ * Both sorts run on a WorkStealingPool and fall back to the sequential
+ * SortEngine kernels for small inputs and for the leaves of the recursion.
+ *   mergeSort  - stable; leaves are sorted with the natural merge sort and
+ *                every merge is itself split across threads by co-ranking
+ *                (merge path), using one n-element scratch buffer
+ *   sampleSort - unstable and in place apart from O(threads * buckets)
+ *                buffers; distributes the array into up to 256 buckets by
+ *                sampled splitters (block-wise, after IPS4o), then sorts the
+ *                buckets in parallel
+ * threads = 0 uses every hardware thread; threads = 1 runs sequentially.
+ */
+
+class ParallelSort
+{
+public:
+    enum
+    {
+        SEQUENTIAL_THRESHOLD = 1 << 16, // smaller inputs are sorted on the calling thread
+        MERGE_GRAIN = 1 << 15,          // minimum outputs per parallel merge task
+        BLOCK_SIZE = 512,               // sample sort moves elements in blocks of this size
+        LOG_BUCKETS = 8,                // at most 2^LOG_BUCKETS sample sort buckets
+        OVERSAMPLING = 16               // sample elements drawn per bucket
+    };
+
+    static void mergeSort(std::vector<int> &arr, int threads = 0);
+    static void mergeSort(std::vector<int> &arr, WorkStealingPool &pool);
+
+    static void sampleSort(std::vector<int> &arr, int threads = 0);
+    static void sampleSort(std::vector<int> &arr, WorkStealingPool &pool);
+
+private:
+    // Merge sort helpers
+    static void mergeSortTask(std::vector<int> &arr, int *buffer, int lo, int hi,
+                              int depth, WorkStealingPool &pool);
+    static void parallelMerge(const int *src, int *dst, int lo, int mid, int hi,
+                              WorkStealingPool &pool);
+    static int coRank(const int *a, int lenA, const int *b, int lenB, int k);
+    static void mergeRange(const int *a, int lenA, const int *b, int lenB, int *out);
+
+    // Sample sort helpers
+    static void sampleSortRange(std::vector<int> &arr, int begin, int n, WorkStealingPool &pool);
+};
+
+#endif // PARALLEL_SORT_H
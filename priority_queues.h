@@ -0,0 +1,241 @@
+#ifndef PRIORITY_QUEUES_H
+#define PRIORITY_QUEUES_H
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * Integer priority queues for AlgoVault's shortest path searches
+ * All three hold vertices (ints) under unsigned 64-bit keys, and pop the
+ * smallest key first:
+ *   BucketQueue     - Dial's buckets: one bucket per key, kept in a ring of
+ *                     maxStep + 1; O(1) push, pops scan at most the ring
+ *   RadixHeap       - 65 buckets by the highest bit in which a key differs
+ *                     from the last key popped; a key is moved at most 64
+ *                     times in all, so O(log C) amortized per operation
+ *   IndexedDaryHeap - 4-ary heap with a position per vertex, so a vertex is
+ *                     in it at most once and can have its key lowered
+ * BucketQueue and RadixHeap are monotone: a pushed key may not be smaller
+ * than the last key popped (Dijkstra never does that), and BucketQueue's
+ * keys must also stay within maxStep of it. Neither can lower a key, so a
+ * vertex is pushed again when its distance improves and the caller skips
+ * the entries whose key no longer matches the vertex's distance.
+ */
+
+class BucketQueue
+{
+public:
+    // maxStep: the largest amount by which a key may exceed the last key popped
+    explicit BucketQueue(std::uint64_t maxStep)
+        : buckets(static_cast<std::size_t>(maxStep) + 1), current(0), count(0)
+    {
+    }
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void push(std::uint64_t key, int vertex)
+    {
+        buckets[key % buckets.size()].push_back(vertex);
+        count++;
+    }
+
+    void pop(std::uint64_t &key, int &vertex)
+    {
+        std::size_t slot = current % buckets.size();
+        while (buckets[slot].empty())
+        {
+            current++;
+            slot = slot + 1 == buckets.size() ? 0 : slot + 1;
+        }
+        key = current;
+        vertex = buckets[slot].back();
+        buckets[slot].pop_back();
+        count--;
+    }
+
+private:
+    std::vector<std::vector<int> > buckets;
+    std::uint64_t current; // key of the bucket being emptied
+    std::size_t count;
+};
+
+class RadixHeap
+{
+public:
+    RadixHeap() : last(0), count(0) {}
+
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+    void push(std::uint64_t key, int vertex)
+    {
+        buckets[bucketOf(key ^ last)].push_back(Entry(key, vertex));
+        count++;
+    }
+
+    // Bucket 0 holds the keys equal to the last one; when it runs dry, the
+    // smallest key of the first non-empty bucket becomes the last key, and
+    // that bucket's entries move down to lower buckets
+    void pop(std::uint64_t &key, int &vertex)
+    {
+        if (buckets[0].empty())
+        {
+            int i = 1;
+            while (buckets[i].empty())
+                i++;
+
+            std::vector<Entry> &from = buckets[i];
+            last = from[0].first;
+            for (const Entry &entry : from)
+            {
+                if (entry.first < last)
+                    last = entry.first;
+            }
+            for (const Entry &entry : from)
+            {
+                buckets[bucketOf(entry.first ^ last)].push_back(entry);
+            }
+            from.clear();
+        }
+        key = buckets[0].back().first;
+        vertex = buckets[0].back().second;
+        buckets[0].pop_back();
+        count--;
+    }
+
+private:
+    typedef std::pair<std::uint64_t, int> Entry;
+
+    std::vector<Entry> buckets[65]; // bucket b: keys whose highest bit differing from last is b - 1
+    std::uint64_t last;
+    std::size_t count;
+
+    // Number of significant bits in x, 0 for 0
+    static int bucketOf(std::uint64_t x)
+    {
+        int bits = 0;
+        for (int shift = 32; shift > 0; shift >>= 1)
+        {
+            if (x >> shift)
+            {
+                x >>= shift;
+                bits += shift;
+            }
+        }
+        return bits + static_cast<int>(x);
+    }
+};
+
+class IndexedDaryHeap
+{
+public:
+    enum
+    {
+        ARITY = 4 // children per node: a shallower tree than binary, and siblings share a cache line
+    };
+
+    // vertices: the vertex ids are 0 .. vertices - 1
+    explicit IndexedDaryHeap(int vertices) : position(vertices, -1) {}
+
+    bool empty() const { return heap.empty(); }
+    std::size_t size() const { return heap.size(); }
+    bool contains(int vertex) const { return position[vertex] >= 0; }
+    std::uint64_t topKey() const { return heap[0].first; }
+
+    // Empties the heap in O(size), without touching the other vertices' positions
+    void clear()
+    {
+        for (const Entry &entry : heap)
+        {
+            position[entry.second] = -1;
+        }
+        heap.clear();
+    }
+
+    // Adds vertex, or lowers its key if it is in the heap with a larger one
+    void pushOrDecrease(std::uint64_t key, int vertex)
+    {
+        int i = position[vertex];
+        if (i < 0)
+        {
+            i = static_cast<int>(heap.size());
+            heap.push_back(Entry(key, vertex));
+        }
+        else if (key < heap[i].first)
+        {
+            heap[i].first = key;
+        }
+        else
+        {
+            return;
+        }
+        siftUp(i);
+    }
+
+    void pop(std::uint64_t &key, int &vertex)
+    {
+        key = heap[0].first;
+        vertex = heap[0].second;
+        position[vertex] = -1;
+        Entry tail = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap[0] = tail;
+            siftDown(0);
+        }
+    }
+
+private:
+    typedef std::pair<std::uint64_t, int> Entry;
+
+    std::vector<Entry> heap;
+    std::vector<int> position; // index of each vertex in heap, -1 when absent
+
+    void siftUp(int i)
+    {
+        Entry entry = heap[i];
+        while (i > 0)
+        {
+            int parent = (i - 1) / ARITY;
+            if (!(entry.first < heap[parent].first))
+                break;
+            heap[i] = heap[parent];
+            position[heap[i].second] = i;
+            i = parent;
+        }
+        heap[i] = entry;
+        position[entry.second] = i;
+    }
+
+    void siftDown(int i)
+    {
+        const int n = static_cast<int>(heap.size());
+        Entry entry = heap[i];
+        for (;;)
+        {
+            int first = i * ARITY + 1;
+            if (first >= n)
+                break;
+            int best = first;
+            int end = first + ARITY < n ? first + ARITY : n;
+            for (int child = first + 1; child < end; child++)
+            {
+                if (heap[child].first < heap[best].first)
+                    best = child;
+            }
+            if (!(heap[best].first < entry.first))
+                break;
+            heap[i] = heap[best];
+            position[heap[i].second] = i;
+            i = best;
+        }
+        heap[i] = entry;
+        position[entry.second] = i;
+    }
+};
+
+#endif // PRIORITY_QUEUES_H
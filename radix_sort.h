@@ -0,0 +1,474 @@
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include <vector>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include "sort_tracer.h"
+#include "sort_traits.h"
+
+/**
+ * Radix Sort Implementation for AlgoVault
+ * Non-comparison sorts for integer and IEEE floating-point keys:
+ *   lsdSort - least significant digit first, stable, 1-16 bit digits
+ *             (11 by default), one histogram pass for all digits, and digits
+ *             that every key shares are skipped
+ *   msdSort - most significant digit first, in place (American flag sort),
+ *             for runs that cannot afford the O(n) scratch buffer
+ * Keys are mapped to unsigned integers whose order matches the original
+ * values (sign bit flipped for signed integers, IEEE sign-magnitude turned
+ * into two's-complement order for floats) before digits are extracted.
+ * The iterator overloads sort any random-access range of records by the key
+ * a projection extracts from each of them (e.g. a 64-bit id field).
+ */
+
+// Unsigned integer with the same width as the key
+template <std::size_t Size>
+struct RadixBits;
+template <>
+struct RadixBits<1> { typedef unsigned char Type; };
+template <>
+struct RadixBits<2> { typedef unsigned short Type; };
+template <>
+struct RadixBits<4> { typedef unsigned int Type; };
+template <>
+struct RadixBits<8> { typedef unsigned long long Type; };
+
+// Order-preserving key transform for integral types
+template <typename T, bool IsFloat = std::is_floating_point<T>::value>
+struct RadixKey
+{
+    typedef typename RadixBits<sizeof(T)>::Type Bits;
+
+    static Bits encode(T value)
+    {
+        Bits bits = static_cast<Bits>(value);
+        if (std::is_signed<T>::value)
+            bits ^= static_cast<Bits>(Bits(1) << (sizeof(T) * 8 - 1));
+        return bits;
+    }
+};
+
+// Order-preserving key transform for float and double
+// Negative values have all bits flipped, positive values only the sign bit,
+// so -inf < negatives < -0 < +0 < positives < +inf (NaNs sort to the ends)
+template <typename T>
+struct RadixKey<T, true>
+{
+    typedef typename RadixBits<sizeof(T)>::Type Bits;
+
+    static Bits encode(T value)
+    {
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const Bits sign = static_cast<Bits>(Bits(1) << (sizeof(T) * 8 - 1));
+        return (bits & sign) ? static_cast<Bits>(~bits) : static_cast<Bits>(bits | sign);
+    }
+};
+
+class RadixSort
+{
+public:
+    enum
+    {
+        DEFAULT_DIGIT_BITS = 11,      // 2048 buckets; 3 passes for 32-bit keys
+        MAX_DIGIT_BITS = 16,          // histograms beyond this stop fitting in cache
+        MSD_DIGIT_BITS = 8,           // American flag sort and in-bucket passes use byte digits
+        INSERTION_SORT_THRESHOLD = 64, // smaller inputs/buckets are insertion sorted
+        CACHE_RESIDENT_SIZE = 1 << 16 // inputs above this are split by their top digit first
+    };
+
+    // LSD Radix Sort
+    template <typename T, typename Tracer>
+    static void lsdSort(std::vector<T> &arr, Tracer &tracer, int digitBits = DEFAULT_DIGIT_BITS,
+                        int insertionThreshold = INSERTION_SORT_THRESHOLD);
+    template <typename T>
+    static void lsdSort(std::vector<T> &arr, int digitBits = DEFAULT_DIGIT_BITS)
+    {
+        NullTracer tracer;
+        lsdSort(arr, tracer, digitBits);
+    }
+    template <typename Iter, typename Projection = SortIdentity>
+    static void lsdSort(Iter first, Iter last, Projection proj = Projection());
+
+    // MSD Radix Sort (in-place American flag sort)
+    template <typename T, typename Tracer>
+    static void msdSort(std::vector<T> &arr, Tracer &tracer);
+    template <typename T>
+    static void msdSort(std::vector<T> &arr)
+    {
+        NullTracer tracer;
+        msdSort(arr, tracer);
+    }
+    template <typename Iter, typename Projection = SortIdentity>
+    static void msdSort(Iter first, Iter last, Projection proj = Projection());
+
+private:
+    // A contiguous range that the LSD passes can swap with their buffer in
+    // O(1), the way std::vector::swap does for the vector overload
+    template <typename T>
+    struct Span
+    {
+        T *data;
+        T &operator[](std::size_t i) const { return data[i]; }
+        void swap(Span &other) { std::swap(data, other.data); }
+    };
+
+    template <typename Iter, typename Projection, typename Tracer>
+    static void insertionSortByKey(Iter data, std::size_t n, Projection &proj, Tracer &tracer);
+    template <typename Array, typename Projection, typename Tracer>
+    static void lsdSortArrays(Array &arr, Array &buffer, std::size_t n, Projection &proj,
+                              Tracer &tracer, int digitBits);
+    template <typename T, typename Projection, typename Tracer>
+    static bool lsdPasses(T *src, T *tmp, std::size_t n, int keyBits, Projection &proj, Tracer &tracer);
+    template <typename Iter, typename Projection, typename Tracer>
+    static void americanFlagSort(Iter data, std::size_t begin, std::size_t end, int shift,
+                                 Projection &proj, Tracer &tracer);
+};
+
+// ==================== LSD RADIX SORT ====================
+
+template <typename T, typename Tracer>
+void RadixSort::lsdSort(std::vector<T> &arr, Tracer &tracer, int digitBits, int insertionThreshold)
+{
+    SortIdentity proj;
+    std::size_t n = arr.size();
+    if (n < 2 || n < static_cast<std::size_t>(insertionThreshold))
+    {
+        insertionSortByKey(arr.begin(), n, proj, tracer);
+        return;
+    }
+
+    std::vector<T> buffer(n);
+    lsdSortArrays(arr, buffer, n, proj, tracer, digitBits);
+}
+
+template <typename Iter, typename Projection>
+void RadixSort::lsdSort(Iter first, Iter last, Projection proj)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    NullTracer tracer;
+    std::size_t n = last - first;
+    if (n < INSERTION_SORT_THRESHOLD)
+    {
+        insertionSortByKey(first, n, proj, tracer);
+        return;
+    }
+
+    if (IsContiguousIterator<Iter>::value)
+    {
+        // Ping-pong between the range itself and one buffer
+        Value *data = &first[0];
+        std::vector<Value> storage(n);
+        Span<Value> values = {data};
+        Span<Value> buffer = {storage.data()};
+        lsdSortArrays(values, buffer, n, proj, tracer, DEFAULT_DIGIT_BITS);
+        if (values.data != data)
+            std::move(values.data, values.data + n, data);
+    }
+    else
+    {
+        std::vector<Value> values(std::make_move_iterator(first), std::make_move_iterator(last));
+        std::vector<Value> buffer(n);
+        lsdSortArrays(values, buffer, n, proj, tracer, DEFAULT_DIGIT_BITS);
+        std::move(values.begin(), values.end(), first);
+    }
+}
+
+// Sort arr[0, n) through buffer (both n long); arr.swap(buffer) exchanges
+// their contents, so after the last pass the result is in arr
+template <typename Array, typename Projection, typename Tracer>
+void RadixSort::lsdSortArrays(Array &arr, Array &buffer, std::size_t n, Projection &proj,
+                              Tracer &tracer, int digitBits)
+{
+    typedef typename std::remove_reference<decltype(arr[0])>::type T;
+    typedef typename SortKey<T *, Projection>::Type Key;
+    typedef typename RadixKey<Key>::Bits Bits;
+    const int keyBits = sizeof(Bits) * 8;
+
+    if (digitBits < 1)
+        digitBits = 1;
+    if (digitBits > MAX_DIGIT_BITS)
+        digitBits = MAX_DIGIT_BITS;
+
+    const int digits = (keyBits + digitBits - 1) / digitBits;
+    const std::size_t radix = std::size_t(1) << digitBits;
+    const Bits mask = static_cast<Bits>(radix - 1);
+
+    // One read of the input builds the histograms of all digits at once
+    std::vector<std::size_t> counts(digits * radix, 0);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Bits key = RadixKey<Key>::encode(proj(arr[i]));
+        for (int d = 0; d < digits; d++)
+            counts[d * radix + ((key >> (d * digitBits)) & mask)]++;
+    }
+
+    const Bits firstKey = RadixKey<Key>::encode(proj(arr[0]));
+
+    // Digits above the most significant one that varies can be ignored
+    int top = digits - 1;
+    while (top >= 0 && counts[top * radix + ((firstKey >> (top * digitBits)) & mask)] == n)
+        top--;
+    if (top < 0)
+        return;
+
+    if (top > 0 && n > CACHE_RESIDENT_SIZE)
+    {
+        // Large input: a scatter over the whole array misses the cache on
+        // every write, so split by the top digit once (stable) and run the
+        // remaining passes bucket by bucket while each bucket is cache resident
+        std::size_t *count = &counts[top * radix];
+        const int shift = top * digitBits;
+
+        std::size_t sum = 0;
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            std::size_t c = count[r];
+            count[r] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T &value = arr[i];
+            buffer[count[(RadixKey<Key>::encode(proj(value)) >> shift) & mask]++] = std::move(value);
+            tracer.move();
+        }
+        tracer.event(SORT_RADIX_PASS, top, shift, digitBits);
+
+        // count[r] is now the end of bucket r
+        std::size_t begin = 0;
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            std::size_t size = count[r] - begin;
+            if (size >= INSERTION_SORT_THRESHOLD)
+            {
+                if (lsdPasses(&buffer[begin], &arr[begin], size, shift, proj, tracer))
+                    std::move(&arr[begin], &arr[begin] + size, &buffer[begin]);
+            }
+            else if (size > 1)
+            {
+                insertionSortByKey(&buffer[begin], size, proj, tracer);
+            }
+            begin = count[r];
+        }
+        arr.swap(buffer);
+        return;
+    }
+
+    for (int d = 0; d <= top; d++)
+    {
+        std::size_t *count = &counts[d * radix];
+        const int shift = d * digitBits;
+
+        // Every key has the same value in this digit: the pass would not move anything
+        if (count[(firstKey >> shift) & mask] == n)
+            continue;
+
+        // Turn counts into bucket start offsets
+        std::size_t sum = 0;
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            std::size_t c = count[r];
+            count[r] = sum;
+            sum += c;
+        }
+
+        // Stable scatter into the buffer, then make it the current array
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T &value = arr[i];
+            buffer[count[(RadixKey<Key>::encode(proj(value)) >> shift) & mask]++] = std::move(value);
+            tracer.move();
+        }
+        arr.swap(buffer);
+        tracer.event(SORT_RADIX_PASS, d, shift, digitBits);
+    }
+}
+
+// Byte-wise LSD passes over the low keyBits bits of src[0, n), alternating
+// between src and tmp. Returns true if the result ended up in tmp.
+template <typename T, typename Projection, typename Tracer>
+bool RadixSort::lsdPasses(T *src, T *tmp, std::size_t n, int keyBits, Projection &proj, Tracer &tracer)
+{
+    typedef typename SortKey<T *, Projection>::Type Key;
+    typedef typename RadixKey<Key>::Bits Bits;
+    const int digits = (keyBits + MSD_DIGIT_BITS - 1) / MSD_DIGIT_BITS;
+    const std::size_t radix = std::size_t(1) << MSD_DIGIT_BITS;
+    const Bits mask = static_cast<Bits>(radix - 1);
+
+    std::size_t counts[((sizeof(Bits) * 8 + MSD_DIGIT_BITS - 1) / MSD_DIGIT_BITS) << MSD_DIGIT_BITS] = {0};
+    for (std::size_t i = 0; i < n; i++)
+    {
+        Bits key = RadixKey<Key>::encode(proj(src[i]));
+        for (int d = 0; d < digits; d++)
+            counts[d * radix + ((key >> (d * MSD_DIGIT_BITS)) & mask)]++;
+    }
+
+    const Bits firstKey = RadixKey<Key>::encode(proj(src[0]));
+    bool inTmp = false;
+    for (int d = 0; d < digits; d++)
+    {
+        std::size_t *count = &counts[d * radix];
+        const int shift = d * MSD_DIGIT_BITS;
+        if (count[(firstKey >> shift) & mask] == n)
+            continue;
+
+        std::size_t sum = 0;
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            std::size_t c = count[r];
+            count[r] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; i++)
+        {
+            T &value = src[i];
+            tmp[count[(RadixKey<Key>::encode(proj(value)) >> shift) & mask]++] = std::move(value);
+            tracer.move();
+        }
+        std::swap(src, tmp);
+        inTmp = !inTmp;
+    }
+    return inTmp;
+}
+
+// ==================== MSD RADIX SORT ====================
+
+template <typename T, typename Tracer>
+void RadixSort::msdSort(std::vector<T> &arr, Tracer &tracer)
+{
+    typedef typename RadixKey<T>::Bits Bits;
+    const int keyBits = sizeof(Bits) * 8;
+
+    SortIdentity proj;
+    if (arr.size() < 2)
+        return;
+    americanFlagSort(arr.begin(), 0, arr.size(), keyBits - MSD_DIGIT_BITS, proj, tracer);
+}
+
+template <typename Iter, typename Projection>
+void RadixSort::msdSort(Iter first, Iter last, Projection proj)
+{
+    typedef typename RadixKey<typename SortKey<Iter, Projection>::Type>::Bits Bits;
+    const int keyBits = sizeof(Bits) * 8;
+
+    NullTracer tracer;
+    if (last - first < 2)
+        return;
+    americanFlagSort(first, 0, last - first, keyBits - MSD_DIGIT_BITS, proj, tracer);
+}
+
+// Distribute data[begin, end) into 256 buckets by the digit at shift, in place,
+// then sort each bucket on the next digit
+template <typename Iter, typename Projection, typename Tracer>
+void RadixSort::americanFlagSort(Iter data, std::size_t begin, std::size_t end, int shift,
+                                 Projection &proj, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    typedef typename SortKey<Iter, Projection>::Type Key;
+    typedef typename RadixKey<Key>::Bits Bits;
+    const std::size_t radix = std::size_t(1) << MSD_DIGIT_BITS;
+    const Bits mask = static_cast<Bits>(radix - 1);
+
+    while (true)
+    {
+        std::size_t n = end - begin;
+        if (n < INSERTION_SORT_THRESHOLD)
+        {
+            insertionSortByKey(data + begin, n, proj, tracer);
+            return;
+        }
+
+        std::size_t count[1 << MSD_DIGIT_BITS] = {0};
+        for (std::size_t i = begin; i < end; i++)
+            count[(RadixKey<Key>::encode(proj(data[i])) >> shift) & mask]++;
+
+        // All keys share this digit: move on to the next one without touching the data
+        if (count[(RadixKey<Key>::encode(proj(data[begin])) >> shift) & mask] == n)
+        {
+            if (shift == 0)
+                return;
+            shift -= MSD_DIGIT_BITS;
+            continue;
+        }
+
+        std::size_t head[1 << MSD_DIGIT_BITS];
+        std::size_t tail[1 << MSD_DIGIT_BITS];
+        std::size_t sum = begin;
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            head[r] = sum;
+            sum += count[r];
+            tail[r] = sum;
+        }
+
+        // Cycle each misplaced element into the next free slot of its bucket
+        for (std::size_t b = 0; b < radix; b++)
+        {
+            while (head[b] < tail[b])
+            {
+                T value = std::move(data[head[b]]);
+                std::size_t digit = (RadixKey<Key>::encode(proj(value)) >> shift) & mask;
+                while (digit != b)
+                {
+                    std::size_t slot = head[digit]++;
+                    std::swap(value, data[slot]);
+                    tracer.move();
+                    digit = (RadixKey<Key>::encode(proj(value)) >> shift) & mask;
+                }
+                data[head[b]++] = std::move(value);
+                tracer.move();
+            }
+        }
+        tracer.event(SORT_RADIX_BUCKETS, static_cast<int>(begin), static_cast<int>(end - 1), shift);
+
+        if (shift == 0)
+            return;
+
+        // tail[r] - count[r] is where bucket r starts
+        for (std::size_t r = 0; r < radix; r++)
+        {
+            if (count[r] > 1)
+                americanFlagSort(data, tail[r] - count[r], tail[r], shift - MSD_DIGIT_BITS, proj, tracer);
+        }
+        return;
+    }
+}
+
+// Insertion sort comparing transformed keys, used for short inputs and buckets
+template <typename Iter, typename Projection, typename Tracer>
+void RadixSort::insertionSortByKey(Iter data, std::size_t n, Projection &proj, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type T;
+    typedef typename SortKey<Iter, Projection>::Type Key;
+    typedef typename RadixKey<Key>::Bits Bits;
+
+    for (std::size_t i = 1; i < n; i++)
+    {
+        Bits key = RadixKey<Key>::encode(proj(data[i]));
+        tracer.compare();
+        if (!(key < RadixKey<Key>::encode(proj(data[i - 1]))))
+            continue;
+
+        T value = std::move(data[i]);
+        std::size_t j = i;
+        do
+        {
+            data[j] = std::move(data[j - 1]);
+            tracer.move();
+            j--;
+            if (j == 0)
+                break;
+            tracer.compare();
+        } while (key < RadixKey<Key>::encode(proj(data[j - 1])));
+        data[j] = std::move(value);
+    }
+}
+
+#endif // RADIX_SORT_H
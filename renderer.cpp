@@ -0,0 +1,227 @@
+#include "renderer.h"
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace
+{
+    const char CURSOR_HOME[] = "\x1b[H";
+    const char CLEAR_SCREEN[] = "\x1b[2J";
+    const char CLEAR_LINE[] = "\x1b[K";
+    const char CLEAR_BELOW[] = "\x1b[J";
+    const char HIDE_CURSOR[] = "\x1b[?25l";
+    const char SHOW_CURSOR[] = "\x1b[?25h";
+    const char RESET_COLOR[] = "\x1b[0m";
+}
+
+FrameRenderer::FrameRenderer(int maxFps)
+    : hasPending(false), ansi(enableAnsi()), started(false),
+      interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) /
+               std::max(maxFps, 1)),
+      nextFrame(std::chrono::steady_clock::now()), written(0), skipped(0)
+{
+}
+
+FrameRenderer::~FrameRenderer()
+{
+    finish();
+}
+
+// ==================== FRAME BUILDING ====================
+
+void FrameRenderer::beginFrame()
+{
+    frame.clear();
+    if (ansi)
+    {
+        frame += CURSOR_HOME;
+    }
+    else
+    {
+        frame += '\n';
+    }
+}
+
+FrameRenderer &FrameRenderer::text(const std::string &s)
+{
+    frame += s;
+    return *this;
+}
+
+FrameRenderer &FrameRenderer::text(const char *s)
+{
+    frame += s;
+    return *this;
+}
+
+FrameRenderer &FrameRenderer::text(char c, int count)
+{
+    if (count > 0)
+    {
+        frame.append(static_cast<std::size_t>(count), c);
+    }
+    return *this;
+}
+
+FrameRenderer &FrameRenderer::number(long long value)
+{
+    char digits[24];
+    int length = std::snprintf(digits, sizeof(digits), "%lld", value);
+    frame.append(digits, static_cast<std::size_t>(length));
+    return *this;
+}
+
+// Console attributes keep blue in bit 0 and red in bit 2, ANSI the other way round
+FrameRenderer &FrameRenderer::color(int consoleColor)
+{
+    if (ansi)
+    {
+        int rgb = ((consoleColor & 1) << 2) | (consoleColor & 2) | ((consoleColor & 4) >> 2);
+        int code = (consoleColor & 8 ? 90 : 30) + rgb;
+        char sequence[8];
+        int length = std::snprintf(sequence, sizeof(sequence), "\x1b[%dm", code);
+        frame.append(sequence, static_cast<std::size_t>(length));
+    }
+    return *this;
+}
+
+FrameRenderer &FrameRenderer::resetColor()
+{
+    if (ansi)
+    {
+        frame += RESET_COLOR;
+    }
+    return *this;
+}
+
+FrameRenderer &FrameRenderer::newline()
+{
+    if (ansi)
+    {
+        frame += CLEAR_LINE;
+    }
+    frame += '\n';
+    return *this;
+}
+
+// ==================== OUTPUT ====================
+
+bool FrameRenderer::present()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now < nextFrame)
+    {
+        if (hasPending)
+        {
+            skipped++;
+        }
+        pending.swap(frame);
+        hasPending = true;
+        return false;
+    }
+
+    if (hasPending)
+    {
+        skipped++;
+        hasPending = false;
+    }
+    writeFrame(frame);
+
+    // A write that blocked because the terminal is behind pushes the next
+    // frame back as well, so frames are dropped rather than queued
+    nextFrame = std::max(now + interval, std::chrono::steady_clock::now());
+    return true;
+}
+
+void FrameRenderer::finish()
+{
+    if (hasPending)
+    {
+        hasPending = false;
+        writeFrame(pending);
+    }
+    if (started)
+    {
+        started = false;
+        std::string tail;
+        if (ansi)
+        {
+            tail += CLEAR_BELOW;
+            tail += RESET_COLOR;
+            tail += SHOW_CURSOR;
+        }
+        write(tail.data(), tail.size());
+    }
+}
+
+void FrameRenderer::writeFrame(const std::string &data)
+{
+    if (!started)
+    {
+        started = true;
+        if (ansi)
+        {
+            std::string intro = std::string(HIDE_CURSOR) + CLEAR_SCREEN + data;
+            write(intro.data(), intro.size());
+            written++;
+            return;
+        }
+    }
+    write(data.data(), data.size());
+    written++;
+}
+
+void FrameRenderer::write(const char *data, std::size_t size)
+{
+    std::cout.flush();
+    std::fflush(stdout);
+
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    while (size > 0)
+    {
+        DWORD done = 0;
+        if (!WriteFile(out, data, static_cast<DWORD>(std::min<std::size_t>(size, 1u << 30)), &done, NULL) || done == 0)
+            return;
+        data += done;
+        size -= done;
+    }
+#else
+    while (size > 0)
+    {
+        ssize_t done = ::write(STDOUT_FILENO, data, size);
+        if (done < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += done;
+        size -= static_cast<std::size_t>(done);
+    }
+#endif
+}
+
+bool FrameRenderer::enableAnsi()
+{
+#ifdef _WIN32
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!GetConsoleMode(out, &mode))
+        return true; // redirected to a file or pipe: the bytes pass through unchanged
+    return (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) ||
+           SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#else
+    return true;
+#endif
+}
@@ -0,0 +1,82 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <string>
+#include <cstddef>
+#include <chrono>
+
+/**
+ * Buffered terminal renderer for AlgoVault
+ * A frame is built in memory, with colors as inline ANSI escape codes, and
+ * written to the terminal with a single write call when it is presented,
+ * instead of one stream insertion per element and one console API call per
+ * colored fragment. Each frame is drawn over the previous one from the top
+ * left corner of the screen.
+ * present() writes at most maxFps frames per second. A frame that arrives
+ * sooner becomes the pending frame and is replaced by the next one, so a
+ * fast algorithm or a slow terminal (for example over SSH) costs skipped
+ * frames instead of a growing backlog; finish() writes the last one.
+ * Colors take the ConsoleColors values from utils.h.
+ */
+
+class FrameRenderer
+{
+public:
+    enum
+    {
+        DEFAULT_FPS = 30
+    };
+
+    explicit FrameRenderer(int maxFps = DEFAULT_FPS);
+    // Writes the pending frame and shows the cursor again
+    ~FrameRenderer();
+
+    // Start a new frame (the previous one is kept until this one is presented)
+    void beginFrame();
+
+    FrameRenderer &text(const std::string &s);
+    FrameRenderer &text(const char *s);
+    FrameRenderer &text(char c, int count = 1);
+    FrameRenderer &number(long long value);
+    FrameRenderer &color(int consoleColor);
+    FrameRenderer &resetColor();
+    // End the line, clearing whatever an earlier, longer frame left on it
+    FrameRenderer &newline();
+
+    // Show the frame, or keep it pending if the last one was shown less than
+    // 1 / maxFps ago; true if it was written
+    bool present();
+    // Whether a frame presented now would be written; callers with costly
+    // frames can skipFrame() instead of building one that would be dropped
+    bool frameDue() const { return std::chrono::steady_clock::now() >= nextFrame; }
+    void skipFrame() { skipped++; }
+    // Write the pending frame, if any, and leave the cursor below it
+    void finish();
+
+    long long framesWritten() const { return written; }
+    long long framesSkipped() const { return skipped; }
+
+    // Write bytes to standard output with one system call, after flushing std::cout
+    static void write(const char *data, std::size_t size);
+    // Turn on escape sequence processing in Windows consoles; false where
+    // it is not available (frames are then written without colors or redraws)
+    static bool enableAnsi();
+
+private:
+    std::string frame;
+    std::string pending;
+    bool hasPending;
+    bool ansi;
+    bool started;
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point nextFrame;
+    long long written;
+    long long skipped;
+
+    FrameRenderer(const FrameRenderer &);
+    FrameRenderer &operator=(const FrameRenderer &);
+
+    void writeFrame(const std::string &data);
+};
+
+#endif // RENDERER_H
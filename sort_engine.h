@@ -0,0 +1,1663 @@
+#ifndef SORT_ENGINE_H
+#define SORT_ENGINE_H
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <iterator>
+#include <cstdint>
+#include <type_traits>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include "sort_tracer.h"
+#include "sort_traits.h"
+#include "sorting_network.h"
+#include "radix_sort.h"
+
+/**
+ * Sorting kernels for AlgoVault
+ * Every kernel is templated on a tracer policy (see sort_tracer.h), so the
+ * same code sorts at full speed with NullTracer and drives the visualizer
+ * with ConsoleTracer. The overloads without a tracer use NullTracer.
+ * Untraced sorts finish short ranges with the sorting networks from
+ * sorting_network.h instead of insertion sort.
+ *
+ * The iterator overloads sort any random-access range by comp(proj(a),
+ * proj(b)) (see sort_traits.h); comparator and projection are template
+ * parameters and inline into the kernels. sort() and stableSort() pick the
+ * algorithm at compile time: integer or floating-point keys under the
+ * default ordering go to RadixSort, everything else to introsort (sort) or
+ * natural merge sort (stableSort). The kernels index with int, so a range
+ * longer than INT_MAX throws std::length_error (as in KeyValueSort).
+ */
+
+class SortEngine
+{
+public:
+    enum
+    {
+        RADIX_SORT_THRESHOLD = 1 << 11 // sort() and stableSort() use comparison sorts below this
+    };
+
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void sort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void stableSort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Bubble Sort
+    template <typename Tracer>
+    static void bubbleSort(std::vector<int> &arr, Tracer &tracer);
+    static void bubbleSort(std::vector<int> &arr)
+    {
+        NullTracer tracer;
+        bubbleSort(arr, tracer);
+    }
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void bubbleSort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Quick Sort (pattern-defeating introsort)
+    enum
+    {
+        INSERTION_SORT_THRESHOLD = 24, // ranges below this are insertion sorted
+        NETWORK_SORT_THRESHOLD = 32,   // untraced int ranges below this go to the sorting network
+        MIN_INSERTION_THRESHOLD = 3,   // smallest cutoff the pivot selection supports
+        NINTHER_THRESHOLD = 128,       // ranges above this use Tukey's ninther
+        PARTIAL_INSERTION_LIMIT = 8,   // moves allowed before giving up on a presorted guess
+        PARTITION_BLOCK_SIZE = 64      // offsets buffered per side by the block partition
+    };
+
+    // insertionThreshold: size below which a range is finished by the leaf
+    // kernel; 0 picks the default for the tracer
+    template <typename Tracer>
+    static void quickSort(std::vector<int> &arr, int low, int high, Tracer &tracer,
+                          int insertionThreshold = 0);
+    template <typename Tracer>
+    static int partition(std::vector<int> &arr, int low, int high, Tracer &tracer);
+    template <typename Tracer>
+    static void insertionSort(std::vector<int> &arr, int low, int high, Tracer &tracer);
+    static void quickSort(std::vector<int> &arr)
+    {
+        NullTracer tracer;
+        quickSort(arr, 0, rangeSize(arr.begin(), arr.end()) - 1, tracer);
+    }
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void quickSort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Merge Sort (natural, TimSort-style)
+    enum
+    {
+        MIN_GALLOP = 7,     // consecutive wins before a merge switches to galloping
+        RUN_STACK_SIZE = 85 // pending runs; enough for any array the int indices can address
+    };
+
+    template <typename Tracer>
+    static void mergeSort(std::vector<int> &arr, int left, int right, Tracer &tracer, int minRun = 0);
+    template <typename Tracer>
+    static void merge(std::vector<int> &arr, int left, int mid, int right, Tracer &tracer);
+    static void mergeSort(std::vector<int> &arr)
+    {
+        NullTracer tracer;
+        mergeSort(arr, 0, rangeSize(arr.begin(), arr.end()) - 1, tracer);
+    }
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void mergeSort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Heap Sort (d-ary heap, Floyd's bottom-up sift-down)
+    enum
+    {
+        HEAP_ARITY_BY_SIZE = 0,           // heapSort default: binary while the heap is cached, else HEAP_ARITY
+        HEAP_ARITY = 4,                   // children per node; 4 or 8 fit one cache line
+        BINARY_HEAP_MAX_BYTES = 1 << 26,  // heaps up to this size stay binary under HEAP_ARITY_BY_SIZE
+        ALIGNED_HEAP_THRESHOLD = 1 << 12, // larger heaps align each group of siblings
+        CACHE_LINE_SIZE = 64              // bytes; only groups that tile a line are aligned
+    };
+
+    template <int Arity = HEAP_ARITY_BY_SIZE, typename Tracer>
+    static void heapSort(std::vector<int> &arr, Tracer &tracer);
+    template <int Arity = HEAP_ARITY_BY_SIZE, typename Tracer>
+    static void heapSort(std::vector<int> &arr, int first, int last, Tracer &tracer);
+    template <int Arity = HEAP_ARITY, typename Tracer>
+    static void buildMaxHeap(std::vector<int> &arr, int first, int n, Tracer &tracer);
+    template <int Arity = HEAP_ARITY, typename Tracer>
+    static void heapify(std::vector<int> &arr, int first, int n, int i, Tracer &tracer);
+    static void heapSort(std::vector<int> &arr)
+    {
+        NullTracer tracer;
+        heapSort(arr, tracer);
+    }
+    template <int Arity = HEAP_ARITY_BY_SIZE, typename Iter, typename Compare = SortLess,
+              typename Projection = SortIdentity>
+    static void heapSort(Iter first, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+    // Selection (introselect with Floyd-Rivest sampling, heap-based top-k)
+    enum
+    {
+        FLOYD_RIVEST_THRESHOLD = 600, // larger ranges take the pivot from a sample around nth
+        HEAP_SELECT_RATIO = 256       // topK() keeps a heap when k <= n / HEAP_SELECT_RATIO
+    };
+
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void nthElement(Iter first, Iter nth, Iter last, Compare comp = Compare(), Projection proj = Projection());
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void topK(Iter first, Iter middle, Iter last, Compare comp = Compare(), Projection proj = Projection());
+    template <typename Iter, typename Compare = SortLess, typename Projection = SortIdentity>
+    static void partialSort(Iter first, Iter middle, Iter last, Compare comp = Compare(), Projection proj = Projection());
+
+private:
+    // The kernels below work on arr[begin, end) for any random-access
+    // iterator arr; the int overloads above pass arr.begin() and SortLess
+
+    // Length of [first, last) as the int the kernels index with; a longer
+    // range throws std::length_error instead of being silently truncated
+    template <typename Iter>
+    static int rangeSize(Iter first, Iter last)
+    {
+        if (last - first > static_cast<typename std::iterator_traits<Iter>::difference_type>(
+                               std::numeric_limits<int>::max()))
+            throw std::length_error("SortEngine: range too large");
+        return static_cast<int>(last - first);
+    }
+    template <typename T, typename Compare, typename Tracer>
+    static bool less(const T &a, const T &b, Compare &comp, Tracer &tracer)
+    {
+        tracer.compare();
+        return comp(a, b);
+    }
+
+    // Untraced int ranges in ascending order can be finished by the sorting
+    // network, which needs the ints to be contiguous
+    template <typename Iter, typename Compare, typename Tracer>
+    struct UsesSortingNetwork
+        : std::integral_constant<bool, std::is_same<Tracer, NullTracer>::value &&
+                                           IsContiguousIterator<Iter>::value &&
+                                           std::is_same<typename std::iterator_traits<Iter>::value_type, int>::value &&
+                                           IsAscendingCompare<Compare, int>::value>
+    {
+    };
+
+    // The block partition trades extra comparisons for fewer mispredicted
+    // branches, which pays off only when comparing is cheap (after pdqsort)
+    template <typename Iter, typename Compare>
+    struct UsesBlockPartition
+        : std::integral_constant<bool, std::is_arithmetic<typename std::iterator_traits<Iter>::value_type>::value &&
+                                           IsAscendingCompare<Compare, typename std::iterator_traits<Iter>::value_type>::value>
+    {
+    };
+
+    // Arithmetic keys under the default ordering can be radix sorted
+    template <typename Iter, typename Compare, typename Projection>
+    struct UsesRadixSort
+        : std::integral_constant<bool, IsRadixKey<typename SortKey<Iter, Projection>::Type>::value &&
+                                           IsAscendingCompare<Compare, typename SortKey<Iter, Projection>::Type>::value>
+    {
+    };
+
+    template <typename Iter, typename Compare, typename Projection>
+    static void sort(Iter first, Iter last, Compare &comp, Projection &proj, std::true_type radix);
+    template <typename Iter, typename Compare, typename Projection>
+    static void sort(Iter first, Iter last, Compare &comp, Projection &proj, std::false_type radix);
+    template <typename Iter, typename Compare, typename Projection>
+    static void stableSort(Iter first, Iter last, Compare &comp, Projection &proj, std::true_type radix);
+    template <typename Iter, typename Compare, typename Projection>
+    static void stableSort(Iter first, Iter last, Compare &comp, Projection &proj, std::false_type radix);
+
+    // Leaf kernels: untraced int sorts finish short ranges with the
+    // branch-free sorting network; everything else keeps insertion sort
+    template <typename Iter, typename Compare, typename Tracer>
+    static int leafThreshold()
+    {
+        return UsesSortingNetwork<Iter, Compare, Tracer>::value ? NETWORK_SORT_THRESHOLD
+                                                                : INSERTION_SORT_THRESHOLD;
+    }
+
+    template <typename Iter, typename Compare, typename Tracer>
+    static void leafSort(Iter arr, int begin, int end, bool leftmost, Compare &comp, Tracer &tracer,
+                         std::false_type)
+    {
+        if (leftmost)
+            guardedInsertionSort(arr, begin, end, comp, tracer);
+        else
+            unguardedInsertionSort(arr, begin, end, comp, tracer);
+    }
+    template <typename Iter, typename Compare, typename Tracer>
+    static void leafSort(Iter arr, int begin, int end, bool leftmost, Compare &comp, Tracer &tracer,
+                         std::true_type)
+    {
+        if (end - begin > SortingNetwork::MAX_SIZE)
+            leafSort(arr, begin, end, leftmost, comp, tracer, std::false_type());
+        else if (end - begin > 1)
+            SortingNetwork::sort(&arr[begin], end - begin);
+    }
+
+    // Sort arr[begin, end) to extend a natural run of merge sort. The network
+    // is not stable, which cannot be observed when sorting plain ints.
+    template <typename Iter, typename Compare, typename Tracer>
+    static void extendRun(Iter arr, int begin, int end, Compare &comp, Tracer &tracer,
+                          std::false_type)
+    {
+        guardedInsertionSort(arr, begin, end, comp, tracer);
+    }
+    template <typename Iter, typename Compare, typename Tracer>
+    static void extendRun(Iter arr, int begin, int end, Compare &comp, Tracer &tracer,
+                          std::true_type)
+    {
+        if (end - begin > SortingNetwork::MAX_SIZE)
+            guardedInsertionSort(arr, begin, end, comp, tracer);
+        else
+            SortingNetwork::sort(&arr[begin], end - begin);
+    }
+
+    static int floorLog2(int n)
+    {
+        int log = 0;
+        while (n >>= 1)
+            log++;
+        return log;
+    }
+
+    template <typename Iter, typename Compare, typename Tracer>
+    static void bubblePasses(Iter arr, int n, Compare &comp, Tracer &tracer);
+
+    template <typename Iter, typename Compare, typename Tracer>
+    static void introSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer,
+                          int insertionThreshold);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void introSortLoop(Iter arr, int begin, int end, int badAllowed, bool leftmost,
+                              int insertionThreshold, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void sort2(Iter arr, int i, int j, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void sort3(Iter arr, int i, int j, int k, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void guardedInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void unguardedInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static bool partialInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static std::pair<int, bool> partitionRight(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static int partitionLeft(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void selectPivot(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Tracer>
+    static void swapOffsets(Iter arr, int baseL, int baseR,
+                            const unsigned char *offsetsL, const unsigned char *offsetsR,
+                            int num, bool useSwaps, Tracer &tracer);
+
+    template <typename Iter, typename Compare, typename Tracer>
+    static void naturalMergeSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer, int minRun);
+    template <typename Iter, typename Compare, typename Tracer>
+    static int countRun(Iter arr, int begin, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Pred>
+    static int gallop(Iter first, int len, Pred pred);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void mergeAt(Iter arr, int base1, int len1, int base2, int len2,
+                        typename std::iterator_traits<Iter>::value_type *scratch,
+                        Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void mergeLow(Iter arr, int base1, int len1, int base2, int len2,
+                         typename std::iterator_traits<Iter>::value_type *scratch,
+                         Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void mergeHigh(Iter arr, int base1, int len1, int base2, int len2,
+                          typename std::iterator_traits<Iter>::value_type *scratch,
+                          Compare &comp, Tracer &tracer);
+    static int computeMinRun(int n)
+    {
+        // TimSort's choice: n / 2^k rounded up, in [32, 64), so the run count is
+        // a power of two or just below one and merges stay balanced
+        int r = 0;
+        while (n >= 64)
+        {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    template <int Arity, typename Iter, typename Compare, typename Tracer>
+    static void heapSortRange(Iter arr, int first, int last, Compare &comp, Tracer &tracer, std::true_type bySize);
+    template <int Arity, typename Iter, typename Compare, typename Tracer>
+    static void heapSortRange(Iter arr, int first, int last, Compare &comp, Tracer &tracer, std::false_type)
+    {
+        heapSortRange<Arity>(arr, first, last, comp, tracer);
+    }
+    template <int Arity, typename Iter, typename Compare, typename Tracer>
+    static void heapSortRange(Iter arr, int first, int last, Compare &comp, Tracer &tracer);
+    template <int Arity, typename Iter, typename Compare, typename Tracer>
+    static void buildHeap(Iter arr, int first, int n, Compare &comp, Tracer &tracer);
+    template <int Arity, typename Iter, typename Compare, typename Tracer>
+    static void siftDown(Iter arr, int first, int n, int i, Compare &comp, Tracer &tracer);
+
+    template <typename Iter, typename Compare, typename Tracer>
+    static void introSelect(Iter arr, int begin, int nth, int end, Compare &comp, Tracer &tracer);
+    template <typename Iter, typename Compare, typename Tracer>
+    static void heapSelect(Iter arr, int begin, int middle, int end, Compare &comp, Tracer &tracer);
+};
+
+// ==================== GENERIC FRONT END ====================
+
+// Sort [first, last) by comp(proj(a), proj(b)); radix sort for arithmetic
+// keys under the default ordering, introsort otherwise
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::sort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    sort(first, last, comp, proj, UsesRadixSort<Iter, Compare, Projection>());
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::sort(Iter first, Iter last, Compare &comp, Projection &proj, std::true_type)
+{
+    if (last - first < RADIX_SORT_THRESHOLD)
+        quickSort(first, last, comp, proj);
+    else
+        RadixSort::lsdSort(first, last, proj);
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::sort(Iter first, Iter last, Compare &comp, Projection &proj, std::false_type)
+{
+    quickSort(first, last, comp, proj);
+}
+
+// Like sort(), but elements with equal keys keep their order (LSD radix sort
+// is stable too)
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::stableSort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    stableSort(first, last, comp, proj, UsesRadixSort<Iter, Compare, Projection>());
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::stableSort(Iter first, Iter last, Compare &comp, Projection &proj, std::true_type)
+{
+    if (last - first < RADIX_SORT_THRESHOLD)
+        mergeSort(first, last, comp, proj);
+    else
+        RadixSort::lsdSort(first, last, proj);
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::stableSort(Iter first, Iter last, Compare &comp, Projection &proj, std::false_type)
+{
+    mergeSort(first, last, comp, proj);
+}
+
+// Each engine on a range: the projection is folded into the comparator, or
+// left out entirely when it is the identity
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::bubbleSort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    bubblePasses(first, rangeSize(first, last), order, tracer);
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::quickSort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    introSort(first, 0, rangeSize(first, last), order, tracer, 0);
+}
+
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::mergeSort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    naturalMergeSort(first, 0, rangeSize(first, last), order, tracer, 0);
+}
+
+template <int Arity, typename Iter, typename Compare, typename Projection>
+void SortEngine::heapSort(Iter first, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    heapSortRange<Arity>(first, 0, rangeSize(first, last), order, tracer,
+                         std::integral_constant<bool, Arity == HEAP_ARITY_BY_SIZE>());
+}
+
+// Rearrange [first, last) so that *nth is the element a full sort would put
+// there, nothing before it is greater and nothing after it is smaller
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::nthElement(Iter first, Iter nth, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    int n = rangeSize(first, last);
+    if (nth < last)
+        introSelect(first, 0, static_cast<int>(nth - first), n, order, tracer);
+}
+
+// Move the middle - first smallest elements to [first, middle), in no
+// particular order. Small k scan once with a heap of the k best so far;
+// larger k partition.
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::topK(Iter first, Iter middle, Iter last, Compare comp, Projection proj)
+{
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    int n = rangeSize(first, last);
+    int k = static_cast<int>(middle - first);
+    if (k <= 0 || k >= n)
+        return;
+
+    if (k <= n / HEAP_SELECT_RATIO)
+        heapSelect(first, 0, k, n, order, tracer);
+    else
+        introSelect(first, 0, k - 1, n, order, tracer);
+}
+
+// Sort the middle - first smallest elements into [first, middle); the order
+// of the rest is unspecified
+template <typename Iter, typename Compare, typename Projection>
+void SortEngine::partialSort(Iter first, Iter middle, Iter last, Compare comp, Projection proj)
+{
+    topK(first, middle, last, comp, proj);
+
+    typename SortComparator<Compare, Projection>::Type order = SortComparator<Compare, Projection>::make(comp, proj);
+    NullTracer tracer;
+    introSort(first, 0, rangeSize(first, middle), order, tracer, 0);
+}
+
+// ==================== BUBBLE SORT ====================
+
+template <typename Tracer>
+void SortEngine::bubbleSort(std::vector<int> &arr, Tracer &tracer)
+{
+    SortLess comp;
+    bubblePasses(arr.begin(), rangeSize(arr.begin(), arr.end()), comp, tracer);
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::bubblePasses(Iter arr, int n, Compare &comp, Tracer &tracer)
+{
+    for (int i = 0; i < n - 1; i++)
+    {
+        bool swapped = false;
+        tracer.event(SORT_PASS, i);
+
+        for (int j = 0; j < n - i - 1; j++)
+        {
+            if (less(arr[j + 1], arr[j], comp, tracer))
+            {
+                std::swap(arr[j], arr[j + 1]);
+                tracer.swap(j, j + 1);
+                swapped = true;
+                tracer.event(SORT_SWAPPED, j, j + 1);
+            }
+        }
+
+        if (!swapped)
+        {
+            tracer.event(SORT_SORTED_EARLY);
+            break;
+        }
+    }
+}
+
+// ==================== QUICK SORT ====================
+// Pattern-defeating quicksort (after Orson Peters' pdqsort): median-of-3 or
+// ninther pivots, insertion sort for small ranges, a branchless block
+// partition (Edelkamp & Weiss, BlockQuicksort), and a heap sort fallback once
+// too many unbalanced partitions have been seen, so the worst case is O(n log n).
+
+template <typename Tracer>
+void SortEngine::quickSort(std::vector<int> &arr, int low, int high, Tracer &tracer, int insertionThreshold)
+{
+    SortLess comp;
+    introSort(arr.begin(), low, high + 1, comp, tracer, insertionThreshold);
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::introSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer, int insertionThreshold)
+{
+    if (end - begin < 2)
+        return;
+
+    if (insertionThreshold <= 0)
+        insertionThreshold = leafThreshold<Iter, Compare, Tracer>();
+    if (insertionThreshold < MIN_INSERTION_THRESHOLD)
+        insertionThreshold = MIN_INSERTION_THRESHOLD;
+
+    introSortLoop(arr, begin, end, floorLog2(end - begin), true, insertionThreshold, comp, tracer);
+}
+
+template <typename Tracer>
+int SortEngine::partition(std::vector<int> &arr, int low, int high, Tracer &tracer)
+{
+    SortLess comp;
+    int size = high - low + 1;
+    if (size < 3)
+    {
+        if (size == 2)
+            sort2(arr.begin(), low, high, comp, tracer);
+        return low;
+    }
+
+    // Move the median of three (or the ninther) to arr[low] and partition around it
+    int mid = low + size / 2;
+    if (size > NINTHER_THRESHOLD)
+    {
+        sort3(arr.begin(), low, mid, high, comp, tracer);
+        sort3(arr.begin(), low + 1, mid - 1, high - 1, comp, tracer);
+        sort3(arr.begin(), low + 2, mid + 1, high - 2, comp, tracer);
+        sort3(arr.begin(), mid - 1, mid, mid + 1, comp, tracer);
+        std::swap(arr[low], arr[mid]);
+        tracer.swap(low, mid);
+    }
+    else
+    {
+        sort3(arr.begin(), mid, low, high, comp, tracer);
+    }
+
+    tracer.event(SORT_PARTITION_BEGIN, low);
+    return partitionRight(arr.begin(), low, high + 1, comp, tracer).first;
+}
+
+template <typename Tracer>
+void SortEngine::insertionSort(std::vector<int> &arr, int low, int high, Tracer &tracer)
+{
+    SortLess comp;
+    guardedInsertionSort(arr.begin(), low, high + 1, comp, tracer);
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::guardedInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    for (int i = begin + 1; i < end; i++)
+    {
+        int j = i - 1;
+
+        if (less(arr[i], arr[j], comp, tracer))
+        {
+            Value key = std::move(arr[i]);
+            do
+            {
+                arr[j + 1] = std::move(arr[j]);
+                tracer.move();
+                j--;
+            } while (j >= begin && less(key, arr[j], comp, tracer));
+            arr[j + 1] = std::move(key);
+            tracer.move();
+        }
+    }
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::sort2(Iter arr, int i, int j, Compare &comp, Tracer &tracer)
+{
+    if (less(arr[j], arr[i], comp, tracer))
+    {
+        std::swap(arr[i], arr[j]);
+        tracer.swap(i, j);
+    }
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::sort3(Iter arr, int i, int j, int k, Compare &comp, Tracer &tracer)
+{
+    sort2(arr, i, j, comp, tracer);
+    sort2(arr, j, k, comp, tracer);
+    sort2(arr, i, j, comp, tracer);
+}
+
+// Insertion sort of arr[begin, end) that relies on arr[begin - 1] being a
+// lower bound for the range, so the inner loop needs no bounds check
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::unguardedInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    for (int i = begin + 1; i < end; i++)
+    {
+        int j = i - 1;
+
+        if (less(arr[i], arr[j], comp, tracer))
+        {
+            Value key = std::move(arr[i]);
+            do
+            {
+                arr[j + 1] = std::move(arr[j]);
+                tracer.move();
+                j--;
+            } while (less(key, arr[j], comp, tracer));
+            arr[j + 1] = std::move(key);
+            tracer.move();
+        }
+    }
+}
+
+// Insertion sort that gives up after PARTIAL_INSERTION_LIMIT moves
+// Returns true if arr[begin, end) ended up sorted
+template <typename Iter, typename Compare, typename Tracer>
+bool SortEngine::partialInsertionSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    int moves = 0;
+    for (int i = begin + 1; i < end; i++)
+    {
+        int j = i - 1;
+
+        if (less(arr[i], arr[j], comp, tracer))
+        {
+            Value key = std::move(arr[i]);
+            do
+            {
+                arr[j + 1] = std::move(arr[j]);
+                tracer.move();
+                j--;
+            } while (j >= begin && less(key, arr[j], comp, tracer));
+            arr[j + 1] = std::move(key);
+            tracer.move();
+            moves += i - (j + 1);
+        }
+
+        if (moves > PARTIAL_INSERTION_LIMIT)
+            return false;
+    }
+    return true;
+}
+
+// Partition arr[begin, end) around the pivot stored in arr[begin]; elements
+// equal to the pivot end up on the right. Returns the final pivot position and
+// whether the range was already partitioned (no element had to move).
+template <typename Iter, typename Compare, typename Tracer>
+std::pair<int, bool> SortEngine::partitionRight(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    Value pivot = std::move(arr[begin]);
+    int first = begin;
+    int last = end;
+
+    // Find the first element >= pivot (pivot selection guarantees one exists)
+    while (less(arr[++first], pivot, comp, tracer))
+        ;
+
+    // Find the last element < pivot, guarded only if nothing precedes arr[first]
+    if (first - 1 == begin)
+        while (first < last && !less(arr[--last], pivot, comp, tracer))
+            ;
+    else
+        while (!less(arr[--last], pivot, comp, tracer))
+            ;
+
+    bool alreadyPartitioned = first >= last;
+    if (!alreadyPartitioned && !UsesBlockPartition<Iter, Compare>::value)
+    {
+        // Expensive comparisons: classic Hoare loop, each comparison decides
+        // a branch but none is repeated
+        while (first < last)
+        {
+            std::swap(arr[first], arr[last]);
+            tracer.swap(first, last);
+            while (less(arr[++first], pivot, comp, tracer))
+                ;
+            while (!less(arr[--last], pivot, comp, tracer))
+                ;
+        }
+    }
+    else if (!alreadyPartitioned)
+    {
+        std::swap(arr[first], arr[last]);
+        tracer.swap(first, last);
+        ++first;
+
+        // Record the offsets of misplaced elements a block at a time without
+        // branching on the comparison, then swap them pairwise
+        alignas(64) unsigned char offsetsL[PARTITION_BLOCK_SIZE];
+        alignas(64) unsigned char offsetsR[PARTITION_BLOCK_SIZE];
+        int baseL = first, baseR = last;
+        int numL = 0, numR = 0, startL = 0, startR = 0;
+
+        while (first < last)
+        {
+            int unknown = last - first;
+            int leftSplit = numL == 0 ? (numR == 0 ? unknown / 2 : unknown) : 0;
+            int rightSplit = numR == 0 ? (unknown - leftSplit) : 0;
+
+            if (leftSplit > PARTITION_BLOCK_SIZE)
+                leftSplit = PARTITION_BLOCK_SIZE;
+            for (int i = 0; i < leftSplit; i++)
+            {
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += !less(arr[first], pivot, comp, tracer);
+                ++first;
+            }
+
+            if (rightSplit > PARTITION_BLOCK_SIZE)
+                rightSplit = PARTITION_BLOCK_SIZE;
+            for (int i = 1; i <= rightSplit; i++)
+            {
+                offsetsR[numR] = static_cast<unsigned char>(i);
+                numR += less(arr[--last], pivot, comp, tracer);
+            }
+
+            int num = std::min(numL, numR);
+            swapOffsets(arr, baseL, baseR, offsetsL + startL, offsetsR + startR, num, numL == numR, tracer);
+            numL -= num;
+            numR -= num;
+            startL += num;
+            startR += num;
+
+            if (numL == 0)
+            {
+                startL = 0;
+                baseL = first;
+            }
+            if (numR == 0)
+            {
+                startR = 0;
+                baseR = last;
+            }
+        }
+
+        // Only one side can have leftovers; move them next to the boundary
+        if (numL)
+        {
+            while (numL--)
+            {
+                int i = baseL + offsetsL[startL + numL];
+                std::swap(arr[i], arr[--last]);
+                tracer.swap(i, last);
+            }
+            first = last;
+        }
+        if (numR)
+        {
+            while (numR--)
+            {
+                int i = baseR - offsetsR[startR + numR];
+                std::swap(arr[i], arr[first]);
+                tracer.swap(i, first);
+                ++first;
+            }
+        }
+    }
+
+    // Put the pivot in its final place
+    int pivotPos = first - 1;
+    arr[begin] = std::move(arr[pivotPos]);
+    arr[pivotPos] = std::move(pivot);
+    tracer.swap(begin, pivotPos);
+    return std::make_pair(pivotPos, alreadyPartitioned);
+}
+
+template <typename Iter, typename Tracer>
+void SortEngine::swapOffsets(Iter arr, int baseL, int baseR,
+                             const unsigned char *offsetsL, const unsigned char *offsetsR,
+                             int num, bool useSwaps, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    if (useSwaps)
+    {
+        // Plain swaps keep descending inputs linear
+        for (int i = 0; i < num; i++)
+        {
+            int l = baseL + offsetsL[i];
+            int r = baseR - offsetsR[i];
+            std::swap(arr[l], arr[r]);
+            tracer.swap(l, r);
+        }
+    }
+    else if (num > 0)
+    {
+        // Cycle the misplaced elements through a single temporary
+        int l = baseL + offsetsL[0];
+        int r = baseR - offsetsR[0];
+        Value tmp = std::move(arr[l]);
+        arr[l] = std::move(arr[r]);
+        tracer.move();
+        for (int i = 1; i < num; i++)
+        {
+            l = baseL + offsetsL[i];
+            arr[r] = std::move(arr[l]);
+            r = baseR - offsetsR[i];
+            arr[l] = std::move(arr[r]);
+            tracer.move();
+            tracer.move();
+        }
+        arr[r] = std::move(tmp);
+        tracer.move();
+    }
+}
+
+// Partition arr[begin, end) so that elements equal to the pivot in arr[begin]
+// go left. Used when the pivot equals the element just before the range, which
+// means everything equal to it is already in its final place.
+template <typename Iter, typename Compare, typename Tracer>
+int SortEngine::partitionLeft(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    Value pivot = std::move(arr[begin]);
+    int first = begin;
+    int last = end;
+
+    while (less(pivot, arr[--last], comp, tracer))
+        ;
+
+    if (last + 1 == end)
+        while (first < last && !less(pivot, arr[++first], comp, tracer))
+            ;
+    else
+        while (!less(pivot, arr[++first], comp, tracer))
+            ;
+
+    while (first < last)
+    {
+        std::swap(arr[first], arr[last]);
+        tracer.swap(first, last);
+        while (less(pivot, arr[--last], comp, tracer))
+            ;
+        while (!less(pivot, arr[++first], comp, tracer))
+            ;
+    }
+
+    arr[begin] = std::move(arr[last]);
+    arr[last] = std::move(pivot);
+    tracer.swap(begin, last);
+    return last;
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::introSortLoop(Iter arr, int begin, int end, int badAllowed, bool leftmost,
+                               int insertionThreshold, Compare &comp, Tracer &tracer)
+{
+    while (true)
+    {
+        int size = end - begin;
+
+        if (size < insertionThreshold)
+        {
+            tracer.event(SORT_INSERTION, begin, end - 1);
+            leafSort(arr, begin, end, leftmost, comp, tracer, UsesSortingNetwork<Iter, Compare, Tracer>());
+            return;
+        }
+
+        // Pivot selection leaves the pivot in arr[begin]
+        selectPivot(arr, begin, end, comp, tracer);
+        tracer.event(SORT_PARTITION_BEGIN, begin);
+
+        // A pivot equal to the element before this range means the range starts
+        // with duplicates of it; split those off and keep sorting the rest
+        if (!leftmost && !less(arr[begin - 1], arr[begin], comp, tracer))
+        {
+            int pivotPos = partitionLeft(arr, begin, end, comp, tracer);
+            tracer.event(SORT_PARTITIONED, pivotPos);
+            begin = pivotPos + 1;
+            continue;
+        }
+
+        std::pair<int, bool> result = partitionRight(arr, begin, end, comp, tracer);
+        int pivotPos = result.first;
+        bool alreadyPartitioned = result.second;
+        tracer.event(SORT_PARTITIONED, pivotPos);
+
+        int leftSize = pivotPos - begin;
+        int rightSize = end - (pivotPos + 1);
+        bool highlyUnbalanced = leftSize < size / 8 || rightSize < size / 8;
+
+        if (highlyUnbalanced)
+        {
+            // Too many bad pivots: finish this range with heap sort
+            if (--badAllowed == 0)
+            {
+                tracer.event(SORT_DEPTH_LIMIT, begin, end - 1);
+                heapSortRange<HEAP_ARITY_BY_SIZE>(arr, begin, end, comp, tracer, std::true_type());
+                return;
+            }
+
+            // Swap a few elements around to break up adversarial patterns
+            if (leftSize >= INSERTION_SORT_THRESHOLD)
+            {
+                std::swap(arr[begin], arr[begin + leftSize / 4]);
+                std::swap(arr[pivotPos - 1], arr[pivotPos - leftSize / 4]);
+                if (leftSize > NINTHER_THRESHOLD)
+                {
+                    std::swap(arr[begin + 1], arr[begin + leftSize / 4 + 1]);
+                    std::swap(arr[begin + 2], arr[begin + leftSize / 4 + 2]);
+                    std::swap(arr[pivotPos - 2], arr[pivotPos - (leftSize / 4 + 1)]);
+                    std::swap(arr[pivotPos - 3], arr[pivotPos - (leftSize / 4 + 2)]);
+                }
+            }
+            if (rightSize >= INSERTION_SORT_THRESHOLD)
+            {
+                std::swap(arr[pivotPos + 1], arr[pivotPos + 1 + rightSize / 4]);
+                std::swap(arr[end - 1], arr[end - rightSize / 4]);
+                if (rightSize > NINTHER_THRESHOLD)
+                {
+                    std::swap(arr[pivotPos + 2], arr[pivotPos + 2 + rightSize / 4]);
+                    std::swap(arr[pivotPos + 3], arr[pivotPos + 3 + rightSize / 4]);
+                    std::swap(arr[end - 2], arr[end - (1 + rightSize / 4)]);
+                    std::swap(arr[end - 3], arr[end - (2 + rightSize / 4)]);
+                }
+            }
+        }
+        else if (alreadyPartitioned && partialInsertionSort(arr, begin, pivotPos, comp, tracer) &&
+                 partialInsertionSort(arr, pivotPos + 1, end, comp, tracer))
+        {
+            // A balanced partition that moved nothing suggests presorted input
+            tracer.event(SORT_INSERTION, begin, end - 1);
+            return;
+        }
+
+        // Recurse into the smaller side and loop on the larger one, so the
+        // stack depth stays O(log n)
+        if (leftSize < rightSize)
+        {
+            introSortLoop(arr, begin, pivotPos, badAllowed, leftmost, insertionThreshold, comp, tracer);
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+        else
+        {
+            introSortLoop(arr, pivotPos + 1, end, badAllowed, false, insertionThreshold, comp, tracer);
+            end = pivotPos;
+        }
+    }
+}
+
+// Median of 3, or Tukey's ninther for large ranges, moved to arr[begin]
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::selectPivot(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    int size = end - begin;
+    int half = size / 2;
+    if (size > NINTHER_THRESHOLD)
+    {
+        sort3(arr, begin, begin + half, end - 1, comp, tracer);
+        sort3(arr, begin + 1, begin + half - 1, end - 2, comp, tracer);
+        sort3(arr, begin + 2, begin + half + 1, end - 3, comp, tracer);
+        sort3(arr, begin + half - 1, begin + half, begin + half + 1, comp, tracer);
+        std::swap(arr[begin], arr[begin + half]);
+        tracer.swap(begin, begin + half);
+    }
+    else
+    {
+        sort3(arr, begin + half, begin, end - 1, comp, tracer);
+    }
+}
+
+// ==================== MERGE SORT ====================
+// Natural merge sort in the style of TimSort: existing ascending runs are kept,
+// strictly descending runs are reversed, short runs are extended to minRun by
+// insertion sort, and a stack of pending runs is merged in balanced order.
+// Each merge copies only the shorter run into one scratch buffer allocated up
+// front, and switches to galloping (exponential search) when one run keeps
+// winning, so appending a few values to a sorted array costs close to O(n).
+
+template <typename Tracer>
+void SortEngine::mergeSort(std::vector<int> &arr, int left, int right, Tracer &tracer, int minRun)
+{
+    SortLess comp;
+    naturalMergeSort(arr.begin(), left, right + 1, comp, tracer, minRun);
+}
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::naturalMergeSort(Iter arr, int begin, int end, Compare &comp, Tracer &tracer, int minRun)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    int n = end - begin;
+    if (n < 2)
+        return;
+
+    if (minRun <= 0)
+        minRun = computeMinRun(n);
+
+    // The shorter run of any merge holds at most half of the elements
+    std::vector<Value> scratch(n / 2);
+
+    int runBase[RUN_STACK_SIZE];
+    int runLen[RUN_STACK_SIZE];
+    int stackSize = 0;
+
+    while (begin < end)
+    {
+        int runEnd = countRun(arr, begin, end, comp, tracer);
+
+        // Extend short runs with insertion sort (stable, prefix already sorted)
+        int forcedEnd = std::min(begin + minRun, end);
+        if (runEnd < forcedEnd)
+        {
+            extendRun(arr, begin, forcedEnd, comp, tracer, UsesSortingNetwork<Iter, Compare, Tracer>());
+            runEnd = forcedEnd;
+        }
+        tracer.event(SORT_RUN, begin, runEnd - 1);
+
+        runBase[stackSize] = begin;
+        runLen[stackSize] = runEnd - begin;
+        stackSize++;
+        begin = runEnd;
+
+        // Merge until the run lengths on the stack decrease faster than
+        // Fibonacci numbers, which bounds the stack depth and keeps merges balanced
+        while (stackSize > 1)
+        {
+            int i = stackSize - 2;
+            if ((i > 0 && runLen[i - 1] <= runLen[i] + runLen[i + 1]) ||
+                (i > 1 && runLen[i - 2] <= runLen[i - 1] + runLen[i]))
+            {
+                if (runLen[i - 1] < runLen[i + 1])
+                    i--;
+            }
+            else if (runLen[i] > runLen[i + 1])
+            {
+                break;
+            }
+
+            mergeAt(arr, runBase[i], runLen[i], runBase[i + 1], runLen[i + 1], scratch.data(), comp, tracer);
+            runLen[i] += runLen[i + 1];
+            for (int k = i + 1; k < stackSize - 1; k++)
+            {
+                runBase[k] = runBase[k + 1];
+                runLen[k] = runLen[k + 1];
+            }
+            stackSize--;
+        }
+    }
+
+    // Merge whatever is left, smallest neighbours first
+    while (stackSize > 1)
+    {
+        int i = stackSize - 2;
+        if (i > 0 && runLen[i - 1] < runLen[i + 1])
+            i--;
+
+        mergeAt(arr, runBase[i], runLen[i], runBase[i + 1], runLen[i + 1], scratch.data(), comp, tracer);
+        runLen[i] += runLen[i + 1];
+        for (int k = i + 1; k < stackSize - 1; k++)
+        {
+            runBase[k] = runBase[k + 1];
+            runLen[k] = runLen[k + 1];
+        }
+        stackSize--;
+    }
+}
+
+// Merge the sorted ranges arr[left..mid] and arr[mid+1..right]
+template <typename Tracer>
+void SortEngine::merge(std::vector<int> &arr, int left, int mid, int right, Tracer &tracer)
+{
+    int len1 = mid - left + 1;
+    int len2 = right - mid;
+    if (len1 <= 0 || len2 <= 0)
+        return;
+
+    SortLess comp;
+    std::vector<int> scratch(std::min(len1, len2));
+    mergeAt(arr.begin(), left, len1, mid + 1, len2, scratch.data(), comp, tracer);
+}
+
+// Return the end of the run starting at arr[begin], reversing it if it is
+// strictly descending (strict so that equal elements keep their order)
+template <typename Iter, typename Compare, typename Tracer>
+int SortEngine::countRun(Iter arr, int begin, int end, Compare &comp, Tracer &tracer)
+{
+    int runEnd = begin + 1;
+    if (runEnd == end)
+        return end;
+
+    if (less(arr[runEnd], arr[begin], comp, tracer))
+    {
+        runEnd++;
+        while (runEnd < end && less(arr[runEnd], arr[runEnd - 1], comp, tracer))
+            runEnd++;
+
+        for (int lo = begin, hi = runEnd - 1; lo < hi; lo++, hi--)
+        {
+            std::swap(arr[lo], arr[hi]);
+            tracer.swap(lo, hi);
+        }
+    }
+    else
+    {
+        runEnd++;
+        while (runEnd < end && !less(arr[runEnd], arr[runEnd - 1], comp, tracer))
+            runEnd++;
+    }
+    return runEnd;
+}
+
+// Length of the prefix of first[0..len) on which pred holds, where pred is
+// true up to some point and false after it. Probes 1, 3, 7, ... elements
+// ahead before binary searching, so short answers cost O(log answer).
+template <typename Iter, typename Pred>
+int SortEngine::gallop(Iter first, int len, Pred pred)
+{
+    if (len == 0 || !pred(first[0]))
+        return 0;
+
+    int lastOfs = 0;
+    int ofs = 1;
+    while (ofs < len && pred(first[ofs]))
+    {
+        lastOfs = ofs;
+        ofs = 2 * ofs + 1;
+    }
+    if (ofs > len)
+        ofs = len;
+
+    // pred(first[lastOfs]) holds, pred(first[ofs]) does not (or ofs == len)
+    int lo = lastOfs + 1;
+    int hi = ofs;
+    while (lo < hi)
+    {
+        int m = lo + (hi - lo) / 2;
+        if (pred(first[m]))
+            lo = m + 1;
+        else
+            hi = m;
+    }
+    return lo;
+}
+
+// Merge the adjacent sorted runs arr[base1, base1 + len1) and arr[base2, base2 + len2)
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::mergeAt(Iter arr, int base1, int len1, int base2, int len2,
+                         typename std::iterator_traits<Iter>::value_type *scratch,
+                         Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    int left = base1;
+    int right = base2 + len2 - 1;
+
+    // Elements of run 1 not greater than run 2's first element are already in place
+    const Value &first2 = arr[base2];
+    int skip = gallop(arr + base1, len1, [&](const Value &x) { return !less(first2, x, comp, tracer); });
+    base1 += skip;
+    len1 -= skip;
+
+    if (len1 > 0)
+    {
+        // Likewise elements of run 2 not less than run 1's last element
+        const Value &last1 = arr[base1 + len1 - 1];
+        len2 -= gallop(std::reverse_iterator<Iter>(arr + base2 + len2), len2,
+                       [&](const Value &x) { return !less(x, last1, comp, tracer); });
+
+        if (len2 > 0)
+        {
+            if (len1 <= len2)
+                mergeLow(arr, base1, len1, base2, len2, scratch, comp, tracer);
+            else
+                mergeHigh(arr, base1, len1, base2, len2, scratch, comp, tracer);
+        }
+    }
+
+    tracer.event(SORT_MERGED, left, base2 - 1, right);
+}
+
+// Merge front to back with run 1 moved to scratch (len1 <= len2)
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::mergeLow(Iter arr, int base1, int len1, int base2, int len2,
+                          typename std::iterator_traits<Iter>::value_type *scratch,
+                          Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    Value *a = scratch;
+    Iter b = arr + base2;
+    Iter dst = arr + base1;
+
+    for (int i = 0; i < len1; i++)
+    {
+        a[i] = std::move(dst[i]);
+        tracer.move();
+    }
+
+    int i = 0, j = 0, k = 0;
+    while (i < len1 && j < len2)
+    {
+        // One element at a time until one run wins MIN_GALLOP times in a row;
+        // written without branches on the comparison, which is unpredictable
+        int winsA = 0, winsB = 0;
+        while (i < len1 && j < len2 && winsA < MIN_GALLOP && winsB < MIN_GALLOP)
+        {
+            bool takeB = less(b[j], a[i], comp, tracer);
+            dst[k++] = std::move(takeB ? b[j] : a[i]);
+            j += takeB;
+            i += !takeB;
+            winsB = takeB ? winsB + 1 : 0;
+            winsA = takeB ? 0 : winsA + 1;
+            tracer.move();
+        }
+
+        // Galloping: move whole stretches found by exponential search
+        while (i < len1 && j < len2)
+        {
+            const Value &keyB = b[j];
+            int countA = gallop(a + i, len1 - i, [&](const Value &x) { return !less(keyB, x, comp, tracer); });
+            for (int c = 0; c < countA; c++)
+            {
+                dst[k++] = std::move(a[i++]);
+                tracer.move();
+            }
+            if (i == len1)
+                break;
+
+            dst[k++] = std::move(b[j++]);
+            tracer.move();
+            if (j == len2)
+                break;
+
+            const Value &keyA = a[i];
+            int countB = gallop(b + j, len2 - j, [&](const Value &x) { return less(x, keyA, comp, tracer); });
+            for (int c = 0; c < countB; c++)
+            {
+                dst[k++] = std::move(b[j++]);
+                tracer.move();
+            }
+            if (j == len2)
+                break;
+
+            dst[k++] = std::move(a[i++]);
+            tracer.move();
+
+            if (countA < MIN_GALLOP && countB < MIN_GALLOP)
+                break;
+        }
+    }
+
+    // Leftovers of run 2 are already in place
+    while (i < len1)
+    {
+        dst[k++] = std::move(a[i++]);
+        tracer.move();
+    }
+}
+
+// Merge back to front with run 2 moved to scratch (len2 < len1)
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::mergeHigh(Iter arr, int base1, int len1, int base2, int len2,
+                           typename std::iterator_traits<Iter>::value_type *scratch,
+                           Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    Iter a = arr + base1;
+    Value *b = scratch;
+    Iter dst = arr + base1;
+
+    for (int j = 0; j < len2; j++)
+    {
+        b[j] = std::move(arr[base2 + j]);
+        tracer.move();
+    }
+
+    int i = len1 - 1, j = len2 - 1, k = len1 + len2 - 1;
+    while (i >= 0 && j >= 0)
+    {
+        // One element at a time until one run wins MIN_GALLOP times in a row;
+        // on ties run 2 goes last, which keeps the merge stable
+        int winsA = 0, winsB = 0;
+        while (i >= 0 && j >= 0 && winsA < MIN_GALLOP && winsB < MIN_GALLOP)
+        {
+            bool takeA = less(b[j], a[i], comp, tracer);
+            dst[k--] = std::move(takeA ? a[i] : b[j]);
+            i -= takeA;
+            j -= !takeA;
+            winsA = takeA ? winsA + 1 : 0;
+            winsB = takeA ? 0 : winsB + 1;
+            tracer.move();
+        }
+
+        while (i >= 0 && j >= 0)
+        {
+            const Value &keyB = b[j];
+            int countA = gallop(std::reverse_iterator<Iter>(a + i + 1), i + 1,
+                                [&](const Value &x) { return less(keyB, x, comp, tracer); });
+            for (int c = 0; c < countA; c++)
+            {
+                dst[k--] = std::move(a[i--]);
+                tracer.move();
+            }
+            if (i < 0)
+                break;
+
+            dst[k--] = std::move(b[j--]);
+            tracer.move();
+            if (j < 0)
+                break;
+
+            const Value &keyA = a[i];
+            int countB = gallop(std::reverse_iterator<Value *>(b + j + 1), j + 1,
+                                [&](const Value &x) { return !less(x, keyA, comp, tracer); });
+            for (int c = 0; c < countB; c++)
+            {
+                dst[k--] = std::move(b[j--]);
+                tracer.move();
+            }
+            if (j < 0)
+                break;
+
+            dst[k--] = std::move(a[i--]);
+            tracer.move();
+
+            if (countA < MIN_GALLOP && countB < MIN_GALLOP)
+                break;
+        }
+    }
+
+    // Leftovers of run 1 are already in place
+    while (j >= 0)
+    {
+        dst[k--] = std::move(b[j--]);
+        tracer.move();
+    }
+}
+
+// ==================== HEAP SORT ====================
+// Heap sort on an Arity-ary max heap: node i has children Arity*i+1 ..
+// Arity*i+Arity, so the tree is log2(Arity) times shallower than a binary
+// heap and all children of a node are adjacent in memory. Sift-down uses
+// Floyd's bottom-up variant (see siftDown), which needs about
+// (Arity - 1) / log2(Arity) comparisons per binary level instead of two.
+// The shallower tree only pays once the heap no longer fits in cache: below
+// that a binary heap does fewer comparisons and moves and is faster, so
+// HEAP_ARITY_BY_SIZE (the default) switches arity at BINARY_HEAP_MAX_BYTES.
+// Random ints, ns per element (-O2, 2 MB L2, binary / 4-ary):
+//   100K 139 / 151, 1M 214 / 244, 10M 378 / 427
+
+template <int Arity, typename Tracer>
+void SortEngine::heapSort(std::vector<int> &arr, Tracer &tracer)
+{
+    SortLess comp;
+    heapSortRange<Arity>(arr.begin(), 0, rangeSize(arr.begin(), arr.end()), comp, tracer,
+                         std::integral_constant<bool, Arity == HEAP_ARITY_BY_SIZE>());
+}
+
+template <int Arity, typename Tracer>
+void SortEngine::heapSort(std::vector<int> &arr, int first, int last, Tracer &tracer)
+{
+    SortLess comp;
+    heapSortRange<Arity>(arr.begin(), first, last, comp, tracer,
+                         std::integral_constant<bool, Arity == HEAP_ARITY_BY_SIZE>());
+}
+
+template <int Arity, typename Tracer>
+void SortEngine::buildMaxHeap(std::vector<int> &arr, int first, int n, Tracer &tracer)
+{
+    SortLess comp;
+    buildHeap<Arity>(arr.begin(), first, n, comp, tracer);
+}
+
+template <int Arity, typename Tracer>
+void SortEngine::heapify(std::vector<int> &arr, int first, int n, int i, Tracer &tracer)
+{
+    SortLess comp;
+    siftDown<Arity>(arr.begin(), first, n, i, comp, tracer);
+}
+
+// Pick the arity from the size of the heap
+template <int Arity, typename Iter, typename Compare, typename Tracer>
+void SortEngine::heapSortRange(Iter arr, int first, int last, Compare &comp, Tracer &tracer, std::true_type)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    if (static_cast<std::size_t>(last - first) <= BINARY_HEAP_MAX_BYTES / sizeof(Value))
+        heapSortRange<2>(arr, first, last, comp, tracer);
+    else
+        heapSortRange<HEAP_ARITY>(arr, first, last, comp, tracer);
+}
+
+// Sort arr[first, last) with a max heap
+template <int Arity, typename Iter, typename Compare, typename Tracer>
+void SortEngine::heapSortRange(Iter arr, int first, int last, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    // For large heaps of small elements, start the heap up to Arity - 1
+    // elements late so that every group of siblings begins on a multiple of
+    // Arity elements in memory and never straddles a cache line. The skipped
+    // elements are inserted into the sorted result at the end.
+    int skip = 0;
+    if (IsContiguousIterator<Iter>::value && CACHE_LINE_SIZE % (Arity * sizeof(Value)) == 0 &&
+        last - first >= ALIGNED_HEAP_THRESHOLD)
+    {
+        std::uintptr_t index = reinterpret_cast<std::uintptr_t>(&arr[first]) / sizeof(Value);
+        skip = static_cast<int>((Arity - (index + 1) % Arity) % Arity);
+    }
+
+    int root = first + skip;
+    int n = last - root;
+
+    tracer.event(SORT_HEAP_BUILD);
+    buildHeap<Arity>(arr, root, n, comp, tracer);
+    tracer.event(SORT_HEAP_BUILT);
+
+    // Extract elements from heap one by one
+    tracer.event(SORT_HEAP_EXTRACT);
+    for (int i = n - 1; i > 0; i--)
+    {
+        // Move current root to end
+        std::swap(arr[root], arr[root + i]);
+        tracer.swap(root, root + i);
+        tracer.event(SORT_HEAP_MOVED, root + i);
+
+        // Restore the heap property on the reduced heap
+        siftDown<Arity>(arr, root, i, 0, comp, tracer);
+        tracer.event(SORT_HEAPIFIED, root, root + i - 1);
+    }
+
+    for (int j = root - 1; j >= first; j--)
+    {
+        Value value = std::move(arr[j]);
+        int pos = static_cast<int>(std::upper_bound(arr + j + 1, arr + last, value,
+                                                    [&](const Value &a, const Value &b)
+                                                    { return less(a, b, comp, tracer); }) -
+                                   arr);
+        for (int k = j; k < pos - 1; k++)
+        {
+            arr[k] = std::move(arr[k + 1]);
+            tracer.move();
+        }
+        arr[pos - 1] = std::move(value);
+    }
+}
+
+template <int Arity, typename Iter, typename Compare, typename Tracer>
+void SortEngine::buildHeap(Iter arr, int first, int n, Compare &comp, Tracer &tracer)
+{
+    // Start from the last non-leaf node and sift each node down
+    for (int i = (n - 2) / Arity; n > 1 && i >= 0; i--)
+    {
+        siftDown<Arity>(arr, first, n, i, comp, tracer);
+    }
+}
+
+// Sift-down of node i in the heap stored at arr[first, first + n), bottom-up
+// (Floyd): the hole left by arr[i] first walks down along the largest child
+// all the way to a leaf, without comparing against the sifted value, and the
+// value then climbs back up from there. Values sifted during heap sort come
+// from the bottom of the heap, so the climb is usually only a level or two.
+template <int Arity, typename Iter, typename Compare, typename Tracer>
+void SortEngine::siftDown(Iter arr, int first, int n, int i, Compare &comp, Tracer &tracer)
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+
+    if (n < 2)
+        return;
+
+    Iter heap = arr + first;
+    Value value = std::move(heap[i]);
+    int hole = i;
+
+    while (true)
+    {
+        int child = Arity * hole + 1;
+        if (child >= n)
+            break;
+
+        int best = child;
+        if (child + Arity <= n)
+        {
+            for (int c = child + 1; c < child + Arity; c++)
+                best = less(heap[best], heap[c], comp, tracer) ? c : best;
+        }
+        else
+        {
+            for (int c = child + 1; c < n; c++)
+                best = less(heap[best], heap[c], comp, tracer) ? c : best;
+        }
+
+        heap[hole] = std::move(heap[best]);
+        tracer.move();
+        hole = best;
+    }
+
+    while (hole > i)
+    {
+        int parent = (hole - 1) / Arity;
+        if (!less(heap[parent], value, comp, tracer))
+            break;
+        heap[hole] = std::move(heap[parent]);
+        tracer.move();
+        hole = parent;
+    }
+    heap[hole] = std::move(value);
+}
+
+// ==================== SELECTION ====================
+// Introselect: quickselect on the pdqsort partitions, descending only into
+// the side that holds nth. Large ranges choose the pivot the Floyd-Rivest
+// way, by selecting within a sample of about n^(2/3) elements around nth,
+// which puts the pivot just past nth so that the next range is small; the
+// expected cost is n + min(k, n - k) + o(n) comparisons. After too many
+// partitions that leave nth in a large side the range is heap sorted, so
+// the worst case is O(n log n).
+
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::introSelect(Iter arr, int begin, int nth, int end, Compare &comp, Tracer &tracer)
+{
+    bool leftmost = true;
+    int badAllowed = floorLog2(std::max(end - begin, 1));
+
+    while (end - begin > INSERTION_SORT_THRESHOLD)
+    {
+        int size = end - begin;
+
+        // The ends are a single scan for the minimum or maximum
+        if (nth == begin || nth == end - 1)
+        {
+            int best = begin;
+            if (nth == begin)
+            {
+                for (int i = begin + 1; i < end; i++)
+                    best = less(arr[i], arr[best], comp, tracer) ? i : best;
+            }
+            else
+            {
+                for (int i = begin + 1; i < end; i++)
+                    best = less(arr[i], arr[best], comp, tracer) ? best : i;
+            }
+            std::swap(arr[nth], arr[best]);
+            tracer.swap(nth, best);
+            return;
+        }
+
+        // Pivot selection leaves the pivot in arr[begin] with an element no
+        // greater and one no smaller than it elsewhere in the range
+        if (size > FLOYD_RIVEST_THRESHOLD)
+        {
+            double n = size;
+            double i = nth - begin + 1;
+            double z = std::log(n);
+            double s = 0.5 * std::exp(2 * z / 3);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            int sampleBegin = std::max(begin, static_cast<int>(nth - i * s / n + sd));
+            int sampleEnd = std::min(end, static_cast<int>(nth + (n - i) * s / n + sd) + 1);
+
+            // Gather an evenly spaced sample into place, so that it stands for
+            // the whole range even when the input has structure
+            int stride = size / (sampleEnd - sampleBegin);
+            for (int j = sampleBegin; j < sampleEnd; j++)
+            {
+                int from = begin + (j - sampleBegin) * stride;
+                std::swap(arr[j], arr[from]);
+                tracer.swap(j, from);
+            }
+
+            introSelect(arr, sampleBegin, nth, sampleEnd, comp, tracer);
+            std::swap(arr[begin], arr[nth]);
+            tracer.swap(begin, nth);
+        }
+        else
+        {
+            selectPivot(arr, begin, end, comp, tracer);
+        }
+
+        // Duplicates of the element before the range are final, as in introsort
+        if (!leftmost && !less(arr[begin - 1], arr[begin], comp, tracer))
+        {
+            int pivotPos = partitionLeft(arr, begin, end, comp, tracer);
+            if (nth <= pivotPos)
+                return;
+            begin = pivotPos + 1;
+            continue;
+        }
+
+        int pivotPos = partitionRight(arr, begin, end, comp, tracer).first;
+        if (pivotPos == nth)
+            return;
+
+        int remaining = nth < pivotPos ? pivotPos - begin : end - (pivotPos + 1);
+        if (remaining > size - size / 8 && --badAllowed == 0)
+        {
+            tracer.event(SORT_DEPTH_LIMIT, begin, end - 1);
+            heapSortRange<HEAP_ARITY_BY_SIZE>(arr, begin, end, comp, tracer, std::true_type());
+            return;
+        }
+
+        if (nth < pivotPos)
+        {
+            end = pivotPos;
+        }
+        else
+        {
+            begin = pivotPos + 1;
+            leftmost = false;
+        }
+    }
+
+    leafSort(arr, begin, end, leftmost, comp, tracer, UsesSortingNetwork<Iter, Compare, Tracer>());
+}
+
+// Move the middle - begin smallest elements of arr[begin, end) to
+// arr[begin, middle): they are kept as a max heap, and one pass over the rest
+// replaces the heap's maximum with every smaller element. Random input needs
+// only about k ln(n / k) replacements; input that keeps replacing (close to
+// descending) is handed to introselect instead.
+template <typename Iter, typename Compare, typename Tracer>
+void SortEngine::heapSelect(Iter arr, int begin, int middle, int end, Compare &comp, Tracer &tracer)
+{
+    int k = middle - begin;
+    int replacementsAllowed = (end - begin) / 32 + 1;
+
+    buildHeap<HEAP_ARITY>(arr, begin, k, comp, tracer);
+    for (int i = middle; i < end; i++)
+    {
+        if (less(arr[i], arr[begin], comp, tracer))
+        {
+            if (--replacementsAllowed == 0)
+            {
+                introSelect(arr, begin, middle - 1, end, comp, tracer);
+                return;
+            }
+            std::swap(arr[begin], arr[i]);
+            tracer.swap(begin, i);
+            siftDown<HEAP_ARITY>(arr, begin, k, 0, comp, tracer);
+        }
+    }
+}
+
+#endif // SORT_ENGINE_H
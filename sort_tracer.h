@@ -0,0 +1,116 @@
+#ifndef SORT_TRACER_H
+#define SORT_TRACER_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+
+class FrameRenderer;
+
+/**
+ * Tracer policies for the sorting kernels in sort_engine.h
+ * A kernel reports its work through the tracer it is instantiated with:
+ *   NullTracer     - every hook is an empty inline function, so the kernel
+ *                    compiles to the bare algorithm
+ *   CountingTracer - tallies comparisons, swaps and element moves
+ *   ConsoleTracer  - the step-by-step console visualization
+ *   LiveTracer     - an animated bar chart, redrawn in place at a set speed
+ */
+
+// Milestones reported through Tracer::event (argument meaning in comments)
+enum SortEvent
+{
+    SORT_PASS,            // a: zero-based pass number
+    SORT_SWAPPED,         // a, b: indices of the adjacent pair just swapped
+    SORT_SORTED_EARLY,    // a pass finished without any swaps
+    SORT_PARTITION_BEGIN, // a: index of the pivot
+    SORT_PARTITIONED,     // a: final pivot index
+    SORT_INSERTION,       // a, b: range [a..b] finished by insertion sort
+    SORT_DEPTH_LIMIT,     // a, b: range [a..b] handed to heap sort after too many bad pivots
+    SORT_RUN,             // a, b: sorted run [a..b] found (and extended) by merge sort
+    SORT_MERGED,          // a: left, b: mid, c: right; [a..b] and [b+1..c] were merged
+    SORT_HEAP_BUILD,      // heap construction is about to start
+    SORT_HEAP_BUILT,      // heap construction finished
+    SORT_HEAP_EXTRACT,    // extraction phase is about to start
+    SORT_HEAP_MOVED,      // a: index the current maximum was moved to
+    SORT_HEAPIFIED,       // a, b: range [a..b] holding the remaining heap
+    SORT_RADIX_PASS,      // a: digit number, b: shift, c: digit width in bits
+    SORT_RADIX_BUCKETS    // a, b: range [a..b] distributed into buckets by the digit at shift c
+};
+
+// Tracer that does nothing; all calls are optimized away
+class NullTracer
+{
+public:
+    void compare() {}
+    void swap(int, int) {}
+    void move() {}
+    void event(SortEvent, int = 0, int = 0, int = 0) {}
+};
+
+// Tracer that counts the work done by a kernel
+class CountingTracer
+{
+public:
+    long long comparisons;
+    long long swaps;
+    long long moves;
+    long long events;
+
+    CountingTracer() : comparisons(0), swaps(0), moves(0), events(0) {}
+
+    void compare() { comparisons++; }
+    void swap(int, int) { swaps++; }
+    void move() { moves++; }
+    void event(SortEvent, int = 0, int = 0, int = 0) { events++; }
+
+    void reset() { comparisons = swaps = moves = events = 0; }
+};
+
+// Tracer that prints each milestone with the current array state
+// Implemented in sorting.cpp next to the rest of the visualization code
+class ConsoleTracer
+{
+private:
+    const std::vector<int> &arr;
+
+public:
+    explicit ConsoleTracer(const std::vector<int> &array) : arr(array) {}
+
+    void compare() {}
+    void swap(int, int) {}
+    void move() {}
+    void event(SortEvent ev, int a = 0, int b = 0, int c = 0);
+};
+
+// Tracer that redraws the array as a bar chart after every swap and milestone,
+// pacing the kernel to stepsPerSecond; the renderer drops the frames the
+// terminal has no time for. Implemented in sorting.cpp as well
+class LiveTracer
+{
+private:
+    const std::vector<int> &arr;
+    FrameRenderer &renderer;
+    std::string title;
+    int minValue, maxValue;
+    long long comparisons, swaps, steps;
+    std::chrono::steady_clock::duration delay;
+    std::chrono::steady_clock::time_point nextStep;
+
+    void draw(int a, int b, bool range, const std::string &caption);
+    void render(int a, int b, bool range, const std::string &caption);
+    void pace();
+
+public:
+    LiveTracer(const std::vector<int> &array, FrameRenderer &renderer, const std::string &title, int stepsPerSecond);
+
+    void compare() { comparisons++; }
+    void swap(int i, int j);
+    void move() {}
+    void event(SortEvent ev, int a = 0, int b = 0, int c = 0);
+
+    // Draw the sorted array and write the last frame
+    void finish();
+};
+
+#endif // SORT_TRACER_H
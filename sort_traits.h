@@ -0,0 +1,107 @@
+#ifndef SORT_TRAITS_H
+#define SORT_TRAITS_H
+
+#include <vector>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Comparators, key projections and compile-time traits for the generic
+ * sorting API in sort_engine.h and radix_sort.h
+ * Comparators and projections are plain function objects passed by template
+ * parameter, so every call is inlined; nothing goes through virtual calls or
+ * std::function. The traits let the engines pick a specialized kernel (radix
+ * sort, sorting networks) when the element type and comparator allow it.
+ */
+
+// Default comparator: a < b on whatever it is given
+struct SortLess
+{
+    template <typename A, typename B>
+    bool operator()(const A &a, const B &b) const
+    {
+        return a < b;
+    }
+};
+
+// Default projection: sort by the element itself
+struct SortIdentity
+{
+    template <typename T>
+    const T &operator()(const T &value) const
+    {
+        return value;
+    }
+};
+
+// Compare elements by comp(proj(a), proj(b))
+template <typename Compare, typename Projection>
+class ProjectedCompare
+{
+public:
+    ProjectedCompare(Compare comp, Projection proj) : comp(comp), proj(proj) {}
+
+    template <typename T>
+    bool operator()(const T &a, const T &b)
+    {
+        return comp(proj(a), proj(b));
+    }
+
+private:
+    Compare comp;
+    Projection proj;
+};
+
+// The comparator the kernels use for a comparator/projection pair; the
+// identity projection is dropped so that the kernels can still recognize
+// the default ordering
+template <typename Compare, typename Projection>
+struct SortComparator
+{
+    typedef ProjectedCompare<Compare, Projection> Type;
+    static Type make(Compare comp, Projection proj) { return Type(comp, proj); }
+};
+template <typename Compare>
+struct SortComparator<Compare, SortIdentity>
+{
+    typedef Compare Type;
+    static Type make(Compare comp, SortIdentity) { return comp; }
+};
+
+// Type the projection yields for the elements of Iter, without references
+template <typename Iter, typename Projection>
+struct SortKey
+{
+    typedef typename std::iterator_traits<Iter>::value_type Value;
+    typedef typename std::decay<decltype(std::declval<Projection &>()(std::declval<const Value &>()))>::type Type;
+};
+
+// Iterators over elements stored back to back, so &first[0] can be used as a pointer
+// (pointers and std::vector iterators, except the bit-packed std::vector<bool>)
+template <typename Iter, typename Value = typename std::iterator_traits<Iter>::value_type>
+struct IsContiguousIterator
+    : std::integral_constant<bool, std::is_pointer<Iter>::value ||
+                                       (!std::is_same<Value, bool>::value &&
+                                        (std::is_same<Iter, typename std::vector<Value>::iterator>::value ||
+                                         std::is_same<Iter, typename std::vector<Value>::const_iterator>::value))>
+{
+};
+
+// Comparators known to order T ascending by operator<
+template <typename Compare, typename T>
+struct IsAscendingCompare
+    : std::integral_constant<bool, std::is_same<Compare, SortLess>::value ||
+                                       std::is_same<Compare, std::less<T> >::value>
+{
+};
+
+// Keys RadixSort can handle: integers and IEEE floats of up to 64 bits
+template <typename Key>
+struct IsRadixKey
+    : std::integral_constant<bool, std::is_arithmetic<Key>::value && sizeof(Key) <= 8>
+{
+};
+
+#endif // SORT_TRAITS_H
@@ -1,9 +1,16 @@
 #include "sorting.h"
+#include "sort_engine.h"
+#include "radix_sort.h"
+#include "auto_sort.h"
+#include "external_sort.h"
+#include "trace_log.h"
+#include "renderer.h"
 #include "utils.h"
 #include <iostream>
 #include <algorithm>
 #include <thread>
 #include <chrono>
+#include <random>
 
 // Static member initialization
 int SortingAlgorithms::stepCount = 0;
@@ -27,6 +34,274 @@ void SortingAlgorithms::printStep(const std::vector<int> &arr, const std::string
     // Pause removed for compatibility
 }
 
+// Render a kernel milestone the same way the original inline visualization did
+void ConsoleTracer::event(SortEvent ev, int a, int b, int c)
+{
+    switch (ev)
+    {
+    case SORT_PASS:
+        Utils::setColor(YELLOW);
+        std::cout << "\n--- Pass " << (a + 1) << " ---" << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_SWAPPED:
+        SortingAlgorithms::incrementStep();
+        SortingAlgorithms::printStep(arr, "Swapped " + std::to_string(arr[b]) + " and " + std::to_string(arr[a]));
+        break;
+    case SORT_SORTED_EARLY:
+        Utils::setColor(LIGHT_CYAN);
+        std::cout << "No swaps needed. Array is sorted!" << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_PARTITION_BEGIN:
+        Utils::setColor(MAGENTA);
+        std::cout << "Partitioning with pivot: " << arr[a] << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_PARTITIONED:
+        Utils::setColor(YELLOW);
+        std::cout << "\nPartitioned around pivot " << arr[a]
+                  << " at index " << a << std::endl;
+        Utils::resetColor();
+        SortingAlgorithms::incrementStep();
+        SortingAlgorithms::printStep(arr, "After partitioning");
+        break;
+    case SORT_INSERTION:
+        if (a < b)
+        {
+            SortingAlgorithms::incrementStep();
+            Utils::setColor(LIGHT_BLUE);
+            std::cout << "Insertion sort on small range [" << a << ".." << b << "]" << std::endl;
+            Utils::resetColor();
+            Utils::printArrayRange(arr, a, b, "Sorted range");
+        }
+        break;
+    case SORT_DEPTH_LIMIT:
+        Utils::setColor(LIGHT_RED);
+        std::cout << "\nToo many unbalanced partitions on [" << a << ".." << b
+                  << "], switching to heap sort" << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_RUN:
+        SortingAlgorithms::incrementStep();
+        Utils::setColor(YELLOW);
+        std::cout << "\nFound sorted run [" << a << ".." << b << "]" << std::endl;
+        Utils::resetColor();
+        Utils::printArrayRange(arr, a, b, "Run");
+        break;
+    case SORT_MERGED:
+        SortingAlgorithms::incrementStep();
+        Utils::setColor(LIGHT_BLUE);
+        std::cout << "Merged subarrays [" << a << ".." << b << "] and ["
+                  << (b + 1) << ".." << c << "]" << std::endl;
+        Utils::resetColor();
+        Utils::printArrayRange(arr, a, c, "Current state");
+        break;
+    case SORT_HEAP_BUILD:
+        Utils::setColor(YELLOW);
+        std::cout << "\n--- Building Max Heap ---" << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_HEAP_BUILT:
+        SortingAlgorithms::incrementStep();
+        SortingAlgorithms::printStep(arr, "Max heap built");
+        break;
+    case SORT_HEAP_EXTRACT:
+        Utils::setColor(YELLOW);
+        std::cout << "\n--- Extracting Elements ---" << std::endl;
+        Utils::resetColor();
+        break;
+    case SORT_HEAP_MOVED:
+        SortingAlgorithms::incrementStep();
+        SortingAlgorithms::printStep(arr, "Moved max element " + std::to_string(arr[a]) + " to position " + std::to_string(a));
+        break;
+    case SORT_HEAPIFIED:
+        if (b > a)
+        {
+            SortingAlgorithms::incrementStep();
+            Utils::printArrayRange(arr, a, b, "Heap after heapify");
+        }
+        break;
+    case SORT_RADIX_PASS:
+        SortingAlgorithms::incrementStep();
+        SortingAlgorithms::printStep(arr, "Distributed by digit " + std::to_string(a) + " (bits " +
+                                              std::to_string(b) + "-" + std::to_string(b + c - 1) + ")");
+        break;
+    case SORT_RADIX_BUCKETS:
+        SortingAlgorithms::incrementStep();
+        Utils::setColor(LIGHT_BLUE);
+        std::cout << "Bucketed [" << a << ".." << b << "] by bits " << c << "-" << (c + 7) << std::endl;
+        Utils::resetColor();
+        Utils::printArrayRange(arr, a, b, "Current state");
+        break;
+    }
+}
+
+// ==================== LIVE VISUALIZATION ====================
+
+namespace
+{
+    enum
+    {
+        LIVE_ROWS = 16,    // height of the bar chart in lines
+        LIVE_COLUMNS = 80, // widest chart; longer arrays share columns
+        LIVE_VALUES = 20   // arrays up to this long also get their values printed
+    };
+}
+
+LiveTracer::LiveTracer(const std::vector<int> &array, FrameRenderer &renderer, const std::string &title,
+                       int stepsPerSecond)
+    : arr(array), renderer(renderer), title(title), minValue(0), maxValue(0), comparisons(0), swaps(0), steps(0),
+      delay(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) /
+            std::max(stepsPerSecond, 1)),
+      nextStep(std::chrono::steady_clock::now())
+{
+    if (!arr.empty())
+    {
+        auto range = std::minmax_element(arr.begin(), arr.end());
+        minValue = *range.first;
+        maxValue = *range.second;
+    }
+    render(-1, -1, false, "Initial array");
+}
+
+void LiveTracer::swap(int i, int j)
+{
+    swaps++;
+    steps++;
+    draw(i, j, false, "Swapped " + std::to_string(arr[j]) + " and " + std::to_string(arr[i]));
+}
+
+// Captions are the replay tool's, so both describe a step the same way
+void LiveTracer::event(SortEvent ev, int a, int b, int c)
+{
+    if (ev == SORT_SWAPPED)
+    {
+        return; // already drawn by swap()
+    }
+
+    int size = static_cast<int>(arr.size());
+    TraceEvent e = {0, TRACE_SORT_EVENT, static_cast<std::uint16_t>(ev), a, b, c,
+                    a >= 0 && a < size ? arr[a] : 0, b >= 0 && b < size ? arr[b] : 0};
+    std::string caption = TraceReader::describe(e);
+    steps++;
+
+    switch (ev)
+    {
+    case SORT_PARTITION_BEGIN:
+    case SORT_PARTITIONED:
+    case SORT_HEAP_MOVED:
+        draw(a, a, false, caption);
+        break;
+    case SORT_INSERTION:
+    case SORT_DEPTH_LIMIT:
+    case SORT_RUN:
+    case SORT_HEAPIFIED:
+    case SORT_RADIX_BUCKETS:
+        draw(a, b, true, caption);
+        break;
+    case SORT_MERGED:
+        draw(a, c, true, caption);
+        break;
+    default:
+        draw(-1, -1, false, caption);
+    }
+}
+
+// Draw the step if the renderer has time for it, then wait for the next one
+void LiveTracer::draw(int a, int b, bool range, const std::string &caption)
+{
+    if (renderer.frameDue())
+    {
+        render(a, b, range, caption);
+    }
+    else
+    {
+        renderer.skipFrame();
+    }
+    pace();
+}
+
+// Marks the bars of indices a and b, or of the whole range [a..b]
+void LiveTracer::render(int a, int b, bool range, const std::string &caption)
+{
+    int n = static_cast<int>(arr.size());
+    int columns = std::min(n, static_cast<int>(LIVE_COLUMNS));
+    int gap = n * 2 <= LIVE_COLUMNS ? 1 : 0;
+    long long span = static_cast<long long>(maxValue) - minValue;
+
+    // Column col shows element col * n / columns and stands for the elements up to the next one
+    int heights[LIVE_COLUMNS];
+    bool marked[LIVE_COLUMNS];
+    for (int col = 0; col < columns; col++)
+    {
+        int first = static_cast<int>(static_cast<long long>(col) * n / columns);
+        int last = static_cast<int>(static_cast<long long>(col + 1) * n / columns) - 1;
+        heights[col] = span == 0 ? LIVE_ROWS / 2
+                                 : 1 + static_cast<int>((static_cast<long long>(arr[first]) - minValue) *
+                                                        (LIVE_ROWS - 1) / span);
+        marked[col] = range ? (first <= b && last >= a)
+                            : ((a >= first && a <= last) || (b >= first && b <= last));
+    }
+
+    renderer.beginFrame();
+    renderer.color(YELLOW).text(title).resetColor().newline().newline();
+    for (int row = LIVE_ROWS; row >= 1; row--)
+    {
+        bool highlighted = false;
+        renderer.color(LIGHT_CYAN);
+        for (int col = 0; col < columns; col++)
+        {
+            if (marked[col] != highlighted)
+            {
+                highlighted = marked[col];
+                renderer.color(highlighted ? LIGHT_RED : LIGHT_CYAN);
+            }
+            renderer.text(heights[col] >= row ? '#' : ' ').text(' ', gap);
+        }
+        renderer.resetColor().newline();
+    }
+    renderer.text('-', columns * (1 + gap)).newline();
+
+    if (n <= LIVE_VALUES)
+    {
+        renderer.text("[");
+        for (int i = 0; i < n; i++)
+        {
+            renderer.number(arr[i]).text(i < n - 1 ? ", " : "");
+        }
+        renderer.text("]").newline();
+    }
+    renderer.color(LIGHT_GREEN).text("Step ").number(steps).text(" - ").resetColor().text(caption).newline();
+    renderer.text("Comparisons: ").number(comparisons).text("  Swaps: ").number(swaps);
+    renderer.text("  Frames: ").number(renderer.framesWritten()).text(" shown, ");
+    renderer.number(renderer.framesSkipped()).text(" skipped").newline();
+    renderer.present();
+}
+
+// Hold the kernel to its speed. Sleeping only when a millisecond or more
+// ahead keeps fast speeds on average despite the sleep granularity; after
+// falling far behind (a slow terminal), carry on from now instead of rushing
+void LiveTracer::pace()
+{
+    nextStep += delay;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (nextStep - now >= std::chrono::milliseconds(1))
+    {
+        std::this_thread::sleep_until(nextStep);
+    }
+    else if (now - nextStep > std::chrono::milliseconds(100))
+    {
+        nextStep = now;
+    }
+}
+
+void LiveTracer::finish()
+{
+    render(-1, -1, false, "Sorting completed!");
+    renderer.finish();
+}
+
 void SortingAlgorithms::showComplexityInfo(const std::string &algorithm)
 {
     if (algorithm == "Bubble Sort")
@@ -35,7 +310,7 @@ void SortingAlgorithms::showComplexityInfo(const std::string &algorithm)
     }
     else if (algorithm == "Quick Sort")
     {
-        Utils::printComplexity("Quick Sort", "O(n log n) average, O(n²) worst", "O(log n)");
+        Utils::printComplexity("Quick Sort (introsort)", "O(n log n)", "O(log n)");
     }
     else if (algorithm == "Merge Sort")
     {
@@ -45,6 +320,10 @@ void SortingAlgorithms::showComplexityInfo(const std::string &algorithm)
     {
         Utils::printComplexity("Heap Sort", "O(n log n)", "O(1)");
     }
+    else if (algorithm == "Radix Sort")
+    {
+        Utils::printComplexity("Radix Sort (LSD)", "O(d * (n + 2^b)) for d digits of b bits", "O(n + 2^b)");
+    }
 }
 
 // ==================== BUBBLE SORT ====================
@@ -70,35 +349,8 @@ void SortingAlgorithms::bubbleSort(std::vector<int> &arr)
 
 void SortingAlgorithms::bubbleSortVisualized(std::vector<int> &arr)
 {
-    int n = arr.size();
-    bool swapped;
-
-    for (int i = 0; i < n - 1; i++)
-    {
-        swapped = false;
-        Utils::setColor(YELLOW);
-        std::cout << "\n--- Pass " << (i + 1) << " ---" << std::endl;
-        Utils::resetColor();
-
-        for (int j = 0; j < n - i - 1; j++)
-        {
-            if (arr[j] > arr[j + 1])
-            {
-                std::swap(arr[j], arr[j + 1]);
-                swapped = true;
-                incrementStep();
-                printStep(arr, "Swapped " + std::to_string(arr[j + 1]) + " and " + std::to_string(arr[j]));
-            }
-        }
-
-        if (!swapped)
-        {
-            Utils::setColor(LIGHT_CYAN);
-            std::cout << "No swaps needed. Array is sorted!" << std::endl;
-            Utils::resetColor();
-            break;
-        }
-    }
+    ConsoleTracer tracer(arr);
+    SortEngine::bubbleSort(arr, tracer);
 }
 
 // ==================== QUICK SORT ====================
@@ -108,6 +360,7 @@ void SortingAlgorithms::quickSort(std::vector<int> &arr)
     Utils::printHeader("QUICK SORT VISUALIZATION");
     Utils::setColor(CYAN);
     std::cout << "Quick Sort uses divide-and-conquer by selecting a pivot and partitioning the array." << std::endl;
+    std::cout << "Pivots are medians of three; small ranges finish with insertion sort." << std::endl;
     Utils::resetColor();
 
     Utils::printArray(arr, "Initial array");
@@ -124,43 +377,15 @@ void SortingAlgorithms::quickSort(std::vector<int> &arr)
 
 void SortingAlgorithms::quickSortVisualized(std::vector<int> &arr, int low, int high)
 {
-    if (low < high)
-    {
-        int pivotIndex = partition(arr, low, high);
-
-        Utils::setColor(YELLOW);
-        std::cout << "\nPartitioned around pivot " << arr[pivotIndex]
-                  << " at index " << pivotIndex << std::endl;
-        Utils::resetColor();
-
-        incrementStep();
-        printStep(arr, "After partitioning");
-
-        // Recursively sort elements before and after partition
-        quickSortVisualized(arr, low, pivotIndex - 1);
-        quickSortVisualized(arr, pivotIndex + 1, high);
-    }
+    // Use the smallest insertion cutoff so short inputs still show partitioning
+    ConsoleTracer tracer(arr);
+    SortEngine::quickSort(arr, low, high, tracer, SortEngine::MIN_INSERTION_THRESHOLD);
 }
 
 int SortingAlgorithms::partition(std::vector<int> &arr, int low, int high)
 {
-    int pivot = arr[high]; // Choose last element as pivot
-    int i = low - 1;       // Index of smaller element
-
-    Utils::setColor(MAGENTA);
-    std::cout << "Partitioning with pivot: " << pivot << std::endl;
-    Utils::resetColor();
-
-    for (int j = low; j < high; j++)
-    {
-        if (arr[j] < pivot)
-        {
-            i++;
-            std::swap(arr[i], arr[j]);
-        }
-    }
-    std::swap(arr[i + 1], arr[high]);
-    return i + 1;
+    ConsoleTracer tracer(arr);
+    return SortEngine::partition(arr, low, high, tracer);
 }
 
 // ==================== MERGE SORT ====================
@@ -169,7 +394,7 @@ void SortingAlgorithms::mergeSort(std::vector<int> &arr)
 {
     Utils::printHeader("MERGE SORT VISUALIZATION");
     Utils::setColor(CYAN);
-    std::cout << "Merge Sort divides the array into halves, sorts them, and merges them back." << std::endl;
+    std::cout << "Merge Sort splits the array into sorted runs and merges neighbouring runs until one is left." << std::endl;
     Utils::resetColor();
 
     Utils::printArray(arr, "Initial array");
@@ -186,76 +411,15 @@ void SortingAlgorithms::mergeSort(std::vector<int> &arr)
 
 void SortingAlgorithms::mergeSortVisualized(std::vector<int> &arr, int left, int right)
 {
-    if (left < right)
-    {
-        int mid = left + (right - left) / 2;
-
-        Utils::setColor(YELLOW);
-        std::cout << "\nDividing array from index " << left << " to " << right
-                  << " (mid: " << mid << ")" << std::endl;
-        Utils::resetColor();
-
-        // Sort first and second halves
-        mergeSortVisualized(arr, left, mid);
-        mergeSortVisualized(arr, mid + 1, right);
-
-        // Merge the sorted halves
-        merge(arr, left, mid, right);
-
-        incrementStep();
-        Utils::setColor(LIGHT_BLUE);
-        std::cout << "Merged subarrays [" << left << ".." << mid << "] and ["
-                  << (mid + 1) << ".." << right << "]" << std::endl;
-        Utils::resetColor();
-        Utils::printArrayRange(arr, left, right, "Current state");
-    }
+    // Runs of length 2 keep the merge steps visible on short inputs
+    ConsoleTracer tracer(arr);
+    SortEngine::mergeSort(arr, left, right, tracer, 2);
 }
 
 void SortingAlgorithms::merge(std::vector<int> &arr, int left, int mid, int right)
 {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-
-    // Create temporary arrays
-    std::vector<int> leftArr(n1), rightArr(n2);
-
-    // Copy data to temp arrays
-    for (int i = 0; i < n1; i++)
-        leftArr[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        rightArr[j] = arr[mid + 1 + j];
-
-    // Merge the temp arrays back into arr[left..right]
-    int i = 0, j = 0, k = left;
-
-    while (i < n1 && j < n2)
-    {
-        if (leftArr[i] <= rightArr[j])
-        {
-            arr[k] = leftArr[i];
-            i++;
-        }
-        else
-        {
-            arr[k] = rightArr[j];
-            j++;
-        }
-        k++;
-    }
-
-    // Copy remaining elements
-    while (i < n1)
-    {
-        arr[k] = leftArr[i];
-        i++;
-        k++;
-    }
-    while (j < n2)
-    {
-        arr[k] = rightArr[j];
-        j++;
-        k++;
-    }
+    NullTracer tracer;
+    SortEngine::merge(arr, left, mid, right, tracer);
 }
 
 // ==================== HEAP SORT ====================
@@ -265,6 +429,7 @@ void SortingAlgorithms::heapSort(std::vector<int> &arr)
     Utils::printHeader("HEAP SORT VISUALIZATION");
     Utils::setColor(CYAN);
     std::cout << "Heap Sort builds a max heap and repeatedly extracts the maximum element." << std::endl;
+    std::cout << "The heap is 4-ary: the children of index i are 4i+1 to 4i+4." << std::endl;
     Utils::resetColor();
 
     Utils::printArray(arr, "Initial array");
@@ -281,74 +446,261 @@ void SortingAlgorithms::heapSort(std::vector<int> &arr)
 
 void SortingAlgorithms::heapSortVisualized(std::vector<int> &arr)
 {
-    int n = arr.size();
+    ConsoleTracer tracer(arr);
+    SortEngine::heapSort(arr, tracer);
+}
 
-    // Build max heap
-    Utils::setColor(YELLOW);
-    std::cout << "\n--- Building Max Heap ---" << std::endl;
+void SortingAlgorithms::buildMaxHeap(std::vector<int> &arr)
+{
+    NullTracer tracer;
+    SortEngine::buildMaxHeap(arr, 0, arr.size(), tracer);
+}
+
+void SortingAlgorithms::heapify(std::vector<int> &arr, int n, int i)
+{
+    NullTracer tracer;
+    SortEngine::heapify(arr, 0, n, i, tracer);
+}
+
+// ==================== RADIX SORT ====================
+
+void SortingAlgorithms::radixSort(std::vector<int> &arr)
+{
+    Utils::printHeader("RADIX SORT VISUALIZATION");
+    Utils::setColor(CYAN);
+    std::cout << "Radix Sort distributes the keys into buckets one digit at a time, least significant first." << std::endl;
+    std::cout << "Digits here are 4 bits wide; digits that every key shares are skipped." << std::endl;
     Utils::resetColor();
 
-    buildMaxHeap(arr);
-    incrementStep();
-    printStep(arr, "Max heap built");
+    Utils::printArray(arr, "Initial array");
+    resetStepCount();
+
+    radixSortVisualized(arr);
+
+    Utils::setColor(LIGHT_GREEN);
+    std::cout << "\nSorting completed!" << std::endl;
+    Utils::resetColor();
+    Utils::printArray(arr, "Final sorted array");
+    showComplexityInfo("Radix Sort");
+}
+
+void SortingAlgorithms::radixSortVisualized(std::vector<int> &arr)
+{
+    // Small digits and no insertion sort cutoff, so a handful of short
+    // numbers still goes through several distribution passes
+    ConsoleTracer tracer(arr);
+    RadixSort::lsdSort(arr, tracer, 4, 0);
+}
+
+// ==================== AUTO SORT ====================
+
+void SortingAlgorithms::autoSort(std::vector<int> &arr)
+{
+    Utils::printHeader("AUTO SORT");
+    Utils::setColor(CYAN);
+    std::cout << "Auto Sort samples the array for runs, disorder, duplicates and key range," << std::endl;
+    std::cout << "then hands it to the algorithm that suits that shape best." << std::endl;
+    Utils::resetColor();
+
+    Utils::printArray(arr, "Initial array");
+
+    SortDecision decision = AutoSort::sort(arr);
+    const SortProfile &profile = decision.profile;
 
-    // Extract elements from heap one by one
+    std::cout << "\nNatural runs:     " << (profile.runsExceeded ? "more than " : "") << profile.runs << std::endl;
+    std::cout << "Inverted pairs:   " << profile.inversionRatio * 100 << "% of sampled pairs" << std::endl;
+    std::cout << "Distinct keys:    " << profile.distinctRatio * 100 << "% of sampled keys" << std::endl;
+    std::cout << "Key range:        " << profile.keyBits << " bits" << std::endl;
     Utils::setColor(YELLOW);
-    std::cout << "\n--- Extracting Elements ---" << std::endl;
+    std::cout << "Chosen algorithm: " << AutoSort::strategyName(decision.strategy) << " (" << decision.reason << ")"
+              << std::endl;
+    Utils::resetColor();
+
+    Utils::setColor(LIGHT_GREEN);
+    std::cout << "\nSorting completed!" << std::endl;
+    Utils::resetColor();
+    Utils::printArray(arr, "Final sorted array");
+}
+
+// ==================== EXTERNAL SORT ====================
+
+void SortingAlgorithms::externalSort()
+{
+    Utils::printHeader("EXTERNAL SORT");
+    Utils::setColor(CYAN);
+    std::cout << "External Sort sorts a binary file of 32-bit ints that does not have to fit in memory." << std::endl;
+    std::cout << "It sorts memory-sized runs, writes them to disk and merges them with a loser tree." << std::endl;
     Utils::resetColor();
 
-    for (int i = n - 1; i > 0; i--)
+    std::string input, output;
+    std::cout << "Input file: ";
+    std::cin >> input;
+    std::cout << "Output file: ";
+    std::cin >> output;
+
+    ExternalSortOptions options;
+    options.memoryBudget = static_cast<std::size_t>(Utils::getPositiveIntFromUser("Memory budget (MB): ")) << 20;
+
+    try
     {
-        // Move current root to end
-        std::swap(arr[0], arr[i]);
+        auto start = std::chrono::steady_clock::now();
+        ExternalSortStats stats = ExternalSort::sortFile<int>(input, output, options);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
 
-        incrementStep();
-        printStep(arr, "Moved max element " + std::to_string(arr[i]) + " to position " + std::to_string(i));
+        Utils::setColor(LIGHT_GREEN);
+        std::cout << "\nSorting completed!" << std::endl;
+        Utils::resetColor();
+        std::cout << "Elements:     " << stats.elements << std::endl;
+        std::cout << "Runs:         " << stats.runs << std::endl;
+        std::cout << "Merge passes: " << stats.mergePasses << std::endl;
+        std::cout << "Time:         " << elapsed.count() << " ms" << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        Utils::setColor(RED);
+        std::cout << "External sort failed: " << e.what() << std::endl;
+        Utils::resetColor();
+    }
+}
 
-        // Call heapify on the reduced heap
-        heapify(arr, i, 0);
+// ==================== TRACE AND LIVE SORT ====================
 
-        if (i > 1)
+namespace
+{
+    const char *const KERNEL_NAMES[] = {"Bubble Sort", "Quick Sort", "Merge Sort", "Heap Sort", "Radix Sort"};
+
+    // 1-5 for the kernel to run, or 0 after telling the user the choice is invalid
+    int chooseKernel()
+    {
+        std::cout << "1. Bubble Sort  2. Quick Sort  3. Merge Sort  4. Heap Sort  5. Radix Sort" << std::endl;
+        int algorithm = Utils::getPositiveIntFromUser("Algorithm (1-5): ");
+        if (algorithm > 5)
         {
-            incrementStep();
-            Utils::printArrayRange(arr, 0, i - 1, "Heap after heapify");
+            Utils::setColor(RED);
+            std::cout << "Invalid algorithm!" << std::endl;
+            Utils::resetColor();
+            return 0;
         }
+        return algorithm;
     }
-}
 
-void SortingAlgorithms::buildMaxHeap(std::vector<int> &arr)
-{
-    int n = arr.size();
+    std::vector<int> randomArray(int n, int maxValue)
+    {
+        std::vector<int> arr(n);
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> values(0, maxValue);
+        for (int &value : arr)
+        {
+            value = values(rng);
+        }
+        return arr;
+    }
 
-    // Start from the last non-leaf node and heapify each node
-    for (int i = n / 2 - 1; i >= 0; i--)
+    // Run kernel 1-5 on the whole array; visual uses the cutoffs of the
+    // *Visualized functions, so short arrays show their individual steps
+    template <typename Tracer>
+    void runKernel(int algorithm, std::vector<int> &arr, Tracer &tracer, bool visual)
     {
-        heapify(arr, n, i);
+        int n = static_cast<int>(arr.size());
+        switch (algorithm)
+        {
+        case 1:
+            SortEngine::bubbleSort(arr, tracer);
+            break;
+        case 2:
+            SortEngine::quickSort(arr, 0, n - 1, tracer, visual ? SortEngine::MIN_INSERTION_THRESHOLD : 0);
+            break;
+        case 3:
+            SortEngine::mergeSort(arr, 0, n - 1, tracer, visual ? 2 : 0);
+            break;
+        case 4:
+            SortEngine::heapSort(arr, tracer);
+            break;
+        case 5:
+            if (visual)
+                RadixSort::lsdSort(arr, tracer, 4, 0);
+            else
+                RadixSort::lsdSort(arr, tracer);
+            break;
+        }
     }
 }
 
-void SortingAlgorithms::heapify(std::vector<int> &arr, int n, int i)
+void SortingAlgorithms::traceSort()
 {
-    int largest = i;       // Initialize largest as root
-    int left = 2 * i + 1;  // left child
-    int right = 2 * i + 2; // right child
+    Utils::printHeader("TRACE SORT");
+    Utils::setColor(CYAN);
+    std::cout << "Trace Sort runs a sort on random numbers and records every step to a binary trace file" << std::endl;
+    std::cout << "instead of printing it; replay the file with AlgoVaultTrace (make trace)." << std::endl;
+    Utils::resetColor();
+
+    int algorithm = chooseKernel();
+    if (algorithm == 0)
+    {
+        return;
+    }
+    int n = Utils::getPositiveIntFromUser("Number of elements: ");
+    std::string path;
+    std::cout << "Trace file: ";
+    std::cin >> path;
 
-    // If left child is larger than root
-    if (left < n && arr[left] > arr[largest])
-        largest = left;
+    std::vector<int> arr = randomArray(n, 999999);
+
+    try
+    {
+        TraceLog log(path);
+        LogTracer tracer(arr, log);
+        auto start = std::chrono::steady_clock::now();
+        runKernel(algorithm, arr, tracer, false);
+        log.close();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+        Utils::setColor(LIGHT_GREEN);
+        std::cout << "\nSorting completed!" << std::endl;
+        Utils::resetColor();
+        std::cout << "Steps recorded: " << log.size() << std::endl;
+        std::cout << "Time:           " << elapsed.count() << " ms" << std::endl;
+        std::cout << "Replay with:    AlgoVaultTrace " << path << std::endl;
+    }
+    catch (const std::exception &e)
+    {
+        Utils::setColor(RED);
+        std::cout << "Trace failed: " << e.what() << std::endl;
+        Utils::resetColor();
+    }
+}
 
-    // If right child is larger than largest so far
-    if (right < n && arr[right] > arr[largest])
-        largest = right;
+void SortingAlgorithms::liveSort()
+{
+    Utils::printHeader("LIVE SORT");
+    Utils::setColor(CYAN);
+    std::cout << "Live Sort animates a sort on random numbers as a bar chart that is redrawn in place." << std::endl;
+    std::cout << "The screen is refreshed at most " << FrameRenderer::DEFAULT_FPS
+              << " times a second; faster steps skip frames." << std::endl;
+    Utils::resetColor();
 
-    // If largest is not root
-    if (largest != i)
+    int algorithm = chooseKernel();
+    if (algorithm == 0)
     {
-        std::swap(arr[i], arr[largest]);
+        return;
+    }
+    int n = Utils::getPositiveIntFromUser("Number of elements: ");
+    int speed = Utils::getPositiveIntFromUser("Steps per second: ");
 
-        // Recursively heapify the affected sub-tree
-        heapify(arr, n, largest);
+    std::vector<int> arr = randomArray(n, 999);
+    long long frames, skipped;
+    {
+        FrameRenderer renderer;
+        LiveTracer tracer(arr, renderer, std::string(KERNEL_NAMES[algorithm - 1]) + " - " + std::to_string(n) +
+                                             " elements, " + std::to_string(speed) + " steps/s",
+                          speed);
+        runKernel(algorithm, arr, tracer, true);
+        tracer.finish();
+        frames = renderer.framesWritten();
+        skipped = renderer.framesSkipped();
     }
+
+    std::cout << "Frames shown: " << frames << ", skipped: " << skipped << std::endl;
 }
 
 // ==================== MENU FUNCTIONS ====================
@@ -360,7 +712,12 @@ void SortingAlgorithms::showSortingMenu()
     std::cout << "2. Quick Sort" << std::endl;
     std::cout << "3. Merge Sort" << std::endl;
     std::cout << "4. Heap Sort" << std::endl;
-    std::cout << "5. Back to Main Menu" << std::endl;
+    std::cout << "5. Radix Sort" << std::endl;
+    std::cout << "6. Auto Sort" << std::endl;
+    std::cout << "7. External Sort (binary file)" << std::endl;
+    std::cout << "8. Trace Sort to File" << std::endl;
+    std::cout << "9. Live Sort (animated)" << std::endl;
+    std::cout << "10. Back to Main Menu" << std::endl;
     Utils::printSeparator('-', 30);
 }
 
@@ -374,10 +731,10 @@ void SortingAlgorithms::runSortingAlgorithms()
         Utils::clearConsole();
         showSortingMenu();
 
-        std::cout << "Enter your choice (1-5): ";
+        std::cout << "Enter your choice (1-10): ";
         std::cin >> choice;
 
-        if (choice >= 1 && choice <= 4)
+        if (choice >= 1 && choice <= 6)
         {
             Utils::clearConsole();
             std::cout << "Getting array input from user..." << std::endl;
@@ -400,6 +757,24 @@ void SortingAlgorithms::runSortingAlgorithms()
             heapSort(arr);
             break;
         case 5:
+            radixSort(arr);
+            break;
+        case 6:
+            autoSort(arr);
+            break;
+        case 7:
+            Utils::clearConsole();
+            externalSort();
+            break;
+        case 8:
+            Utils::clearConsole();
+            traceSort();
+            break;
+        case 9:
+            Utils::clearConsole();
+            liveSort();
+            break;
+        case 10:
             return;
         default:
             Utils::setColor(RED);
@@ -407,7 +782,7 @@ void SortingAlgorithms::runSortingAlgorithms()
             Utils::resetColor();
         }
 
-        if (choice >= 1 && choice <= 4)
+        if (choice >= 1 && choice <= 9)
         {
             Utils::pauseConsole();
         }
@@ -6,8 +6,12 @@
 
 /**
  * Sorting Algorithms Implementation for AlgoVault
- * Includes: QuickSort, MergeSort, HeapSort, BubbleSort
- * Each algorithm includes step-by-step visualization
+ * Includes: QuickSort, MergeSort, HeapSort, BubbleSort, RadixSort, AutoSort, ExternalSort
+ * Each algorithm includes step-by-step visualization; Trace Sort records the
+ * steps of a large sort to a binary trace file instead (see trace_log.h), and
+ * Live Sort animates one in place (see renderer.h)
+ * The kernels themselves live in sort_engine.h; the functions here run them
+ * with a ConsoleTracer. Use SortEngine directly for un-instrumented sorting.
  */
 
 class SortingAlgorithms
@@ -17,6 +21,8 @@ private:
     static void resetStepCount();
     static void incrementStep();
 
+    friend class ConsoleTracer;
+
 public:
     // Bubble Sort
     static void bubbleSort(std::vector<int> &arr);
@@ -38,6 +44,22 @@ public:
     static void heapify(std::vector<int> &arr, int n, int i);
     static void buildMaxHeap(std::vector<int> &arr);
 
+    // Radix Sort
+    static void radixSort(std::vector<int> &arr);
+    static void radixSortVisualized(std::vector<int> &arr);
+
+    // Auto Sort (probes the input and picks an algorithm for it)
+    static void autoSort(std::vector<int> &arr);
+
+    // External Sort (binary files of ints larger than memory)
+    static void externalSort();
+
+    // Trace Sort (records a large sort to a binary trace file for AlgoVaultTrace)
+    static void traceSort();
+
+    // Live Sort (animates a sort as a bar chart through the buffered renderer, see renderer.h)
+    static void liveSort();
+
     // Menu and driver functions
     static void showSortingMenu();
     static void runSortingAlgorithms();
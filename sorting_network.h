@@ -0,0 +1,347 @@
+#ifndef SORTING_NETWORK_H
+#define SORTING_NETWORK_H
+
+#include <climits>
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Branch-free sorting networks for short int ranges (up to 64 elements)
+ * Used by SortEngine as the leaf kernel of quick sort and merge sort in
+ * place of insertion sort, whose data-dependent branches mispredict about
+ * once per element on random input.
+ *
+ * The range is padded with INT_MAX to a power of two (8 to 64) and sorted
+ * by a bitonic network held in vector registers, loaded straight from the
+ * range with masked loads for the last partial register. The instruction set is
+ * picked at compile time: AVX-512 (16 lanes), AVX2 (8), SSE4.1 (4), or a
+ * scalar network of conditional moves when none is enabled. Build with
+ * -mavx2, -mavx512f or -march=native to get the vector versions.
+ */
+
+class SortingNetwork
+{
+public:
+    enum
+    {
+        MAX_SIZE = 64
+    };
+
+    // Sort data[0, n), n <= MAX_SIZE
+    static void sort(int *data, int n);
+
+    static const char *instructionSet();
+
+private:
+    // ==================== LANE TYPES ====================
+    // Each provides a vector of WIDTH ints with (unaligned) load/store,
+    // partial load/store of the first count lanes (loads pad with INT_MAX),
+    // lane-wise min/max, lane reversal and exchange<M, B>: compare every
+    // lane l with lane l ^ M, keeping the maximum in lanes with bit B set.
+
+#if defined(__AVX512F__)
+    // The write-masked intrinsics are used with an all-ones mask: the plain
+    // forms make GCC 12 warn about its own _mm512_undefined_epi32() inside
+    // them (GCC bug 105593)
+    struct Lanes
+    {
+        typedef __m512i V;
+        enum
+        {
+            WIDTH = 16
+        };
+        static const char *name() { return "AVX-512"; }
+
+        static V load(const int *p) { return _mm512_loadu_si512(p); }
+        static void store(int *p, V v) { _mm512_storeu_si512(p, v); }
+        static V loadPartial(const int *p, int count)
+        {
+            return _mm512_mask_loadu_epi32(_mm512_set1_epi32(INT_MAX), static_cast<__mmask16>((1 << count) - 1), p);
+        }
+        static void storePartial(int *p, V v, int count)
+        {
+            _mm512_mask_storeu_epi32(p, static_cast<__mmask16>((1 << count) - 1), v);
+        }
+        static V min(V a, V b) { return _mm512_mask_min_epi32(a, 0xFFFF, a, b); }
+        static V max(V a, V b) { return _mm512_mask_max_epi32(a, 0xFFFF, a, b); }
+        static V reverse(V v)
+        {
+            const __m512i index = _mm512_set_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            return _mm512_mask_permutexvar_epi32(v, 0xFFFF, index, v);
+        }
+
+        template <int M, int B>
+        static V exchange(V v)
+        {
+            const __m512i index = _mm512_set_epi32(15 ^ M, 14 ^ M, 13 ^ M, 12 ^ M, 11 ^ M, 10 ^ M, 9 ^ M, 8 ^ M,
+                                                   7 ^ M, 6 ^ M, 5 ^ M, 4 ^ M, 3 ^ M, 2 ^ M, 1 ^ M, 0 ^ M);
+            V partner = _mm512_mask_permutexvar_epi32(v, 0xFFFF, index, v);
+            return _mm512_mask_blend_epi32(static_cast<__mmask16>(LaneMask<B, 16>::VALUE), min(v, partner), max(v, partner));
+        }
+    };
+#elif defined(__AVX2__)
+    struct Lanes
+    {
+        typedef __m256i V;
+        enum
+        {
+            WIDTH = 8
+        };
+        static const char *name() { return "AVX2"; }
+
+        static V load(const int *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+        static void store(int *p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+        static V loadPartial(const int *p, int count)
+        {
+            V mask = partialMask(count);
+            return _mm256_blendv_epi8(_mm256_set1_epi32(INT_MAX), _mm256_maskload_epi32(p, mask), mask);
+        }
+        static void storePartial(int *p, V v, int count) { _mm256_maskstore_epi32(p, partialMask(count), v); }
+        static V partialMask(int count)
+        {
+            return _mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        }
+        static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+        static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+        static V reverse(V v) { return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+
+        template <int M, int B>
+        static V exchange(V v)
+        {
+            V partner = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0 ^ M, 1 ^ M, 2 ^ M, 3 ^ M,
+                                                                         4 ^ M, 5 ^ M, 6 ^ M, 7 ^ M));
+            return _mm256_blend_epi32(_mm256_min_epi32(v, partner), _mm256_max_epi32(v, partner),
+                                      LaneMask<B, 8>::VALUE);
+        }
+    };
+#elif defined(__SSE4_1__)
+    struct Lanes
+    {
+        typedef __m128i V;
+        enum
+        {
+            WIDTH = 4
+        };
+        static const char *name() { return "SSE4.1"; }
+
+        static V load(const int *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+        static void store(int *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+        static V loadPartial(const int *p, int count)
+        {
+            alignas(16) int lanes[4] = {INT_MAX, INT_MAX, INT_MAX, INT_MAX};
+            std::copy(p, p + count, lanes);
+            return _mm_load_si128(reinterpret_cast<const __m128i *>(lanes));
+        }
+        static void storePartial(int *p, V v, int count)
+        {
+            alignas(16) int lanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), v);
+            std::copy(lanes, lanes + count, p);
+        }
+        static V min(V a, V b) { return _mm_min_epi32(a, b); }
+        static V max(V a, V b) { return _mm_max_epi32(a, b); }
+        static V reverse(V v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+
+        template <int M, int B>
+        static V exchange(V v)
+        {
+            V partner = _mm_shuffle_epi32(v, ((0 ^ M) & 3) | ((1 ^ M) & 3) << 2 | ((2 ^ M) & 3) << 4 | ((3 ^ M) & 3) << 6);
+            // _mm_blend_epi16 selects 16-bit halves, so every int lane takes two mask bits
+            return _mm_blend_epi16(_mm_min_epi32(v, partner), _mm_max_epi32(v, partner),
+                                   (LaneMask<B, 4>::VALUE & 1 ? 0x03 : 0) | (LaneMask<B, 4>::VALUE & 2 ? 0x0C : 0) |
+                                       (LaneMask<B, 4>::VALUE & 4 ? 0x30 : 0) | (LaneMask<B, 4>::VALUE & 8 ? 0xC0 : 0));
+        }
+    };
+#else
+    struct Lanes
+    {
+        typedef int V;
+        enum
+        {
+            WIDTH = 1
+        };
+        static const char *name() { return "scalar"; }
+
+        static V load(const int *p) { return *p; }
+        static void store(int *p, V v) { *p = v; }
+        static V loadPartial(const int *, int) { return INT_MAX; } // count is always 0
+        static void storePartial(int *, V, int) {}
+        static V min(V a, V b) { return a < b ? a : b; }
+        static V max(V a, V b) { return a < b ? b : a; }
+        static V reverse(V v) { return v; }
+
+        template <int M, int B>
+        static V exchange(V v) { return v; }
+    };
+#endif
+
+    // Bit l of VALUE is set when lane l has bit B set (lanes < Width)
+    template <int B, int Width, int Lane = 0>
+    struct LaneMask
+    {
+        enum
+        {
+            VALUE = ((Lane & B) ? (1 << Lane) : 0) | LaneMask<B, Width, Lane + 1>::VALUE
+        };
+    };
+    template <int B, int Width>
+    struct LaneMask<B, Width, Width>
+    {
+        enum
+        {
+            VALUE = 0
+        };
+    };
+
+    // ==================== BITONIC NETWORK ====================
+    // Bitonic sort of Regs * WIDTH elements in the "flip" formulation: stage K
+    // merges sorted runs of K/2 into runs of K by comparing element i with
+    // i ^ (K - 1), then cleans up with half-cleaners at strides K/4 .. 1.
+    // Every comparator puts the minimum at the lower index, so no direction
+    // masks are needed. Strides of at least WIDTH compare whole registers;
+    // shorter ones shuffle lanes within a register.
+
+    template <int Regs>
+    struct Bitonic
+    {
+        typedef typename Lanes::V V;
+        enum
+        {
+            W = Lanes::WIDTH,
+            N = Regs * Lanes::WIDTH
+        };
+
+        // Sort data[0, n), n <= N; missing elements are padded with INT_MAX
+        static void sort(int *data, int n)
+        {
+            V r[Regs];
+            for (int i = 0; i < Regs; i++)
+            {
+                int count = std::min(std::max(n - i * W, 0), static_cast<int>(W));
+                r[i] = count == W ? Lanes::load(data + i * W) : Lanes::loadPartial(data + i * W, count);
+            }
+
+            Stage<2, (2 <= N)>::run(r);
+
+            for (int i = 0; i < Regs; i++)
+            {
+                int count = std::min(std::max(n - i * W, 0), static_cast<int>(W));
+                if (count == W)
+                    Lanes::store(data + i * W, r[i]);
+                else if (count > 0)
+                    Lanes::storePartial(data + i * W, r[i], count);
+            }
+        }
+
+        template <int K, bool Active>
+        struct Stage
+        {
+            static void run(V *r)
+            {
+                flip<K>(r);
+                Clean<K / 4, (K / 4 >= 1)>::run(r);
+                Stage<2 * K, (2 * K <= N)>::run(r);
+            }
+        };
+        template <int K>
+        struct Stage<K, false>
+        {
+            static void run(V *) {}
+        };
+
+        template <int J, bool Active>
+        struct Clean
+        {
+            static void run(V *r)
+            {
+                halfClean<J>(r);
+                Clean<J / 2, (J / 2 >= 1)>::run(r);
+            }
+        };
+        template <int J>
+        struct Clean<J, false>
+        {
+            static void run(V *) {}
+        };
+
+        // Compare i with i ^ (K - 1) inside every group of K elements
+        template <int K>
+        static void flip(V *r)
+        {
+            if (K <= W)
+            {
+                for (int i = 0; i < Regs; i++)
+                    r[i] = Lanes::template exchange<K - 1, K / 2>(r[i]);
+                return;
+            }
+
+            // The partner of lane l in register i of a group is lane
+            // W - 1 - l in the mirrored register
+            const int group = K / W > 0 ? K / W : 1;
+            for (int g = 0; g < Regs; g += group)
+            {
+                for (int i = 0; i < group / 2; i++)
+                {
+                    V a = r[g + i];
+                    V b = Lanes::reverse(r[g + group - 1 - i]);
+                    r[g + i] = Lanes::min(a, b);
+                    r[g + group - 1 - i] = Lanes::reverse(Lanes::max(a, b));
+                }
+            }
+        }
+
+        // Compare i with i ^ J
+        template <int J>
+        static void halfClean(V *r)
+        {
+            if (J < W)
+            {
+                for (int i = 0; i < Regs; i++)
+                    r[i] = Lanes::template exchange<J, J>(r[i]);
+                return;
+            }
+
+            const int stride = J / W > 0 ? J / W : 1;
+            for (int g = 0; g < Regs; g += 2 * stride)
+            {
+                for (int i = g; i < g + stride; i++)
+                {
+                    V a = r[i];
+                    V b = r[i + stride];
+                    r[i] = Lanes::min(a, b);
+                    r[i + stride] = Lanes::max(a, b);
+                }
+            }
+        }
+    };
+
+    enum
+    {
+        MIN_NETWORK = Lanes::WIDTH > 8 ? Lanes::WIDTH : 8
+    };
+};
+
+inline const char *SortingNetwork::instructionSet()
+{
+    return Lanes::name();
+}
+
+inline void SortingNetwork::sort(int *data, int n)
+{
+    if (n < 2)
+        return;
+
+    if (n <= 8 && MIN_NETWORK <= 8)
+        Bitonic<(8 + Lanes::WIDTH - 1) / Lanes::WIDTH>::sort(data, n);
+    else if (n <= 16)
+        Bitonic<(16 + Lanes::WIDTH - 1) / Lanes::WIDTH>::sort(data, n);
+    else if (n <= 32)
+        Bitonic<(32 + Lanes::WIDTH - 1) / Lanes::WIDTH>::sort(data, n);
+    else
+        Bitonic<(64 + Lanes::WIDTH - 1) / Lanes::WIDTH>::sort(data, n);
+}
+
+#endif // SORTING_NETWORK_H
@@ -0,0 +1,152 @@
+#include "thread_pool.h"
+
+// Which pool (if any) the current thread works for, and its deque
+static thread_local const WorkStealingPool *currentPool = nullptr;
+static thread_local int currentIndex = 0;
+
+// ==================== WORK-STEALING POOL ====================
+
+WorkStealingPool::WorkStealingPool(int threads)
+    : threadCount(threads > 0 ? threads : defaultThreadCount()), queued(0), stopping(false)
+{
+    for (int i = 0; i < threadCount; i++)
+    {
+        queues.push_back(std::unique_ptr<TaskQueue>(new TaskQueue()));
+    }
+
+    // The thread that waits on a TaskGroup counts as the first worker
+    for (int i = 1; i < threadCount; i++)
+    {
+        workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+int WorkStealingPool::defaultThreadCount()
+{
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? static_cast<int>(hardware) : 1;
+}
+
+int WorkStealingPool::currentQueue() const
+{
+    return currentPool == this ? currentIndex : 0;
+}
+
+void WorkStealingPool::submit(const std::function<void()> &task)
+{
+    TaskQueue &queue = *queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    queued++;
+
+    // Taking the lock orders this wakeup after a sleeper's last look at queued
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    wake.notify_one();
+}
+
+bool WorkStealingPool::runPendingTask()
+{
+    std::function<void()> task;
+    if (!takeTask(currentQueue(), task))
+    {
+        return false;
+    }
+    task();
+    return true;
+}
+
+// Pop the newest task of our own deque, or steal the oldest task of another
+bool WorkStealingPool::takeTask(int self, std::function<void()> &task)
+{
+    {
+        TaskQueue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty())
+        {
+            task.swap(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    for (int i = 1; i < threadCount; i++)
+    {
+        TaskQueue &victim = *queues[(self + i) % threadCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty())
+        {
+            task.swap(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (takeTask(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping && queued.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+// ==================== TASK GROUP ====================
+
+void TaskGroup::run(const std::function<void()> &task)
+{
+    pending++;
+    std::atomic<int> *counter = &pending;
+    pool.submit([counter, task]()
+                {
+                    task();
+                    (*counter)--;
+                });
+}
+
+void TaskGroup::wait()
+{
+    // Help with pending work (ours or anybody's) until our tasks are done
+    while (pending.load() > 0)
+    {
+        if (!pool.runPendingTask())
+        {
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * Work-stealing thread pool used by the parallel algorithms
+ * Every worker owns a task deque: it pushes and pops its own tasks at the
+ * back (newest first, good for cache reuse in divide-and-conquer code) while
+ * idle workers steal from the front of other deques (oldest, usually the
+ * largest pieces of work). Threads outside the pool share one extra deque.
+ *
+ * Tasks are forked and joined through a TaskGroup; a thread waiting on a group
+ * keeps running pending tasks instead of blocking, so groups can be nested.
+ */
+
+class WorkStealingPool
+{
+public:
+    // threads: total number of threads working on tasks, counting the thread
+    // that waits on a TaskGroup; 0 means std::thread::hardware_concurrency()
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    int size() const { return threadCount; }
+
+    void submit(const std::function<void()> &task);
+
+    // Run one pending task on the calling thread; false if none was found
+    bool runPendingTask();
+
+    static int defaultThreadCount();
+
+private:
+    struct TaskQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()> > tasks;
+    };
+
+    int threadCount;
+    std::vector<std::unique_ptr<TaskQueue> > queues; // queues[0] is shared by outside threads
+    std::vector<std::thread> workers;
+
+    std::atomic<int> queued;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
+
+    WorkStealingPool(const WorkStealingPool &);
+    WorkStealingPool &operator=(const WorkStealingPool &);
+
+    int currentQueue() const;
+    bool takeTask(int self, std::function<void()> &task);
+    void workerLoop(int index);
+};
+
+// Fork/join scope: run() forks a task, wait() joins all of them
+class TaskGroup
+{
+public:
+    explicit TaskGroup(WorkStealingPool &pool) : pool(pool), pending(0) {}
+    ~TaskGroup() { wait(); }
+
+    void run(const std::function<void()> &task);
+    void wait();
+
+private:
+    WorkStealingPool &pool;
+    std::atomic<int> pending;
+
+    TaskGroup(const TaskGroup &);
+    TaskGroup &operator=(const TaskGroup &);
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,322 @@
+#include "trace_log.h"
+#include "graph.h"
+#include <cstring>
+#include <exception>
+#include <sstream>
+
+static_assert(sizeof(TraceEvent) == 32, "trace events are 32 bytes on disk");
+
+const char TraceLog::MAGIC[8] = {'A', 'V', 'T', 'R', 'A', 'C', 'E', '\0'};
+
+namespace
+{
+    struct TraceHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t eventSize;
+    };
+}
+
+// ==================== TRACE LOG ====================
+
+TraceLog::TraceLog(const std::string &path, std::size_t blockEvents)
+    : file(path, true), current(0), pos(0), written(0), closed(false), start(std::chrono::steady_clock::now())
+{
+    TraceHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.eventSize = sizeof(TraceEvent);
+    file.write(0, &header, sizeof(header));
+
+    blocks[0].resize(std::max<std::size_t>(blockEvents, 1));
+    blocks[1].resize(blocks[0].size());
+}
+
+TraceLog::~TraceLog()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception &)
+    {
+        // Nothing to report to from a destructor
+    }
+}
+
+// Hand the current block to the I/O thread and continue in the other one,
+// once its previous write has finished
+void TraceLog::flush()
+{
+    if (pos > 0)
+    {
+        BinaryFile *target = &file;
+        const TraceEvent *data = blocks[current].data();
+        std::size_t bytes = pos * sizeof(TraceEvent);
+        std::uint64_t offset = HEADER_SIZE + written * sizeof(TraceEvent);
+        pending[current] = io.submit([target, offset, data, bytes]()
+                                     { target->write(offset, data, bytes); });
+        written += pos;
+        pos = 0;
+    }
+
+    current ^= 1;
+    if (pending[current].valid())
+        pending[current].get();
+}
+
+void TraceLog::close()
+{
+    if (closed)
+        return;
+    closed = true;
+
+    std::exception_ptr error;
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    for (int b = 0; b < 2; b++)
+    {
+        try
+        {
+            if (pending[b].valid())
+                pending[b].get();
+        }
+        catch (...)
+        {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// ==================== TRACE READER ====================
+
+TraceReader::TraceReader(const std::string &path, std::size_t blockEvents)
+    : file(path, false), block(std::max<std::size_t>(blockEvents, 1)), pos(0), filled(0), read(0), total(0)
+{
+    std::uint64_t bytes = file.size();
+    TraceHeader header;
+    if (bytes < sizeof(header))
+    {
+        throw std::runtime_error(path + " is not a trace file");
+    }
+    file.read(0, &header, sizeof(header));
+    if (std::memcmp(header.magic, TraceLog::MAGIC, sizeof(header.magic)) != 0)
+    {
+        throw std::runtime_error(path + " is not a trace file");
+    }
+    if (header.version != TraceLog::VERSION || header.eventSize != sizeof(TraceEvent))
+    {
+        throw std::runtime_error(path + " was written by an incompatible version");
+    }
+    total = (bytes - sizeof(header)) / sizeof(TraceEvent);
+    std::uint64_t partial = (bytes - sizeof(header)) % sizeof(TraceEvent);
+    if (partial != 0)
+    {
+        throw std::runtime_error(path + " is truncated: " + std::to_string(partial) +
+                                 " bytes of a partial event after " + std::to_string(total) + " whole ones");
+    }
+}
+
+bool TraceReader::next(TraceEvent &event)
+{
+    if (pos == filled)
+    {
+        if (read == total)
+            return false;
+        filled = static_cast<std::size_t>(std::min<std::uint64_t>(block.size(), total - read));
+        file.read(TraceLog::HEADER_SIZE + read * sizeof(TraceEvent), block.data(), filled * sizeof(TraceEvent));
+        read += filled;
+        pos = 0;
+    }
+    event = block[pos++];
+    return true;
+}
+
+// ==================== RENDERING ====================
+
+const char *TraceReader::kindName(int kind)
+{
+    switch (kind)
+    {
+    case TRACE_SORT_EVENT:
+        return "sort";
+    case TRACE_SORT_SWAP:
+        return "swap";
+    case TRACE_GRAPH_EVENT:
+        return "graph";
+    }
+    return "unknown";
+}
+
+const char *TraceReader::opName(int kind, int op)
+{
+    if (kind == TRACE_SORT_SWAP)
+        return "swap";
+    if (kind == TRACE_SORT_EVENT)
+    {
+        switch (op)
+        {
+        case SORT_PASS:
+            return "pass";
+        case SORT_SWAPPED:
+            return "swapped";
+        case SORT_SORTED_EARLY:
+            return "sorted_early";
+        case SORT_PARTITION_BEGIN:
+            return "partition_begin";
+        case SORT_PARTITIONED:
+            return "partitioned";
+        case SORT_INSERTION:
+            return "insertion";
+        case SORT_DEPTH_LIMIT:
+            return "depth_limit";
+        case SORT_RUN:
+            return "run";
+        case SORT_MERGED:
+            return "merged";
+        case SORT_HEAP_BUILD:
+            return "heap_build";
+        case SORT_HEAP_BUILT:
+            return "heap_built";
+        case SORT_HEAP_EXTRACT:
+            return "heap_extract";
+        case SORT_HEAP_MOVED:
+            return "heap_moved";
+        case SORT_HEAPIFIED:
+            return "heapified";
+        case SORT_RADIX_PASS:
+            return "radix_pass";
+        case SORT_RADIX_BUCKETS:
+            return "radix_buckets";
+        }
+    }
+    if (kind == TRACE_GRAPH_EVENT)
+    {
+        switch (op)
+        {
+        case GRAPH_VISIT:
+            return "visit";
+        case GRAPH_DISCOVER:
+            return "discover";
+        case GRAPH_ALREADY_VISITED:
+            return "already_visited";
+        case GRAPH_SETTLE:
+            return "settle";
+        case GRAPH_RELAX:
+            return "relax";
+        case GRAPH_NO_IMPROVEMENT:
+            return "no_improvement";
+        }
+    }
+    return "unknown";
+}
+
+std::string TraceReader::describe(const TraceEvent &e)
+{
+    std::ostringstream out;
+    if (e.kind == TRACE_SORT_SWAP)
+    {
+        out << "Swapped " << e.valueB << " and " << e.valueA << " at [" << e.a << "] and [" << e.b << "]";
+        return out.str();
+    }
+
+    if (e.kind == TRACE_SORT_EVENT)
+    {
+        switch (e.op)
+        {
+        case SORT_PASS:
+            out << "--- Pass " << (e.a + 1) << " ---";
+            break;
+        case SORT_SWAPPED:
+            out << "Swapped " << e.valueB << " and " << e.valueA;
+            break;
+        case SORT_SORTED_EARLY:
+            out << "No swaps needed. Array is sorted!";
+            break;
+        case SORT_PARTITION_BEGIN:
+            out << "Partitioning with pivot: " << e.valueA;
+            break;
+        case SORT_PARTITIONED:
+            out << "Partitioned around pivot " << e.valueA << " at index " << e.a;
+            break;
+        case SORT_INSERTION:
+            out << "Insertion sort on small range [" << e.a << ".." << e.b << "]";
+            break;
+        case SORT_DEPTH_LIMIT:
+            out << "Too many unbalanced partitions on [" << e.a << ".." << e.b << "], switching to heap sort";
+            break;
+        case SORT_RUN:
+            out << "Found sorted run [" << e.a << ".." << e.b << "]";
+            break;
+        case SORT_MERGED:
+            out << "Merged subarrays [" << e.a << ".." << e.b << "] and [" << (e.b + 1) << ".." << e.c << "]";
+            break;
+        case SORT_HEAP_BUILD:
+            out << "--- Building Max Heap ---";
+            break;
+        case SORT_HEAP_BUILT:
+            out << "Max heap built";
+            break;
+        case SORT_HEAP_EXTRACT:
+            out << "--- Extracting Elements ---";
+            break;
+        case SORT_HEAP_MOVED:
+            out << "Moved max element " << e.valueA << " to position " << e.a;
+            break;
+        case SORT_HEAPIFIED:
+            out << "Heap after heapify [" << e.a << ".." << e.b << "]";
+            break;
+        case SORT_RADIX_PASS:
+            out << "Distributed by digit " << e.a << " (bits " << e.b << "-" << (e.b + e.c - 1) << ")";
+            break;
+        case SORT_RADIX_BUCKETS:
+            out << "Bucketed [" << e.a << ".." << e.b << "] by bits " << e.c << "-" << (e.c + 7);
+            break;
+        default:
+            out << "Unknown sort event " << e.op;
+        }
+        return out.str();
+    }
+
+    if (e.kind == TRACE_GRAPH_EVENT)
+    {
+        switch (e.op)
+        {
+        case GRAPH_VISIT:
+            out << "Visiting vertex " << e.a << " (" << e.b << " waiting)";
+            break;
+        case GRAPH_DISCOVER:
+            out << "Neighbor " << e.b << " of " << e.a << " added";
+            break;
+        case GRAPH_ALREADY_VISITED:
+            out << "Neighbor " << e.b << " of " << e.a << " already visited";
+            break;
+        case GRAPH_SETTLE:
+            out << "Processing vertex " << e.a << " (distance: " << e.valueA << ")";
+            break;
+        case GRAPH_RELAX:
+            out << "Edge " << e.a << " -> " << e.b << " (weight " << e.c << "): updated distance to " << e.valueA;
+            break;
+        case GRAPH_NO_IMPROVEMENT:
+            out << "Edge " << e.a << " -> " << e.b << " (weight " << e.c << "): no improvement (current: "
+                << e.valueA << ")";
+            break;
+        default:
+            out << "Unknown graph event " << e.op;
+        }
+        return out.str();
+    }
+
+    out << "Unknown event kind " << e.kind;
+    return out.str();
+}
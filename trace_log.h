@@ -0,0 +1,151 @@
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <future>
+#include <chrono>
+#include "sort_tracer.h"
+#include "external_sort.h"
+
+/**
+ * Binary trace log for AlgoVault
+ * Instead of printing every step, an algorithm can append fixed-size
+ * binary events (what happened, up to three indices, two values and a
+ * timestamp) to a trace file and run at close to full speed; the replay
+ * tool (make trace, AlgoVaultTrace) renders or filters the log afterwards.
+ *   TraceLog    - the writer: events fill one of two in-memory blocks while
+ *                 the other is written out on a background IoThread
+ *   TraceReader - reads a trace file back event by event
+ *   LogTracer   - sort tracer policy (see sort_tracer.h) that records every
+ *                 milestone and swap of a kernel
+ * Graph algorithms record GraphEvents through Graph::setTraceLog.
+ * Files start with a 16-byte header (magic, version, event size) followed
+ * by the events in native byte order.
+ */
+
+// What the op field of an event refers to
+enum TraceKind
+{
+    TRACE_SORT_EVENT = 1, // op: SortEvent, arguments as documented there
+    TRACE_SORT_SWAP = 2,  // a, b: indices just swapped; values: arr[a], arr[b] after the swap
+    TRACE_GRAPH_EVENT = 3 // op: GraphEvent (graph.h)
+};
+
+// One recorded step, 32 bytes
+struct TraceEvent
+{
+    std::uint64_t time; // ns since the log was opened
+    std::uint16_t kind; // TraceKind
+    std::uint16_t op;
+    std::int32_t a, b, c;
+    std::int32_t valueA, valueB;
+};
+
+class TraceLog
+{
+public:
+    enum
+    {
+        VERSION = 1,
+        HEADER_SIZE = 16,
+        BLOCK_EVENTS = 1 << 15 // 1 MB per block
+    };
+
+    static const char MAGIC[8];
+
+    // Create (or truncate) the trace file at path; throws std::runtime_error
+    explicit TraceLog(const std::string &path, std::size_t blockEvents = BLOCK_EVENTS);
+    // Writes whatever is still buffered; errors are only reported by close()
+    ~TraceLog();
+
+    void record(TraceKind kind, int op, int a = 0, int b = 0, int c = 0, int valueA = 0, int valueB = 0)
+    {
+        TraceEvent &event = blocks[current][pos];
+        event.time = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        event.kind = static_cast<std::uint16_t>(kind);
+        event.op = static_cast<std::uint16_t>(op);
+        event.a = a;
+        event.b = b;
+        event.c = c;
+        event.valueA = valueA;
+        event.valueB = valueB;
+        if (++pos == blocks[current].size())
+            flush();
+    }
+
+    // Write out the buffered events and wait for every write to finish;
+    // throws the first write error once none is pending any more
+    void close();
+
+    std::uint64_t size() const { return written + pos; }
+    const std::string &name() const { return file.name(); }
+
+private:
+    BinaryFile file;
+    std::vector<TraceEvent> blocks[2];
+    std::future<void> pending[2];
+    int current;
+    std::size_t pos;
+    std::uint64_t written; // events handed to the I/O thread
+    bool closed;
+    std::chrono::steady_clock::time_point start;
+    // Last, so it is destroyed first: its thread finishes any write still
+    // queued while the file and the blocks being written are alive
+    IoThread io;
+
+    TraceLog(const TraceLog &);
+    TraceLog &operator=(const TraceLog &);
+
+    void flush();
+};
+
+class TraceReader
+{
+public:
+    // Open a trace file and check its header and that it ends on a whole event; throws std::runtime_error
+    explicit TraceReader(const std::string &path, std::size_t blockEvents = TraceLog::BLOCK_EVENTS);
+
+    std::uint64_t size() const { return total; }
+
+    // The next event, or false at the end of the log
+    bool next(TraceEvent &event);
+
+    static const char *kindName(int kind);
+    static const char *opName(int kind, int op);
+    // One line of text for an event, in the words of the console visualizations
+    static std::string describe(const TraceEvent &event);
+
+private:
+    BinaryFile file;
+    std::vector<TraceEvent> block;
+    std::size_t pos, filled;
+    std::uint64_t read, total;
+};
+
+// Sort tracer that records to a TraceLog; comparisons and moves carry no
+// position, so they are not recorded
+class LogTracer
+{
+private:
+    const std::vector<int> &arr;
+    TraceLog &log;
+
+    int value(int i) const { return i >= 0 && i < static_cast<int>(arr.size()) ? arr[i] : 0; }
+
+public:
+    LogTracer(const std::vector<int> &array, TraceLog &log) : arr(array), log(log) {}
+
+    void compare() {}
+    void swap(int i, int j) { log.record(TRACE_SORT_SWAP, 0, i, j, 0, value(i), value(j)); }
+    void move() {}
+    void event(SortEvent ev, int a = 0, int b = 0, int c = 0)
+    {
+        log.record(TRACE_SORT_EVENT, ev, a, b, c, value(a), value(b));
+    }
+};
+
+#endif // TRACE_LOG_H
@@ -0,0 +1,279 @@
+#include "trace_log.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * Replay tool for binary trace files (make trace)
+ *   AlgoVaultTrace FILE [--kind sort,swap,graph] [--op partitioned,merged]
+ *                       [--index A:B] [--skip N] [--limit N] [--step] [--summary]
+ * Prints the recorded steps one per line, in the words of the console
+ * visualizations, with their number and time; the options filter them.
+ */
+
+namespace
+{
+    void printUsage(std::ostream &out)
+    {
+        out << "Usage: AlgoVaultTrace FILE [options]\n"
+               "  --kind LIST       only these kinds: sort, swap, graph\n"
+               "  --op LIST         only these steps, e.g. partitioned,merged or visit,relax\n"
+               "  --index A:B       only steps whose first or second index/vertex is in [A, B]\n"
+               "  --skip N          leave out the first N matching steps\n"
+               "  --limit N         print at most N steps\n"
+               "  --step            wait for Enter after every step\n"
+               "  --summary         count the steps by kind and name instead of printing them\n";
+    }
+
+    std::vector<std::string> splitList(const std::string &list)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(list);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (!item.empty())
+            {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    long long parseNumber(const std::string &text)
+    {
+        char *end = nullptr;
+        long long value = std::strtoll(text.c_str(), &end, 10);
+        if (end == text.c_str() || *end != '\0')
+        {
+            throw std::invalid_argument("not a number: " + text);
+        }
+        return value;
+    }
+
+    bool contains(const std::vector<std::string> &list, const std::string &item)
+    {
+        for (const std::string &entry : list)
+        {
+            if (entry == item)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Names as TraceReader gives them, so that a misspelled one is an error
+    // instead of a filter that matches nothing
+    void checkKinds(const std::vector<std::string> &names)
+    {
+        for (const std::string &name : names)
+        {
+            bool known = false;
+            for (int kind = TRACE_SORT_EVENT; kind <= TRACE_GRAPH_EVENT; kind++)
+            {
+                known = known || name == TraceReader::kindName(kind);
+            }
+            if (!known)
+            {
+                throw std::invalid_argument("unknown kind " + name);
+            }
+        }
+    }
+
+    void checkOps(const std::vector<std::string> &names)
+    {
+        const int MAX_OP = 64; // ops are small enum values (SortEvent, GraphEvent)
+        for (const std::string &name : names)
+        {
+            bool known = false;
+            for (int kind = TRACE_SORT_EVENT; kind <= TRACE_GRAPH_EVENT; kind++)
+            {
+                for (int op = 0; op < MAX_OP && !known; op++)
+                {
+                    known = name == TraceReader::opName(kind, op);
+                }
+            }
+            if (!known || name == "unknown")
+            {
+                throw std::invalid_argument("unknown step " + name);
+            }
+        }
+    }
+
+    struct Filter
+    {
+        std::vector<std::string> kinds;
+        std::vector<std::string> ops;
+        bool byIndex;
+        long long low, high;
+
+        Filter() : byIndex(false), low(0), high(0) {}
+
+        bool matches(const TraceEvent &event) const
+        {
+            if (!kinds.empty() && !contains(kinds, TraceReader::kindName(event.kind)))
+            {
+                return false;
+            }
+            if (!ops.empty() && !contains(ops, TraceReader::opName(event.kind, event.op)))
+            {
+                return false;
+            }
+            if (byIndex && !(event.a >= low && event.a <= high) && !(event.b >= low && event.b <= high))
+            {
+                return false;
+            }
+            return true;
+        }
+    };
+}
+
+int main(int argc, char **argv)
+{
+    std::string path;
+    Filter filter;
+    long long skip = 0, limit = -1;
+    bool step = false, summary = false;
+
+    try
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                printUsage(std::cout);
+                return 0;
+            }
+            if (arg == "--step")
+            {
+                step = true;
+                continue;
+            }
+            if (arg == "--summary")
+            {
+                summary = true;
+                continue;
+            }
+            if (arg.compare(0, 2, "--") != 0)
+            {
+                if (!path.empty())
+                {
+                    throw std::invalid_argument("more than one trace file");
+                }
+                path = arg;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            std::string value = argv[++i];
+
+            if (arg == "--kind")
+            {
+                filter.kinds = splitList(value);
+                checkKinds(filter.kinds);
+            }
+            else if (arg == "--op")
+            {
+                filter.ops = splitList(value);
+                checkOps(filter.ops);
+            }
+            else if (arg == "--index")
+            {
+                std::size_t colon = value.find(':');
+                if (colon == std::string::npos)
+                {
+                    throw std::invalid_argument("--index needs A:B");
+                }
+                filter.byIndex = true;
+                filter.low = parseNumber(value.substr(0, colon));
+                filter.high = parseNumber(value.substr(colon + 1));
+            }
+            else if (arg == "--skip")
+            {
+                skip = parseNumber(value);
+            }
+            else if (arg == "--limit")
+            {
+                limit = parseNumber(value);
+            }
+            else
+            {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+        }
+        if (path.empty())
+        {
+            throw std::invalid_argument("no trace file given");
+        }
+
+        TraceReader reader(path);
+        TraceEvent event;
+        std::uint64_t number = 0, matched = 0, lastTime = 0;
+        std::map<std::string, std::uint64_t> counts;
+
+        while (reader.next(event) && limit != 0)
+        {
+            number++;
+            lastTime = event.time;
+            if (!filter.matches(event) || skip-- > 0)
+            {
+                continue;
+            }
+            matched++;
+
+            if (summary)
+            {
+                counts[std::string(TraceReader::kindName(event.kind)) + "/" +
+                       TraceReader::opName(event.kind, event.op)]++;
+                continue;
+            }
+
+            std::cout << "#" << std::left << std::setw(10) << number << std::right << std::fixed
+                      << std::setprecision(3) << std::setw(14) << event.time / 1000.0 << " us  "
+                      << TraceReader::describe(event) << "\n";
+            if (limit > 0)
+            {
+                limit--;
+            }
+            if (step)
+            {
+                std::cout << "(Enter for the next step)" << std::flush;
+                std::string line;
+                if (!std::getline(std::cin, line))
+                {
+                    break;
+                }
+            }
+        }
+
+        if (summary)
+        {
+            std::cout << reader.size() << " steps over " << std::fixed << std::setprecision(3) << lastTime / 1e6
+                      << " ms, " << matched << " matching\n";
+            for (const auto &count : counts)
+            {
+                std::cout << "  " << std::left << std::setw(24) << count.first << std::right << count.second << "\n";
+            }
+        }
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        printUsage(std::cerr);
+        return 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,54 +1,84 @@
 #include "utils.h"
+#include "bulk_loader.h"
 #include <windows.h>
 #include <conio.h>
 #include <iomanip>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <climits>
 
+// The line is built first and written with one insertion, without flushing
 void Utils::printArray(const std::vector<int> &arr, const std::string &message)
 {
-    if (!message.empty())
-    {
-        std::cout << message << ": ";
-    }
-    std::cout << "[";
-    for (size_t i = 0; i < arr.size(); ++i)
-    {
-        std::cout << arr[i];
-        if (i < arr.size() - 1)
-            std::cout << ", ";
-    }
-    std::cout << "]" << std::endl;
+    printArrayRange(arr, 0, static_cast<int>(arr.size()) - 1, message);
 }
 
 void Utils::printArrayRange(const std::vector<int> &arr, int start, int end, const std::string &message)
 {
+    std::string line;
     if (!message.empty())
     {
-        std::cout << message << ": ";
+        line += message;
+        line += ": ";
     }
-    std::cout << "[";
-    for (int i = start; i <= end && i < static_cast<int>(arr.size()); ++i)
+    line += '[';
+    int last = std::min(end, static_cast<int>(arr.size()) - 1);
+    for (int i = start; i <= last; ++i)
     {
-        std::cout << arr[i];
-        if (i < end && i < static_cast<int>(arr.size()) - 1)
-            std::cout << ", ";
+        line += std::to_string(arr[i]);
+        if (i < last)
+            line += ", ";
     }
-    std::cout << "]" << std::endl;
+    line += "]\n";
+    std::cout << line;
 }
 
+// A count is followed by the elements; anything else is taken as a file
+// of ints (text, or raw 32-bit in a .bin file) and bulk loaded. Returns an
+// empty array once the input has run out
 std::vector<int> Utils::getArrayFromUser()
 {
-    int n;
-    std::cout << "Enter the number of elements: ";
-    std::cin >> n;
-
-    std::vector<int> arr(n);
-    std::cout << "Enter " << n << " elements: ";
-    for (int i = 0; i < n; ++i)
+    while (true)
     {
-        std::cin >> arr[i];
-    }
+        std::string input;
+        std::cout << "Enter the number of elements (or a file to load): ";
+        if (!(std::cin >> input))
+        {
+            std::cout << "No more input." << std::endl;
+            return std::vector<int>();
+        }
 
-    return arr;
+        if (std::all_of(input.begin(), input.end(), [](unsigned char c) { return std::isdigit(c) != 0; }))
+        {
+            // At most 10 digits fit strtoull; more than INT_MAX elements cannot be indexed
+            if (input.size() > 10 ||
+                std::strtoull(input.c_str(), nullptr, 10) > static_cast<unsigned long long>(INT_MAX))
+            {
+                std::cout << "Error: at most " << INT_MAX << " elements" << std::endl;
+                continue;
+            }
+            int n = std::atoi(input.c_str());
+            std::vector<int> arr(n);
+            std::cout << "Enter " << n << " elements: ";
+            for (int i = 0; i < n; ++i)
+            {
+                std::cin >> arr[i];
+            }
+            return arr;
+        }
+
+        try
+        {
+            std::vector<int> arr = BulkLoader::load(input);
+            std::cout << "Loaded " << arr.size() << " elements from " << input << std::endl;
+            return arr;
+        }
+        catch (const std::exception &e)
+        {
+            std::cout << "Error: " << e.what() << std::endl;
+        }
+    }
 }
 
 int Utils::getPositiveIntFromUser(const std::string &prompt)